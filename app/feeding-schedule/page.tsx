@@ -2,7 +2,7 @@
 
 import { useEffect, useState } from "react"
 import { ref, onValue, set } from "firebase/database"
-import { initFirebase } from "@/lib/firebase"
+import { initFirebase, DEVICE_ROOT } from "@/lib/firebase"
 import { useAuth } from "@/contexts/auth-context"
 import LoadingAnimation from "@/components/loading-animation"
 import NavigationMenu from "@/components/navigation-menu"
@@ -24,7 +24,7 @@ export default function FeedingSchedulePage() {
     if (!firebase?.database) return
 
     // Load feeding schedule
-    const scheduleRef = ref(firebase.database, "/feedingSchedule")
+    const scheduleRef = ref(firebase.database, `${DEVICE_ROOT}/feedingSchedule`)
     const unsubscribe = onValue(scheduleRef, (snapshot) => {
       const schedule = snapshot.val()
       if (schedule) {
@@ -54,7 +54,7 @@ export default function FeedingSchedulePage() {
       const newSchedule = { ...feedingSchedule }
       newSchedule[hour] = !newSchedule[hour]
       setFeedingSchedule(newSchedule)
-      set(ref(firebase.database, `/feedingSchedule/${hour}`), newSchedule[hour])
+      set(ref(firebase.database, `${DEVICE_ROOT}/feedingSchedule/${hour}`), newSchedule[hour])
         .then(() => console.log(`Feeding schedule for hour ${hour} updated in Firebase`))
         .catch((err) => console.error("Error updating feeding schedule:", err))
     } catch (err: any) {
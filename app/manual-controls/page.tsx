@@ -2,7 +2,7 @@
 
 import { useEffect, useState } from "react"
 import { ref, onValue, set } from "firebase/database"
-import { initFirebase } from "@/lib/firebase"
+import { initFirebase, DEVICE_ROOT } from "@/lib/firebase"
 import { useAuth } from "@/contexts/auth-context"
 import LoadingAnimation from "@/components/loading-animation"
 import NavigationMenu from "@/components/navigation-menu"
@@ -98,7 +98,7 @@ export default function ManualControls() {
     }
 
     try {
-      const automationRef = ref(firebase.database, "/controls/automationEnabled")
+      const automationRef = ref(firebase.database, `${DEVICE_ROOT}/controls/automationEnabled`)
 
       const unsubscribe = onValue(
         automationRef,
@@ -130,7 +130,7 @@ export default function ManualControls() {
     try {
       const newState = !automationEnabled
       setAutomationEnabled(newState)
-      set(ref(firebase.database, "/controls/automationEnabled"), newState)
+      set(ref(firebase.database, `${DEVICE_ROOT}/controls/automationEnabled`), newState)
         .then(() => console.log("Automation state updated in Firebase"))
         .catch((err) => console.error("Error updating automation state:", err))
     } catch (err: any) {
@@ -150,7 +150,7 @@ export default function ManualControls() {
 
       // Write the actual desired state to Firebase
       // The Arduino expects true to mean ON and false to mean OFF
-      set(ref(firebase.database, "/controls/fan"), newState)
+      set(ref(firebase.database, `${DEVICE_ROOT}/controls/fan`), newState)
         .then(() => console.log("Fan state updated in Firebase"))
         .catch((err) => console.error("Error updating fan state:", err))
     } catch (err: any) {
@@ -170,7 +170,7 @@ export default function ManualControls() {
 
       // Write the actual desired state to Firebase
       // The Arduino expects true to mean ON and false to mean OFF
-      set(ref(firebase.database, "/controls/heat"), newState)
+      set(ref(firebase.database, `${DEVICE_ROOT}/controls/heat`), newState)
         .then(() => console.log("Heat state updated in Firebase"))
         .catch((err) => console.error("Error updating heat state:", err))
     } catch (err: any) {
@@ -190,7 +190,7 @@ export default function ManualControls() {
 
       // Write the actual desired state to Firebase
       // The Arduino expects true to mean ON and false to mean OFF
-      set(ref(firebase.database, "/controls/pump"), newState)
+      set(ref(firebase.database, `${DEVICE_ROOT}/controls/pump`), newState)
         .then(() => console.log("Pump state updated in Firebase"))
         .catch((err) => console.error("Error updating pump state:", err))
     } catch (err: any) {
@@ -235,7 +235,7 @@ export default function ManualControls() {
         { onlyOnce: true },
       )
 
-      const automationRef = ref(firebase.database, "/controls/automationEnabled")
+      const automationRef = ref(firebase.database, `${DEVICE_ROOT}/controls/automationEnabled`)
       onValue(
         automationRef,
         (snapshot) => {
@@ -2,7 +2,7 @@
 
 import { useEffect, useState } from "react"
 import { ref, onValue, get } from "firebase/database"
-import { initFirebase } from "@/lib/firebase"
+import { initFirebase, DEVICE_ROOT } from "@/lib/firebase"
 import { useAuth } from "@/contexts/auth-context"
 import LoadingAnimation from "@/components/loading-animation"
 import CameraFeed from "@/components/camera-feed"
@@ -121,7 +121,7 @@ export default function Dashboard() {
           })
         }
 
-        const controlsRef = ref(firebase.database, "/controls")
+        const controlsRef = ref(firebase.database, `${DEVICE_ROOT}/controls`)
         return get(controlsRef)
       })
       .then((snapshot) => {
@@ -259,7 +259,7 @@ export default function Dashboard() {
     }
 
     try {
-      const automationRef = ref(firebase.database, "/controls/automationEnabled")
+      const automationRef = ref(firebase.database, `${DEVICE_ROOT}/controls/automationEnabled`)
 
       const unsubscribe = onValue(
         automationRef,
@@ -2,7 +2,7 @@
 
 import { useEffect, useState } from "react"
 import { ref, onValue } from "firebase/database"
-import { initFirebase } from "@/lib/firebase"
+import { initFirebase, DEVICE_ROOT } from "@/lib/firebase"
 import { useAuth } from "@/contexts/auth-context"
 import LoadingAnimation from "@/components/loading-animation"
 import WaterUsageAnalytics from "@/components/water-usage-analytics"
@@ -26,7 +26,7 @@ export default function WaterAnalyticsPage() {
     if (!firebase?.database) return
 
     // Get chicken count from feeding settings
-    const settingsRef = ref(firebase.database, "/feedingSettings")
+    const settingsRef = ref(firebase.database, `${DEVICE_ROOT}/feedingSettings`)
     const unsubscribe = onValue(settingsRef, (snapshot) => {
       const settings = snapshot.val()
       if (settings && settings.chickenCount) {
@@ -2,7 +2,7 @@
 
 import { useEffect, useState } from "react"
 import { ref, onValue, set } from "firebase/database"
-import { initFirebase } from "@/lib/firebase"
+import { initFirebase, DEVICE_ROOT } from "@/lib/firebase"
 import { useAuth } from "@/contexts/auth-context"
 import LoadingAnimation from "@/components/loading-animation"
 import NavigationMenu from "@/components/navigation-menu"
@@ -27,7 +27,7 @@ export default function WaterSchedulePage() {
     if (!firebase?.database) return
 
     // Load water schedule
-    const scheduleRef = ref(firebase.database, "/waterSchedule")
+    const scheduleRef = ref(firebase.database, `${DEVICE_ROOT}/waterSchedule`)
     const unsubscribe = onValue(scheduleRef, (snapshot) => {
       const schedule = snapshot.val()
       if (schedule) {
@@ -43,7 +43,7 @@ export default function WaterSchedulePage() {
     })
 
     // Load water settings
-    const settingsRef = ref(firebase.database, "/waterSettings")
+    const settingsRef = ref(firebase.database, `${DEVICE_ROOT}/waterSettings`)
     const settingsUnsubscribe = onValue(settingsRef, (snapshot) => {
       const settings = snapshot.val()
       if (settings) {
@@ -80,7 +80,7 @@ export default function WaterSchedulePage() {
       const newSchedule = { ...waterSchedule }
       newSchedule[hour] = !newSchedule[hour]
       setWaterSchedule(newSchedule)
-      set(ref(firebase.database, `/waterSchedule/${hour}`), newSchedule[hour])
+      set(ref(firebase.database, `${DEVICE_ROOT}/waterSchedule/${hour}`), newSchedule[hour])
         .then(() => console.log(`Water schedule for hour ${hour} updated in Firebase`))
         .catch((err) => console.error("Error updating water schedule:", err))
     } catch (err: any) {
@@ -95,7 +95,7 @@ export default function WaterSchedulePage() {
 
     try {
       setWaterFillDuration(duration)
-      set(ref(firebase.database, "/waterSettings/fillDuration"), duration)
+      set(ref(firebase.database, `${DEVICE_ROOT}/waterSettings/fillDuration`), duration)
         .then(() => console.log(`Water fill duration updated to ${duration}s`))
         .catch((err) => console.error("Error updating water fill duration:", err))
     } catch (err: any) {
@@ -110,7 +110,7 @@ export default function WaterSchedulePage() {
 
     try {
       setWaterFlowRate(rate)
-      set(ref(firebase.database, "/waterSettings/flowRate"), rate)
+      set(ref(firebase.database, `${DEVICE_ROOT}/waterSettings/flowRate`), rate)
         .then(() => console.log(`Water flow rate updated to ${rate}ml/s`))
         .catch((err) => console.error("Error updating water flow rate:", err))
     } catch (err: any) {
@@ -126,7 +126,7 @@ export default function WaterSchedulePage() {
     try {
       const newState = !autoWaterEnabled
       setAutoWaterEnabled(newState)
-      set(ref(firebase.database, "/waterSettings/autoEnabled"), newState)
+      set(ref(firebase.database, `${DEVICE_ROOT}/waterSettings/autoEnabled`), newState)
         .then(() => console.log(`Auto water ${newState ? "enabled" : "disabled"}`))
         .catch((err) => console.error("Error updating auto water state:", err))
     } catch (err: any) {
@@ -141,12 +141,12 @@ export default function WaterSchedulePage() {
 
     try {
       // Set water fill command
-      set(ref(firebase.database, "/controls/waterFill"), true)
+      set(ref(firebase.database, `${DEVICE_ROOT}/controls/waterFill`), true)
         .then(() => {
           console.log("Manual water fill triggered")
           // Reset command after 2 seconds
           setTimeout(() => {
-            set(ref(firebase.database, "/controls/waterFill"), false).catch((err) =>
+            set(ref(firebase.database, `${DEVICE_ROOT}/controls/waterFill`), false).catch((err) =>
               console.error("Error resetting water fill command:", err),
             )
           }, 2000)
@@ -2,7 +2,7 @@
 
 import { useState, useEffect } from "react"
 import { ref, set, get, push, onValue } from "firebase/database"
-import { initFirebase } from "@/lib/firebase"
+import { initFirebase, DEVICE_ROOT } from "@/lib/firebase"
 import { Utensils, Info, ChevronDown, ChevronUp } from "lucide-react"
 
 interface FeedingControlProps {
@@ -44,7 +44,7 @@ export default function FeedingControl({ className = "" }: FeedingControlProps)
 
     try {
       // Get last feeding settings
-      const settingsRef = ref(firebase.database, "/feedingSettings")
+      const settingsRef = ref(firebase.database, `${DEVICE_ROOT}/feedingSettings`)
       get(settingsRef)
         .then((snapshot) => {
           const settings = snapshot.val()
@@ -86,7 +86,7 @@ export default function FeedingControl({ className = "" }: FeedingControlProps)
         })
 
       // Monitor device feeding state
-      const feedStateRef = ref(firebase.database, "/controls/feed")
+      const feedStateRef = ref(firebase.database, `${DEVICE_ROOT}/controls/feed`)
       const unsubscribe = onValue(feedStateRef, (snapshot) => {
         const feedState = snapshot.val()
         setDeviceFeedingState(feedState === true)
@@ -106,7 +106,7 @@ export default function FeedingControl({ className = "" }: FeedingControlProps)
       })
 
       // Load feeding schedule
-      const scheduleRef = ref(firebase.database, "/feedingSchedule")
+      const scheduleRef = ref(firebase.database, `${DEVICE_ROOT}/feedingSchedule`)
       const unsubscribeSchedule = onValue(scheduleRef, (snapshot) => {
         const schedule = snapshot.val()
         if (schedule) {
@@ -140,7 +140,7 @@ export default function FeedingControl({ className = "" }: FeedingControlProps)
     if (!firebase?.database) return
 
     try {
-      await set(ref(firebase.database, "/controls/feed"), false)
+      await set(ref(firebase.database, `${DEVICE_ROOT}/controls/feed`), false)
       console.log("Feed control reset to false")
     } catch (error) {
       console.error("Error resetting feed control:", error)
@@ -201,14 +201,16 @@ export default function FeedingControl({ className = "" }: FeedingControlProps)
       console.log(`Feeding with ${gramsToDispense}g (${servoOpenTime}s)`)
 
       // Save current settings
-      await set(ref(firebase.database, "/feedingSettings"), {
+      await set(ref(firebase.database, `${DEVICE_ROOT}/feedingSettings`), {
         ageGroup,
         chickenCount,
         lastFeedTime: Math.floor(Date.now() / 1000),
       })
 
-      // Set feed duration first
-      await set(ref(firebase.database, "/controls/feedDuration"), servoOpenTime)
+      // Set the amount first - the device meters grams against the hopper
+      // level; the duration is only used by older firmware
+      await set(ref(firebase.database, `${DEVICE_ROOT}/controls/feedGrams`), gramsToDispense)
+      await set(ref(firebase.database, `${DEVICE_ROOT}/controls/feedDuration`), servoOpenTime)
 
       // Wait a moment to ensure the duration is set
       await new Promise((resolve) => setTimeout(resolve, 300))
@@ -241,7 +243,7 @@ export default function FeedingControl({ className = "" }: FeedingControlProps)
       })
 
       // Now trigger the feeding
-      await set(ref(firebase.database, "/controls/feed"), true)
+      await set(ref(firebase.database, `${DEVICE_ROOT}/controls/feed`), true)
       console.log("Feed command sent to device")
 
       // Show success message
@@ -1,8 +1,9 @@
 "use client"
 
 import { useEffect, useState, useRef } from "react"
-import { ref, get } from "firebase/database"
+import { ref, get, query, orderByKey, startAt, limitToLast } from "firebase/database"
 import { initFirebase } from "@/lib/firebase"
+import { decodeHistoryBlocks } from "@/lib/history-utils"
 import { Settings, RefreshCw, ChevronLeft, ChevronRight } from "lucide-react"
 import {
   Chart as ChartJS,
@@ -103,11 +104,37 @@ export default function HistoricalChart({ className = "" }: HistoricalChartProps
     console.log(`Fetching historical data for period: ${chartPeriod}`)
 
     try {
-      // Instead of using orderByChild which requires an index,
-      // we'll fetch all data and sort it client-side
-      const historyRef = ref(firebase.database, "/history")
+      // The device packs history into one node per hour (/historyBlocks, 5 minute
+      // points) and one per day (/historyDaily, hourly points). Block keys are
+      // their start time, so a key range fetches only the blocks in view.
+      const today = new Date()
+      today.setHours(0, 0, 0, 0)
+      const now = Math.floor(Date.now() / 1000)
+      const startTime =
+        chartPeriod === "day"
+          ? Math.floor(today.getTime() / 1000)
+          : now - (chartPeriod === "week" ? 7 : 30) * 24 * 60 * 60
+      const blocksPath = chartPeriod === "day" ? "/historyBlocks" : "/historyDaily"
+      // Start one block early - the block holding startTime began before it
+      const blockSpan = chartPeriod === "day" ? 60 * 60 : 24 * 60 * 60
+
+      const blocksQuery = query(
+        ref(firebase.database, blocksPath),
+        orderByKey(),
+        startAt(String(startTime - blockSpan)),
+      )
+      const blocksSnapshot = await get(blocksQuery)
+      const points = decodeHistoryBlocks(blocksSnapshot.val())
+
+      if (points.length > 0) {
+        console.log(`Decoded ${points.length} points from ${blocksPath}`)
+        processHistoricalData(points)
+        return
+      }
 
-      const snapshot = await get(historyRef)
+      // Older firmware wrote one node per sample to /history - read only the newest ones
+      const historyQuery = query(ref(firebase.database, "/history"), orderByKey(), limitToLast(30 * 24 * 12))
+      const snapshot = await get(historyQuery)
       const data = snapshot.val()
 
       if (!data) {
@@ -132,7 +159,10 @@ export default function HistoricalChart({ className = "" }: HistoricalChartProps
       // Convert to array and prepare for processing
       let dataArray: HistoryDataPoint[] = []
 
-      if (typeof data === "object" && data !== null) {
+      if (Array.isArray(data)) {
+        // Points decoded from history blocks
+        dataArray = data
+      } else if (typeof data === "object" && data !== null) {
         dataArray = Object.entries(data).map(([key, value]: [string, any]) => {
           // Handle different data structures
           if (typeof value === "object" && value !== null) {
@@ -193,7 +223,7 @@ export default function HistoricalChart({ className = "" }: HistoricalChartProps
           const today = new Date()
           today.setHours(0, 0, 0, 0)
           timeRange = now - Math.floor(today.getTime() / 1000)
-          pointsToShow = 24 // Show up to 24 points for day view
+          pointsToShow = 24 * 12 // Show up to 288 points for day view (5 minute intervals)
           break
         case "week":
           timeRange = 7 * 24 * 60 * 60 // 7 days
@@ -462,8 +492,8 @@ export default function HistoricalChart({ className = "" }: HistoricalChartProps
           <div className="flex flex-col items-center justify-center h-64">
             <div className="text-red-500 mb-2">{error}</div>
             <p className="text-gray-500 dark:text-gray-400 text-sm text-center max-w-md mb-4">
-              Make sure your Arduino is sending data to the /history path in Firebase. The data should include
-              timestamp, temperature, and humidity fields.
+              Make sure your Arduino is sending history blocks to the /historyBlocks and /historyDaily paths in
+              Firebase.
             </p>
             <button
               onClick={() => fetchHistoricalData()}
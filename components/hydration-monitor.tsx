@@ -1,7 +1,7 @@
 "use client"
 
 import { useEffect, useState } from "react"
-import { ref, onValue } from "firebase/database"
+import { ref, onValue, query, orderByKey, limitToLast } from "firebase/database"
 import { initFirebase } from "@/lib/firebase"
 import { AlertTriangle, Droplet, Info } from "lucide-react"
 
@@ -30,18 +30,18 @@ export default function HydrationMonitor({ chickenCount, className = "" }: Hydra
       return
     }
 
-    // Get today's start timestamp
+    // The device keys its daily totals by local calendar day (YYYYMMDD)
     const today = new Date()
-    today.setHours(0, 0, 0, 0)
-    const todayStart = Math.floor(today.getTime() / 1000)
+    const todayKey = `${today.getFullYear()}${String(today.getMonth() + 1).padStart(2, "0")}${String(today.getDate()).padStart(2, "0")}`
 
-    // Listen for water logs updates
-    const waterLogsRef = ref(firebase.database, "/waterLogs")
+    // Listen for the latest day's totals
+    const dailyTotalsQuery = query(ref(firebase.database, "/dailyTotals"), orderByKey(), limitToLast(1))
     const unsubscribe = onValue(
-      waterLogsRef,
+      dailyTotalsQuery,
       (snapshot) => {
         const data = snapshot.val()
-        if (!data) {
+        const totals = data?.[todayKey]
+        if (!totals) {
           setTotalWaterToday(0)
           setWaterPerBird(0)
           setHydrationStatus("normal")
@@ -49,17 +49,8 @@ export default function HydrationMonitor({ chickenCount, className = "" }: Hydra
           return
         }
 
-        // Calculate total water dispensed today
-        let todayTotal = 0
-        Object.values(data).forEach((log: any) => {
-          const timestamp = typeof log.timestamp === "string" ? Number(log.timestamp) : log.timestamp || 0
-          const volume =
-            typeof log.volumeDispensed === "string" ? Number(log.volumeDispensed) : log.volumeDispensed || 0
-
-          if (timestamp >= todayStart) {
-            todayTotal += volume
-          }
-        })
+        // Water drunk today, as measured from the drinker level
+        const todayTotal = typeof totals.waterDrunk === "string" ? Number(totals.waterDrunk) : totals.waterDrunk || 0
 
         setTotalWaterToday(todayTotal)
 
@@ -79,7 +70,7 @@ export default function HydrationMonitor({ chickenCount, className = "" }: Hydra
         setIsLoading(false)
       },
       (error) => {
-        console.error("Error fetching water logs:", error)
+        console.error("Error fetching daily totals:", error)
         setError("Failed to fetch water data")
         setIsLoading(false)
       },
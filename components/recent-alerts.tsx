@@ -3,6 +3,7 @@
 import { useEffect, useState } from "react"
 import { ref, onValue, remove, query, limitToLast, orderByChild } from "firebase/database"
 import { initFirebase } from "@/lib/firebase"
+import { describeEventCode } from "@/lib/event-codes"
 import { Trash2, ChevronDown, ChevronUp } from "lucide-react"
 
 interface AlertEvent {
@@ -10,6 +11,7 @@ interface AlertEvent {
   timestamp: number
   type: string
   description: string
+  count?: number // Summaries of repeated events - the description already says "N occurrences"
 }
 
 interface RecentAlertsProps {
@@ -36,7 +38,9 @@ export default function RecentAlerts({ className = "" }: RecentAlertsProps) {
     }
 
     try {
-      // Use query to limit to last 100 events, ordered by timestamp
+      // Use query to limit to last 100 events, ordered by timestamp. The device
+      // keys events "<seconds>-<boot>-<sequence>"; the dashboard and older firmware
+      // use other key formats, so only the timestamp child orders them all.
       const eventsRef = query(ref(firebase.database, "/events"), orderByChild("timestamp"), limitToLast(100))
 
       const unsubscribe = onValue(
@@ -51,15 +55,17 @@ export default function RecentAlerts({ className = "" }: RecentAlertsProps) {
             return
           }
 
-          // Convert to array and sort by timestamp (newest first)
+          // Convert to array and sort by timestamp (newest first). The device
+          // sends a code and values; older records carry type and description.
           const eventsArray = Object.entries(events)
             .map(([key, value]: [string, any]) => ({
               id: key,
               ...value,
+              ...describeEventCode(value.code, value.v, value.count, value.window),
               // Ensure timestamp is a number
               timestamp: typeof value.timestamp === "string" ? Number(value.timestamp) : value.timestamp,
             }))
-            .sort((a, b) => b.timestamp - a.timestamp)
+            .sort((a, b) => b.timestamp - a.timestamp || b.id.localeCompare(a.id))
 
           setAlertEvents(eventsArray)
           applyTimeFilter(eventsArray, timeFilter)
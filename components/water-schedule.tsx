@@ -2,7 +2,7 @@
 
 import { useState, useEffect } from "react"
 import { ref, onValue, set } from "firebase/database"
-import { initFirebase } from "@/lib/firebase"
+import { initFirebase, DEVICE_ROOT } from "@/lib/firebase"
 import { Clock, Calendar, Settings, Save, RefreshCw } from "lucide-react"
 
 interface WaterScheduleProps {
@@ -26,7 +26,7 @@ export default function WaterSchedule({ className = "" }: WaterScheduleProps) {
     if (!firebase?.database) return
 
     // Get water schedule from Firebase
-    const scheduleRef = ref(firebase.database, "/waterSchedule")
+    const scheduleRef = ref(firebase.database, `${DEVICE_ROOT}/waterSchedule`)
     const unsubscribeSchedule = onValue(scheduleRef, (snapshot) => {
       const data = snapshot.val() || {}
 
@@ -42,7 +42,7 @@ export default function WaterSchedule({ className = "" }: WaterScheduleProps) {
     })
 
     // Get water settings from Firebase
-    const settingsRef = ref(firebase.database, "/waterSettings")
+    const settingsRef = ref(firebase.database, `${DEVICE_ROOT}/waterSettings`)
     const unsubscribeSettings = onValue(settingsRef, (snapshot) => {
       const data = snapshot.val() || {}
       setWaterSettings({
@@ -76,10 +76,10 @@ export default function WaterSchedule({ className = "" }: WaterScheduleProps) {
       if (!firebase?.database) throw new Error("Firebase not initialized")
 
       // Save schedule
-      await set(ref(firebase.database, "/waterSchedule"), schedule)
+      await set(ref(firebase.database, `${DEVICE_ROOT}/waterSchedule`), schedule)
 
       // Save settings
-      await set(ref(firebase.database, "/waterSettings"), waterSettings)
+      await set(ref(firebase.database, `${DEVICE_ROOT}/waterSettings`), waterSettings)
 
       setSaveSuccess(true)
       setTimeout(() => setSaveSuccess(null), 3000)
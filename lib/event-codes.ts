@@ -0,0 +1,105 @@
+/**
+ * Text for the compact events written by the microcontroller
+ *
+ * The device writes events under /events as { timestamp, code, v } where
+ * code is one of the EventCode values in microcontroller-code.cpp and v
+ * holds a few numbers whose meaning depends on the code. Summaries of
+ * repeated events also carry count and window (minutes). Codes are never
+ * renumbered, so this table only grows.
+ */
+
+export interface EventCodeInfo {
+  // Event type used for the badge and filtering (same names as before codes)
+  type: string
+  describe: (v: number[]) => string
+}
+
+const AGE_GROUPS = ["chick", "grower", "adult"]
+const REFILL_STOPS = ["time limit", "target reached", "main tank low", "level not rising"]
+const FILL_REFUSALS = ["started", "main tank low", "drinker already full"]
+
+// Readings in alert events are sent as tenths
+const tenths = (value: number | undefined) => ((value ?? 0) / 10).toFixed(1)
+const whole = (value: number | undefined) => String(Math.round((value ?? 0) / 10))
+const clock = (minute: number | undefined) =>
+  `${String(Math.floor((minute ?? 0) / 60)).padStart(2, "0")}:${String((minute ?? 0) % 60).padStart(2, "0")}`
+const onOff = (value: number | undefined) => (value ? "ON" : "OFF")
+
+export const EVENT_CODES: Record<number, EventCodeInfo> = {
+  1: { type: "system", describe: () => "Smart Poultry System started" },
+  2: { type: "system", describe: () => "System switched to automatic mode" },
+  3: { type: "system", describe: () => "System switched to manual mode" },
+  10: { type: "highTemperature", describe: (v) => `High temperature detected: ${tenths(v[0])}°C (limit ${tenths(v[1])}°C)` },
+  11: { type: "resolved", describe: (v) => `High temperature alert resolved: ${tenths(v[0])}°C` },
+  12: { type: "lowTemperature", describe: (v) => `Low temperature detected: ${tenths(v[0])}°C (limit ${tenths(v[1])}°C)` },
+  13: { type: "resolved", describe: (v) => `Low temperature alert resolved: ${tenths(v[0])}°C` },
+  14: { type: "lowFood", describe: (v) => `Low food level detected: ${whole(v[0])}%` },
+  15: { type: "resolved", describe: (v) => `Low food level alert resolved: ${whole(v[0])}%` },
+  16: { type: "lowWaterMain", describe: (v) => `Low water level in main tank: ${whole(v[0])}%` },
+  17: { type: "resolved", describe: (v) => `Main tank water level alert resolved: ${whole(v[0])}%` },
+  18: { type: "lowWaterDrinker", describe: (v) => `Low water level in drinker: ${whole(v[0])}%` },
+  19: { type: "resolved", describe: (v) => `Drinker water level alert resolved: ${whole(v[0])}%` },
+  20: { type: "lowHydration", describe: (v) => `Low hydration detected: ${v[0]}ml per bird (expected by now: ${v[1]}ml)` },
+  21: { type: "resolved", describe: (v) => `Hydration level returned to normal: ${v[0]}ml per bird` },
+  30: { type: "sensorFault", describe: (v) => `DHT sensor has not returned a valid reading for ${v[0]} s` },
+  31: { type: "pumpFault", describe: (v) => `Drinker level did not rise after ${v[0]} s of pumping - pump dry or blocked` },
+  32: { type: "feederFault", describe: (v) => `Feeder moved no feed in ${v[0]} pulses - hopper empty or chute blocked` },
+  40: { type: "manual", describe: (v) => `Fan manually turned ${onOff(v[0])}` },
+  41: { type: "manual", describe: (v) => `Heat lamp manually turned ${onOff(v[0])}` },
+  42: { type: "manual", describe: (v) => `Water pump manually turned ${onOff(v[0])}` },
+  50: { type: "automatic", describe: (v) => `Fan automatically turned ${onOff(v[0])} at ${tenths(v[1])}°C` },
+  51: {
+    type: "automatic",
+    describe: (v) =>
+      v[2] ? `Heat lamp automatically turned OFF for the fan at ${tenths(v[1])}°C` : `Heat lamp automatically turned ${onOff(v[0])} at ${tenths(v[1])}°C`,
+  },
+  52: { type: "automatic", describe: (v) => `Drinker refill started automatically at ${v[0]}% (refill level ${v[1]}%)` },
+  53: { type: "automatic", describe: () => "Water pump automatically deactivated" },
+  60: {
+    type: "feeding",
+    describe: (v) => `Dispensed ${v[0]}g of feed for ${v[1]} ${AGE_GROUPS[v[2]] ?? "adult"} chickens`,
+  },
+  61: {
+    type: "waterFilling",
+    describe: (v) => `Refilled drinker with ${v[0]}ml (${v[1]}% to ${v[2]}%) in ${v[3]} s - ${REFILL_STOPS[v[4]] ?? "stopped"}`,
+  },
+  62: {
+    type: "scheduledFeeding",
+    describe: (v) => (v[1] > 0 ? `Scheduled feeding for ${clock(v[0])} activated ${v[1]} min late` : `Scheduled feeding activated at ${clock(v[0])}`),
+  },
+  63: { type: "scheduledWaterFill", describe: (v) => `Scheduled water filling activated at ${clock(v[0])}` },
+  64: {
+    type: "scheduleMissed",
+    describe: (v) => `Scheduled ${v[0] ? "water fill" : "feeding"} at ${clock(v[1])} skipped - ${v[2]} min overdue`,
+  },
+  65: {
+    type: "scheduleMissed",
+    describe: (v) => `Scheduled water filling at ${clock(v[0])} not started - ${FILL_REFUSALS[v[1]] ?? "refused"}`,
+  },
+}
+
+/**
+ * Type and description for a coded event
+ * @param code The event code
+ * @param values The event's v array
+ * @param count Occurrences, for summaries of repeated events
+ * @param window Summary window in minutes
+ * @returns The type and text to show, or null for records without a code
+ */
+export function describeEventCode(
+  code: number | undefined,
+  values: number[] | undefined,
+  count?: number,
+  window?: number,
+): { type: string; description: string } | null {
+  if (typeof code !== "number") return null
+
+  const info = EVENT_CODES[code]
+  if (!info) return { type: "system", description: `Event ${code}` }
+
+  let description = info.describe(values ?? [])
+  if (count && count > 1) {
+    description += ` (${count} occurrences in ${window ?? 0} min)`
+  }
+  return { type: info.type, description }
+}
@@ -9,6 +9,13 @@ const firebaseConfig = {
   projectId: "smartpoultry-4d359",
 }
 
+/**
+ * Parent of every node the microcontroller reacts to: controls, feeding and
+ * water settings, schedules and config. The device watches it with a single
+ * stream, so anything it should pick up must be written under this path.
+ */
+export const DEVICE_ROOT = "/device"
+
 /**
  * Initialize Firebase if it hasn't been initialized yet
  * @returns Firebase app instance and database
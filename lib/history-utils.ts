@@ -0,0 +1,114 @@
+/**
+ * Utility functions for the compact history blocks written by the microcontroller
+ *
+ * The device writes one node per hour under /historyBlocks/<epoch> (5 minute
+ * intervals) and one node per day under /historyDaily/<epoch> (hourly
+ * roll-ups). Each node looks like:
+ *   { start, step, mask, data }
+ * where bit N of mask marks slot N as filled and data is base64url-encoded
+ * zigzag varints: for every filled slot, the change of each field from the
+ * previous filled slot.
+ */
+
+// Field order inside each slot (temperature and humidity are x10)
+export const HISTORY_FIELDS = [
+  "temperature",
+  "temperatureMin",
+  "temperatureMax",
+  "humidity",
+  "humidityMin",
+  "humidityMax",
+  "foodLevel",
+  "waterLevelMain",
+  "waterLevelDrinker",
+] as const
+
+const SCALED_FIELDS = 6 // The first six fields are stored x10
+
+export type HistoryField = (typeof HISTORY_FIELDS)[number]
+
+export type HistoryPoint = { timestamp: number } & Record<HistoryField, number>
+
+export interface HistoryBlock {
+  start: number
+  step: number
+  mask: number
+  data: string
+}
+
+const BASE64URL = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+
+/**
+ * Decode unpadded base64url into bytes
+ * @param text The encoded string
+ * @returns The decoded bytes
+ */
+function decodeBase64Url(text: string): number[] {
+  const bytes: number[] = []
+  let bits = 0
+  let bitCount = 0
+
+  for (const char of text) {
+    const value = BASE64URL.indexOf(char)
+    if (value < 0) continue
+    bits = (bits << 6) | value
+    bitCount += 6
+    if (bitCount >= 8) {
+      bitCount -= 8
+      bytes.push((bits >> bitCount) & 0xff)
+    }
+  }
+
+  return bytes
+}
+
+/**
+ * Decode one history block into data points
+ * @param block The block node as stored in Firebase
+ * @returns One point per filled slot, oldest first
+ */
+export function decodeHistoryBlock(block: HistoryBlock): HistoryPoint[] {
+  const points: HistoryPoint[] = []
+  if (!block || typeof block.data !== "string") return points
+
+  const bytes = decodeBase64Url(block.data)
+  const previous = new Array(HISTORY_FIELDS.length).fill(0)
+  let offset = 0
+
+  for (let slot = 0; slot < 32 && offset < bytes.length; slot++) {
+    if (!(block.mask & (1 << slot))) continue
+
+    const point = { timestamp: block.start + slot * block.step } as HistoryPoint
+    HISTORY_FIELDS.forEach((field, index) => {
+      // Varint, then undo the zigzag mapping
+      let zigzag = 0
+      let shift = 0
+      let byte = 0
+      do {
+        byte = bytes[offset++] ?? 0
+        zigzag += (byte & 0x7f) * 2 ** shift
+        shift += 7
+      } while (byte & 0x80 && offset < bytes.length)
+
+      const delta = zigzag % 2 === 0 ? zigzag / 2 : -(zigzag + 1) / 2
+      previous[index] += delta
+      point[field] = index < SCALED_FIELDS ? previous[index] / 10 : previous[index]
+    })
+    points.push(point)
+  }
+
+  return points
+}
+
+/**
+ * Decode every block of a query result
+ * @param blocks The value of a /historyBlocks or /historyDaily query
+ * @returns All points, sorted by timestamp
+ */
+export function decodeHistoryBlocks(blocks: Record<string, HistoryBlock> | null): HistoryPoint[] {
+  if (!blocks) return []
+
+  return Object.values(blocks)
+    .flatMap((block) => decodeHistoryBlock(block))
+    .sort((a, b) => a.timestamp - b.timestamp)
+}
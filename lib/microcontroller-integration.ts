@@ -4,7 +4,7 @@
  */
 
 import { ref, set, get, push } from "firebase/database"
-import { initFirebase } from "./firebase"
+import { initFirebase, DEVICE_ROOT } from "./firebase"
 
 /**
  * Send a command to the microcontroller to open the feeder for a specific duration
@@ -19,15 +19,17 @@ export async function sendFeedCommand(durationSeconds: number): Promise<boolean>
   }
 
   try {
-    // Set the feed duration
-    await set(ref(firebase.database, "/controls/feedDuration"), durationSeconds)
+    // Set the feed duration, and clear any amount a previous feed left so
+    // the device goes by the duration
+    await set(ref(firebase.database, `${DEVICE_ROOT}/controls/feedGrams`), 0)
+    await set(ref(firebase.database, `${DEVICE_ROOT}/controls/feedDuration`), durationSeconds)
 
     // Trigger the feed command
-    await set(ref(firebase.database, "/controls/feed"), true)
+    await set(ref(firebase.database, `${DEVICE_ROOT}/controls/feed`), true)
 
     // Reset the feed command after a delay to prevent repeated feeding
     setTimeout(() => {
-      set(ref(firebase.database, "/controls/feed"), false).catch((err) =>
+      set(ref(firebase.database, `${DEVICE_ROOT}/controls/feed`), false).catch((err) =>
         console.error("Error resetting feed command:", err),
       )
     }, 2000)
@@ -99,7 +101,7 @@ export async function saveFeedingSettings(ageGroup: string, chickenCount: number
   }
 
   try {
-    await set(ref(firebase.database, "/feedingSettings"), {
+    await set(ref(firebase.database, `${DEVICE_ROOT}/feedingSettings`), {
       ageGroup,
       chickenCount,
       lastUpdated: Math.floor(Date.now() / 1000),
@@ -128,7 +130,7 @@ export async function getLastFeedingSettings(): Promise<{
   }
 
   try {
-    const snapshot = await get(ref(firebase.database, "/feedingSettings"))
+    const snapshot = await get(ref(firebase.database, `${DEVICE_ROOT}/feedingSettings`))
     return snapshot.val()
   } catch (error) {
     console.error("Error getting feeding settings:", error)
@@ -1,12 +1,19 @@
+#ifdef POULTRY_SIMULATION
+// Host build (see CMakeLists.txt) - platform stand-ins from sim/host_platform.h
+#include "sim/host_platform.h"
+#else
 #include <WiFi.h>
 #include <Firebase_ESP_Client.h>
-#include <DHT.h>
 #include <ESP32Servo.h>
-#include <NewPing.h>
-#include <time.h>
 #include <ArduinoJson.h>
+#include <Preferences.h>
+#include <LittleFS.h>
 #include "addons/TokenHelper.h"
 #include "addons/RTDBHelper.h"
+#endif
+#include <time.h>
+#include <atomic>
+#include <initializer_list>
 
 // WiFi credentials
 #define WIFI_SSID "SHOKO 4413"  // Updated with your SSID
@@ -17,7 +24,7 @@
 #define DATABASE_URL "https://smartpoultry-4d359-default-rtdb.asia-southeast1.firebasedatabase.app/"
 
 // Pin definitions
-#define DHT_PIN 4          // DHT22 sensor pin
+#define DHT_PIN 4          // DHT sensor data pin (model set by DHT_TYPE)
 #define ULTRASONIC_TRIG 14  // Ultrasonic sensor trigger pin for food level
 #define ULTRASONIC_ECHO 12 // Ultrasonic sensor echo pin for food level
 #define WATER_LEVEL_MAIN 34 // Water level sensor for main tank
@@ -29,7 +36,7 @@
 #define RELAY_SPARE 25     // Spare relay pin
 
 // Constants
-#define DHT_TYPE DHT11     // DHT sensor type
+#define DHT_TYPE 11        // DHT sensor type (11 = DHT11, 22 = DHT22)
 #define MAX_DISTANCE 200   // Maximum distance for ultrasonic sensor (in cm)
 #define TEMP_HIGH_THRESHOLD 32.0  // High temperature threshold (°C)
 #define TEMP_LOW_THRESHOLD 24.0   // Low temperature threshold (°C)
@@ -39,23 +46,303 @@
 #define SERVO_OPEN_ANGLE 45      // Servo open angle (45 degrees)
 #define SERVO_CLOSE_ANGLE 0      // Servo close angle (0 degrees)
 #define GRAMS_PER_SECOND 50      // Calibrated feed rate: 50g per second at 45 degrees
+#define FOOD_FULL_DISTANCE 1     // Ultrasonic distance with a full hopper (cm)
+#define FOOD_EMPTY_DISTANCE 5    // Ultrasonic distance with an empty hopper (cm)
+#define HOPPER_CAPACITY_GRAMS 2000 // Feed between the full and empty distances
 
 // Water system constants
 #define WATER_FLOW_RATE 100      // Default water flow rate: 100ml per second
 #define WATER_FILL_DURATION 30   // Default water fill duration: 30 seconds
 #define HYDRATION_WARNING_THRESHOLD 180 // Warning threshold for water consumption (ml per bird per day)
 #define HYDRATION_ALERT_THRESHOLD 120  // Alert threshold for water consumption (ml per bird per day)
+#define DRINKER_CAPACITY 5000    // ml between 0% and 100% on the drinker level sensor
+#define DRINKER_REFILL_LEVEL 30  // Automation starts a refill below this level (%)
+#define DRINKER_TARGET_LEVEL 90  // Refills stop at this level (%)
+
+bool signupOK = false;
 
+#ifndef POULTRY_SIMULATION
 // Firebase objects
-FirebaseData fbdo;
 FirebaseAuth auth;
 FirebaseConfig config;
-bool signupOK = false;
 
+// Request session - one FirebaseData keeps a keep-alive TLS connection, so
+// after the first request every PATCH and GET skips the handshake. Requests
+// go out one at a time from the network task and each result is copied into
+// an RtdbResponse before the next one reuses the session. The control
+// stream holds the only other connection. There is no session pool: each
+// mbedTLS connection holds its own record buffers (tens of KB of heap), so
+// throughput comes from batching instead - telemetry and outbox records go
+// out as multi-path PATCHes, many records per request.
+FirebaseData rtdbSession;
+FirebaseData controlStream;
+FirebaseJson patchJson;          // Body of the next PATCH, loaded from a frame
+#endif
+char streamErrorText[48] = "";   // Why the control stream last failed
+
+// Staged network bring-up - setup() only loads the flash caches and starts
+// the tasks, so local control runs straight away. The network task then
+// works through these stages one step per pass, and a failed step is
+// retried after a delay that doubles up to BRINGUP_RETRY_MAX.
+#define WIFI_CONNECT_TIMEOUT 15000   // ms before a connection attempt is restarted
+#define BRINGUP_RETRY_MIN 1000       // ms
+#define BRINGUP_RETRY_MAX 60000
+
+enum NetworkStage {
+  NET_WIFI_START,
+  NET_WIFI_WAIT,
+  NET_SIGNUP,
+  NET_READY
+};
+
+// Milliseconds after reset at which each milestone was first reached (0 = not yet)
+struct BootMetrics {
+  unsigned long wifi;
+  unsigned long clock;         // SNTP time valid
+  unsigned long cloud;         // Signed in and control stream open
+  uint16_t wifiAttempts;
+  uint16_t signupAttempts;
+  bool reported;
+};
+
+uint8_t networkStage = NET_WIFI_START;
+unsigned long stageStartTime = 0;
+unsigned long bringUpRetryDelay = BRINGUP_RETRY_MIN;
+unsigned long bringUpRetryTime = 0;
+BootMetrics bootMetrics = {};
+volatile unsigned long firstControlTime = 0;  // First control tick - written by the control task
+bool clockReady = false;                      // Control task has anchored the day to the wall clock
+
+#ifndef POULTRY_SIMULATION
 // Objects
-DHT dht(DHT_PIN, DHT_TYPE);
 Servo feederServo;
-NewPing sonar(ULTRASONIC_TRIG, ULTRASONIC_ECHO, MAX_DISTANCE);
+#endif
+
+// Asynchronous sensor sampling - the DHT transfer and the ultrasonic echo are
+// timed by pin interrupts. The control task starts a measurement, picks up
+// the result on a later pass and feeds it through a median + EMA filter;
+// readSensors() then only copies the filtered values.
+#define DHT_SAMPLE_INTERVAL 2000     // ms (DHT11 allows 1 Hz, DHT22 0.5 Hz)
+#define DHT_START_LOW_TIME 20        // ms DHT11 start signal (at least 18 ms), ended on a later control pass
+#define DHT22_START_LOW_MICROS 1100  // us DHT22 start signal (1-20 ms), busy-waited - a control
+                                     // pass could end it past the 20 ms limit
+#define DHT_CAPTURE_TIME 10          // ms allowed for the ~5 ms transfer
+#define DHT_EDGES 42                 // Falling edges: response, 40 bits, end of frame
+#define DHT_BIT_THRESHOLD 100        // us between falling edges; longer means a 1 bit
+#define SONAR_SAMPLE_INTERVAL 200    // ms
+#define SONAR_ECHO_TIMEOUT 15        // ms; an echo from MAX_DISTANCE takes ~12 ms
+#define FILTER_WINDOW 5              // Median-of-N window
+#define FILTER_EMA_ALPHA 0.3
+#define SENSOR_STALE_TIMEOUT 30000   // ms without a good sample before a reading is dropped
+
+enum DhtPhase {
+  DHT_IDLE,
+  DHT_START_LOW,   // Host holding the line low
+  DHT_CAPTURING    // Line released, edges being timed by dhtEdgeIsr()
+};
+
+struct SensorFilter {
+  float window[FILTER_WINDOW];
+  uint8_t count;
+  uint8_t next;
+  float value;               // Filtered value - held while samples fail
+  bool valid;
+  unsigned long lastGoodTime;
+  unsigned long failures;
+};
+
+SensorFilter temperatureFilter = {};
+SensorFilter humidityFilter = {};
+SensorFilter distanceFilter = {};
+bool climateValid = false;   // False until the first good DHT sample, or once it goes stale
+
+uint8_t dhtPhase = DHT_IDLE;
+unsigned long dhtPhaseTime = 0;
+unsigned long dhtCaptureTime = 0;    // When the line was released
+volatile uint32_t dhtEdgeTimes[DHT_EDGES];
+volatile uint8_t dhtEdgeCount = 0;
+
+bool sonarPending = false;
+unsigned long sonarStartTime = 0;
+unsigned long lastSonarSample = 0;
+volatile uint32_t echoRiseMicros = 0;
+volatile uint32_t echoFallMicros = 0;
+volatile bool echoDone = false;
+
+// Water level ADC pipeline - both channels are sampled continuously by the
+// ADC's DMA engine, the driver averages each block, and the blocks are
+// decimated and smoothed in fixed point (Q8). Raw -> percent calibration
+// curves live in NVS ("calMain", "calDrinker").
+#define ADC_SAMPLE_RATE 20000         // Hz across both channels (the ESP32 minimum)
+#define ADC_CONVERSIONS_PER_PIN 64    // Averaged by the driver into one block
+#define ADC_FALLBACK_SAMPLES 8        // analogRead() burst per pass without continuous mode
+#define ADC_DECIMATION 16             // Blocks per decimated sample (~10 Hz)
+#define ADC_IIR_SHIFT 3               // Smoothing after decimation: y += (x - y) / 8
+#define CALIBRATION_POINTS 4
+
+struct AdcDecimator {
+  uint32_t sum;
+  uint16_t count;
+  int32_t value;      // Q8 raw counts
+  bool primed;
+};
+
+// Piecewise-linear raw -> percent curve with ascending raw points
+struct LevelCalibration {
+  uint8_t count;
+  uint16_t raw[CALIBRATION_POINTS];
+  uint8_t percent[CALIBRATION_POINTS];
+};
+
+// Network -> control: a curve entered on the console replaces the control copy
+struct CalibrationUpdate {
+  uint8_t channel;       // 0 = main tank, 1 = drinker
+  LevelCalibration calibration;
+};
+
+AdcDecimator waterMainAdc = {};
+AdcDecimator waterDrinkerAdc = {};
+LevelCalibration waterMainCalibration = {2, {600, 2800}, {0, 100}};       // e.g. 13cm = full
+LevelCalibration waterDrinkerCalibration = {2, {700, 2400}, {0, 100}};    // e.g. 4.5cm = full
+volatile bool adcBlockReady = false;
+
+// Database request accounting, filled in by the rtdb* transport functions
+enum RtdbRequestKind {
+  RTDB_PATCH,
+  RTDB_GET,
+  RTDB_STREAM_BEGIN
+};
+
+struct RtdbStats {
+  unsigned long requests;
+  unsigned long failures;
+  unsigned long lastLatency;   // ms
+  unsigned long maxLatency;
+};
+RtdbStats rtdbStats = {};
+
+// Result of one request
+struct RtdbResponse {
+  bool ok;
+  bool skipped;            // Refused locally because the link is down
+  int httpCode;
+  unsigned long latency;   // ms
+  const char* payload;     // GET body as JSON text, valid until the next request
+};
+
+// One event from the control stream. path is relative to the watched node
+// and data is the JSON text of the new value, valid until the next read.
+#define STREAM_PATH_SIZE 64
+struct StreamEvent {
+  bool available;
+  bool patch;              // Only the children listed in data changed
+  char path[STREAM_PATH_SIZE];
+  const char* data;
+};
+
+// Link health - after LINK_FAILURE_LIMIT failed requests in a row the link
+// is marked down and the rtdb* functions fail at once instead of each
+// waiting out its own timeout. A single probe request is let through once
+// the backoff delay has passed; the delay doubles after every failed probe
+// and is jittered so a fleet does not reconnect in lockstep.
+#define LINK_FAILURE_LIMIT 3
+#define LINK_BACKOFF_MIN 2000        // ms
+#define LINK_BACKOFF_MAX 120000
+#define LINK_JITTER_PERCENT 25       // +/- share of the delay
+
+struct LinkHealth {
+  bool up;
+  uint8_t consecutiveFailures;
+  unsigned long backoff;         // Delay before the next probe (ms)
+  unsigned long probeTime;
+  unsigned long downSince;
+  unsigned long outages;
+  unsigned long shortCircuited;  // Requests refused while down
+};
+LinkHealth linkHealth = {true, 0, LINK_BACKOFF_MIN, 0, 0, 0, 0};
+
+// Loop-phase profiler - per-phase microsecond timings in log2 histograms,
+// missed control ticks, published to /diagnostics/perf and printed by the
+// "perf" serial command. Set PERF_PROFILING to 0 to compile it all out.
+#ifndef PERF_PROFILING
+#define PERF_PROFILING 1
+#endif
+
+enum PerfPhase {
+  PERF_READ_SENSORS,
+  PERF_ALERTS,
+  PERF_MANUAL_CONTROLS,
+  PERF_AUTOMATION,
+  PERF_FEEDING_SCHEDULE,
+  PERF_WATER_SCHEDULE,
+  PERF_CONTROL_TICK,      // The whole 1 s tick
+  PERF_TICK_LATENESS,     // How late the tick started
+  PERF_UPDATE_FIREBASE,
+  PERF_RTDB_REQUEST,      // Every counted database request
+  PERF_PHASE_COUNT
+};
+
+#define PERF_BUCKETS 21           // Bucket N holds [2^N, 2^(N+1)) us; the last one is open-ended
+#define PERF_REPORT_INTERVAL 60000
+
+struct PerfHistogram {
+  uint32_t count;
+  uint32_t maxMicros;
+  uint64_t totalMicros;
+  uint32_t buckets[PERF_BUCKETS];
+};
+
+#if PERF_PROFILING
+const char* const perfPhaseNames[PERF_PHASE_COUNT] = {
+  "readSensors", "alerts", "manualControls", "automation", "feedingSchedule",
+  "waterSchedule", "controlTick", "tickLateness", "updateFirebase", "rtdbRequest"
+};
+
+// Each phase is only written by the task that runs it
+PerfHistogram perfHistograms[PERF_PHASE_COUNT];
+uint32_t perfMissedTicks = 0;
+unsigned long lastPerfReport = 0;
+int perfReportPhase = -2;           // Next line of the serial report: -1 header, -2 idle
+int perfReportBucket = -1;          // -1 = the phase's summary line
+
+// PERF_MARK records the time since the previous mark, PERF_SKIP leaves a
+// stretch unrecorded and PERF_TOTAL records the time since PERF_BEGIN
+#define PERF_BEGIN() uint32_t perfStart = halMicros(); uint32_t perfMark = perfStart
+#define PERF_MARK(phase) do { uint32_t perfNow = halMicros(); perfRecord(phase, perfNow - perfMark); perfMark = perfNow; } while (0)
+#define PERF_SKIP() perfMark = halMicros()
+#define PERF_TOTAL(phase) perfRecord(phase, halMicros() - perfStart)
+#else
+#define PERF_BEGIN() do {} while (0)
+#define PERF_MARK(phase) do {} while (0)
+#define PERF_SKIP() do {} while (0)
+#define PERF_TOTAL(phase) do {} while (0)
+#endif
+
+#ifdef POULTRY_SIMULATION
+// Simulated barn - the harness sets the sensor values and moves the host
+// clock (sim/host_platform.h); the sketch's relay and servo writes land here.
+// Database requests go to simRtdb, the in-process RTDB from the same header.
+#define SIM_RELAY_COUNT 4
+struct SimulatedBarn {
+  time_t virtualEpoch;         // Wall clock at halMillis() == 0
+  float temperature;
+  float humidity;
+  float foodDistanceCm;
+  int waterMainRaw;
+  int waterDrinkerRaw;
+  bool relayOn[SIM_RELAY_COUNT];   // Fan, heat, pump, spare
+  int servoAngle;
+  unsigned long servoOpenedAt;
+  float feedFlowRate;          // g/s that really leave while the feeder is open
+  float hopperGramsPerCm;      // Level drop per gram dispensed
+  float feedDispensedGrams;    // Total that left the hopper
+  int pumpRawPerSecond;        // Drinker raw reading gained per second of pumping
+  unsigned long pumpCheckedAt;
+  unsigned long relayWrites[SIM_RELAY_COUNT];
+};
+SimulatedBarn simBarn = {1700000000, 25, 60, 2, 2000, 2000, {false, false, false, false}, SERVO_CLOSE_ANGLE,
+                         0, 40, 500, 0, 100, 0, {0, 0, 0, 0}};
+#endif
 
 // Variables
 float temperature = 0;
@@ -70,27 +357,315 @@ bool automationEnabled = true;
 unsigned long previousMillis = 0;
 const long interval = 1000; // Interval for sensor readings (1 second)
 
-// Alert tracking variables
-bool highTempAlertActive = false;
-bool lowTempAlertActive = false;
-bool lowFoodAlertActive = false;
-bool lowWaterMainAlertActive = false;
-bool lowWaterDrinkerAlertActive = false;
+// Climate control - hysteresis bands and minimum dwell times keep the fan
+// and heat lamp from chattering around the thresholds. The heat lamp can
+// instead run time-proportional: a PI loop sets the share of each window
+// the lamp is on.
+#define CLIMATE_HYSTERESIS 1.0        // °C between switching on and switching back off
+#define FAN_MIN_ON_TIME 60000         // ms
+#define FAN_MIN_OFF_TIME 60000
+#define HEAT_MIN_ON_TIME 60000
+#define HEAT_MIN_OFF_TIME 60000
+#define HEAT_MODE_HYSTERESIS 0
+#define HEAT_MODE_TIME_PROPORTIONAL 1
+#define HEAT_SETPOINT (TEMP_LOW_THRESHOLD + 2.0)  // Time-proportional target (°C)
+#define HEAT_KP 0.25                  // Duty per °C below the setpoint
+#define HEAT_KI 0.0005                // Duty per °C·s
+#define HEAT_WINDOW 300000            // ms per time-proportional cycle
+
+struct ClimateRelay {
+  uint8_t pin;
+  bool* state;
+  unsigned long lastChange;    // 0 until the first switch, so boot is never held back
+  unsigned long minOnTime;
+  unsigned long minOffTime;
+  unsigned long toggles;
+};
+
+struct HeatPi {
+  float integral;              // °C·s
+  unsigned long lastUpdate;
+  unsigned long windowStart;
+  unsigned long windowOnTime;  // ms of the current window the lamp is on
+};
+
+ClimateRelay fanRelay = {RELAY_FAN, &fanState, 0, FAN_MIN_ON_TIME, FAN_MIN_OFF_TIME, 0};
+ClimateRelay heatRelay = {RELAY_HEAT, &heatState, 0, HEAT_MIN_ON_TIME, HEAT_MIN_OFF_TIME, 0};
+HeatPi heatPi = {};
+
+// Runtime configuration - thresholds and calibration that can be changed
+// under /config without reflashing. The #defines are the defaults; the
+// last synced values are cached in NVS ("config") and loaded at boot
+// before any network access. Hot paths read deviceConfig fields directly.
+#define CONFIG_VERSION 3
+
+struct DeviceConfig {
+  uint16_t version;
+  uint16_t size;               // Layout check for the NVS copy
+  float tempHigh;              // °C
+  float tempLow;
+  float climateHysteresis;
+  float heatSetpoint;          // Time-proportional heat target
+  int32_t heatMode;            // HEAT_MODE_*
+  int32_t foodLow;             // %
+  int32_t waterMainLow;
+  int32_t waterDrinkerLow;
+  int32_t hydrationWarning;    // ml per bird per day
+  int32_t hydrationAlert;
+  float gramsPerSecond;        // Feeder rate at the open angle
+  int32_t foodFullCm;          // Ultrasonic distance with a full hopper
+  int32_t foodEmptyCm;
+  int32_t servoOpenAngle;
+  int32_t servoCloseAngle;
+  int32_t hopperCapacity;      // g between foodFullCm and foodEmptyCm
+  int32_t drinkerCapacity;     // ml between 0% and 100% drinker level
+  int32_t drinkerRefillLevel;  // %
+  int32_t drinkerTarget;       // %
+};
+
+enum ConfigFieldType {
+  CONFIG_FLOAT,
+  CONFIG_INT
+};
+
+// One /config key, where it lives in DeviceConfig and its accepted range
+struct ConfigField {
+  const char* key;
+  uint8_t type;
+  size_t offset;
+  float minValue;
+  float maxValue;
+};
+
+const DeviceConfig defaultConfig = {
+  CONFIG_VERSION, sizeof(DeviceConfig),
+  TEMP_HIGH_THRESHOLD, TEMP_LOW_THRESHOLD, CLIMATE_HYSTERESIS, HEAT_SETPOINT, HEAT_MODE_HYSTERESIS,
+  FOOD_LOW_THRESHOLD, WATER_MAIN_LOW_THRESHOLD, WATER_DRINKER_LOW_THRESHOLD,
+  HYDRATION_WARNING_THRESHOLD, HYDRATION_ALERT_THRESHOLD,
+  GRAMS_PER_SECOND, FOOD_FULL_DISTANCE, FOOD_EMPTY_DISTANCE, SERVO_OPEN_ANGLE, SERVO_CLOSE_ANGLE,
+  HOPPER_CAPACITY_GRAMS, DRINKER_CAPACITY, DRINKER_REFILL_LEVEL, DRINKER_TARGET_LEVEL
+};
+
+const ConfigField configFields[] = {
+  {"tempHigh", CONFIG_FLOAT, offsetof(DeviceConfig, tempHigh), -20, 60},
+  {"tempLow", CONFIG_FLOAT, offsetof(DeviceConfig, tempLow), -20, 60},
+  {"climateHysteresis", CONFIG_FLOAT, offsetof(DeviceConfig, climateHysteresis), 0, 10},
+  {"heatSetpoint", CONFIG_FLOAT, offsetof(DeviceConfig, heatSetpoint), -20, 60},
+  {"heatMode", CONFIG_INT, offsetof(DeviceConfig, heatMode), HEAT_MODE_HYSTERESIS, HEAT_MODE_TIME_PROPORTIONAL},
+  {"foodLow", CONFIG_INT, offsetof(DeviceConfig, foodLow), 0, 100},
+  {"waterMainLow", CONFIG_INT, offsetof(DeviceConfig, waterMainLow), 0, 100},
+  {"waterDrinkerLow", CONFIG_INT, offsetof(DeviceConfig, waterDrinkerLow), 0, 100},
+  {"hydrationWarning", CONFIG_INT, offsetof(DeviceConfig, hydrationWarning), 0, 5000},
+  {"hydrationAlert", CONFIG_INT, offsetof(DeviceConfig, hydrationAlert), 0, 5000},
+  {"gramsPerSecond", CONFIG_FLOAT, offsetof(DeviceConfig, gramsPerSecond), 1, 1000},
+  {"foodFullCm", CONFIG_INT, offsetof(DeviceConfig, foodFullCm), 0, MAX_DISTANCE},
+  {"foodEmptyCm", CONFIG_INT, offsetof(DeviceConfig, foodEmptyCm), 0, MAX_DISTANCE},
+  {"servoOpenAngle", CONFIG_INT, offsetof(DeviceConfig, servoOpenAngle), 0, 180},
+  {"servoCloseAngle", CONFIG_INT, offsetof(DeviceConfig, servoCloseAngle), 0, 180},
+  {"hopperCapacity", CONFIG_INT, offsetof(DeviceConfig, hopperCapacity), 100, 100000},
+  {"drinkerCapacity", CONFIG_INT, offsetof(DeviceConfig, drinkerCapacity), 100, 100000},
+  {"drinkerRefillLevel", CONFIG_INT, offsetof(DeviceConfig, drinkerRefillLevel), 0, 100},
+  {"drinkerTarget", CONFIG_INT, offsetof(DeviceConfig, drinkerTarget), 0, 100},
+};
+const int CONFIG_FIELD_COUNT = sizeof(configFields) / sizeof(configFields[0]);
+
+DeviceConfig deviceConfig = defaultConfig;    // Control task copy
+DeviceConfig networkConfig = defaultConfig;   // Network task copy - /config updates land here first
+
+// Event codes. Events go over the wire as a code plus a few numbers and the
+// dashboard (lib/event-codes.ts) turns them into text. Codes are stored in
+// the database, so never renumber one - retire it and add a new code.
+// Alert events carry the reading and the threshold, both x10.
+enum EventCode : uint8_t {
+  EVENT_SYSTEM_STARTED = 1,
+  EVENT_AUTOMATIC_MODE = 2,
+  EVENT_MANUAL_MODE = 3,
+  EVENT_HIGH_TEMPERATURE = 10,
+  EVENT_HIGH_TEMPERATURE_RESOLVED = 11,
+  EVENT_LOW_TEMPERATURE = 12,
+  EVENT_LOW_TEMPERATURE_RESOLVED = 13,
+  EVENT_LOW_FOOD = 14,
+  EVENT_LOW_FOOD_RESOLVED = 15,
+  EVENT_LOW_WATER_MAIN = 16,
+  EVENT_LOW_WATER_MAIN_RESOLVED = 17,
+  EVENT_LOW_WATER_DRINKER = 18,
+  EVENT_LOW_WATER_DRINKER_RESOLVED = 19,
+  EVENT_LOW_HYDRATION = 20,           // ml per bird, ml per bird expected by now
+  EVENT_HYDRATION_RESOLVED = 21,      // ml per bird
+  EVENT_SENSOR_FAULT = 30,            // s without a valid DHT reading
+  EVENT_PUMP_FAULT = 31,              // s pumped without the drinker level rising
+  EVENT_FEEDER_FAULT = 32,            // Pulses that moved no feed
+  EVENT_FAN_MANUAL = 40,              // 1 = on
+  EVENT_HEAT_MANUAL = 41,             // 1 = on
+  EVENT_PUMP_MANUAL = 42,             // 1 = on
+  EVENT_FAN_AUTO = 50,                // 1 = on, temperature x10
+  EVENT_HEAT_AUTO = 51,               // 1 = on, temperature x10, 1 = switched off for the fan
+  EVENT_REFILL_AUTO = 52,             // Drinker level %, refill level %
+  EVENT_PUMP_AUTO_OFF = 53,
+  EVENT_FEEDING = 60,                 // g, chicken count, age group (0 chick, 1 grower, 2 adult)
+  EVENT_WATER_REFILLED = 61,          // ml, from %, to %, s, RefillStop
+  EVENT_SCHEDULED_FEEDING = 62,       // Minute of the day, minutes late
+  EVENT_SCHEDULED_WATER = 63,         // Minute of the day
+  EVENT_SCHEDULE_MISSED = 64,         // ScheduleKind, minute of the day, minutes overdue
+  EVENT_SCHEDULED_WATER_SKIPPED = 65  // Minute of the day, FillRefusal
+};
+
+// Why a drinker refill ended
+enum RefillStop : uint8_t {
+  REFILL_TIME_LIMIT,
+  REFILL_TARGET_REACHED,
+  REFILL_MAIN_LOW,
+  REFILL_NOT_RISING
+};
+
+// Why a drinker refill did not start
+enum FillRefusal : uint8_t {
+  FILL_STARTED,
+  FILL_MAIN_LOW,
+  FILL_DRINKER_FULL
+};
+
+// Threshold alerts - one row per alert, evaluated in a single pass over
+// AlertInputs. A new alert is a new row plus its two event codes.
+enum AlertSensor : uint8_t {
+  ALERT_SENSOR_TEMPERATURE,
+  ALERT_SENSOR_FOOD,
+  ALERT_SENSOR_WATER_MAIN,
+  ALERT_SENSOR_WATER_DRINKER,
+  ALERT_SENSOR_COUNT
+};
+
+enum AlertThreshold : uint8_t {
+  THRESHOLD_TEMP_HIGH,
+  THRESHOLD_TEMP_LOW,
+  THRESHOLD_FOOD_LOW,
+  THRESHOLD_WATER_MAIN_LOW,
+  THRESHOLD_WATER_DRINKER_LOW,
+  THRESHOLD_COUNT
+};
+
+enum AlertComparator : uint8_t {
+  ALERT_ABOVE,
+  ALERT_BELOW
+};
+
+struct AlertRule {
+  uint8_t sensor;
+  uint8_t comparator;
+  uint8_t threshold;
+  uint8_t raised;    // EventCode when the alert starts
+  uint8_t resolved;  // EventCode when it clears
+};
+
+// Row order - the telemetry snapshot reads the alert bits by these
+enum AlertIndex {
+  ALERT_HIGH_TEMPERATURE,
+  ALERT_LOW_TEMPERATURE,
+  ALERT_LOW_FOOD,
+  ALERT_LOW_WATER_MAIN,
+  ALERT_LOW_WATER_DRINKER,
+  ALERT_RULE_COUNT
+};
+
+constexpr AlertRule alertRules[ALERT_RULE_COUNT] = {
+  {ALERT_SENSOR_TEMPERATURE, ALERT_ABOVE, THRESHOLD_TEMP_HIGH, EVENT_HIGH_TEMPERATURE, EVENT_HIGH_TEMPERATURE_RESOLVED},
+  {ALERT_SENSOR_TEMPERATURE, ALERT_BELOW, THRESHOLD_TEMP_LOW, EVENT_LOW_TEMPERATURE, EVENT_LOW_TEMPERATURE_RESOLVED},
+  {ALERT_SENSOR_FOOD, ALERT_BELOW, THRESHOLD_FOOD_LOW, EVENT_LOW_FOOD, EVENT_LOW_FOOD_RESOLVED},
+  {ALERT_SENSOR_WATER_MAIN, ALERT_BELOW, THRESHOLD_WATER_MAIN_LOW, EVENT_LOW_WATER_MAIN, EVENT_LOW_WATER_MAIN_RESOLVED},
+  {ALERT_SENSOR_WATER_DRINKER, ALERT_BELOW, THRESHOLD_WATER_DRINKER_LOW, EVENT_LOW_WATER_DRINKER, EVENT_LOW_WATER_DRINKER_RESOLVED},
+};
+
+// Where each threshold lives in DeviceConfig
+constexpr ConfigField alertThresholdFields[THRESHOLD_COUNT] = {
+  {"tempHigh", CONFIG_FLOAT, offsetof(DeviceConfig, tempHigh), 0, 0},
+  {"tempLow", CONFIG_FLOAT, offsetof(DeviceConfig, tempLow), 0, 0},
+  {"foodLow", CONFIG_INT, offsetof(DeviceConfig, foodLow), 0, 0},
+  {"waterMainLow", CONFIG_INT, offsetof(DeviceConfig, waterMainLow), 0, 0},
+  {"waterDrinkerLow", CONFIG_INT, offsetof(DeviceConfig, waterDrinkerLow), 0, 0},
+};
+
+// Everything the rules compare, x10 so one integer comparison fits all of
+// them. Thresholds are refreshed when the configuration changes, readings
+// once per tick.
+struct AlertInputs {
+  int32_t reading[ALERT_SENSOR_COUNT];
+  int32_t threshold[THRESHOLD_COUNT];
+  uint8_t validSensors;   // Bit per AlertSensor - stale readings neither raise nor clear
+};
+
+AlertInputs alertInputs = {};
+uint16_t activeAlerts = 0;            // Bit per AlertIndex
 bool lowHydrationAlertActive = false;
 
-// Feeding schedule
-int feedingHours[] = {8, 12, 16}; // Feeding times (24-hour format)
-int lastFeedingHour = -1;
+// Daily schedules - /feedingSchedule and /waterSchedule compiled into a
+// sorted list of fire times. Keys are "H" (on the hour) or "HH:MM"; a value
+// of true uses the current settings, a number sets the amount for that entry
+// (feed: grams, water: drinker target %), false/null removes it. Kept current
+// by the control stream and persisted to flash so scheduling keeps working
+// offline.
+#define SCHEDULE_MAX_ENTRIES 32
+#define SCHEDULE_CATCHUP_GRACE 900  // s a missed entry may still run late (stall, reboot)
+#define SCHEDULE_CACHE_TTL 3600000  // Re-fetch a schedule hourly while the stream is down
+
+struct ScheduleEntry {
+  uint16_t minute;  // Minute of the day, 0..1439
+  uint16_t amount;  // 0 = use the current settings
+};
+
+struct DailySchedule {
+  uint8_t count;
+  ScheduleEntry entries[SCHEDULE_MAX_ENTRIES];  // Sorted by minute
+};
+
+enum ScheduleKind {
+  SCHEDULE_FEEDING,
+  SCHEDULE_WATER,
+  SCHEDULE_KIND_COUNT
+};
+
+// Network -> control: a recompiled schedule replaces the control copy
+struct ScheduleUpdate {
+  uint8_t kind;
+  DailySchedule schedule;
+};
+
+// Control task side - only the next deadline is compared on each tick
+struct ScheduleTimer {
+  DailySchedule schedule;
+  time_t handledUntil;   // Every fire time up to here has run or been skipped
+  time_t nextFire;       // 0 = nothing scheduled (or no wall clock yet)
+  uint16_t nextMinute;
+  uint16_t nextAmount;
+};
+
+DailySchedule networkSchedules[SCHEDULE_KIND_COUNT];  // Network task copy (applies stream patches, saves to flash)
+ScheduleTimer scheduleTimers[SCHEDULE_KIND_COUNT];    // Control task copy
+const char* const scheduleStoreKeys[SCHEDULE_KIND_COUNT] = {"feedTimes", "waterTimes"};
+const char* const scheduleLegacyKeys[SCHEDULE_KIND_COUNT] = {"feedSched", "waterSched"};  // Hour bitmaps
+const char* const scheduleFiredKeys[SCHEDULE_KIND_COUNT] = {"feedFired", "waterFired"};
+
+// Non-volatile storage
+Preferences preferences;
+#define PREFERENCES_NAMESPACE "poultry"
 
-// History update timer
-unsigned long lastHistoryUpdate = 0;
-const long historyInterval = 300000; // 5 minutes in milliseconds
+// History - every reading is folded into 5 minute min/max/mean intervals,
+// intervals are packed into one block per hour (/historyBlocks/<epoch>) and
+// hours are rolled up into one block per day (/historyDaily/<epoch>)
+#define HISTORY_INTERVAL_SECONDS 300
+#define HISTORY_SLOTS_PER_HOUR 12
+#define HISTORY_SLOTS_PER_DAY 24
+#define HISTORY_DIR "/hist"
+#define HISTORY_LOCAL_RETENTION (48UL * 3600)   // Hour blocks kept on flash (seconds)
+#define HISTORY_DAILY_LOCAL_RETENTION (3UL * 86400)
+#define HISTORY_CLOUD_RETENTION (8UL * 86400)   // Hour blocks kept in the database; daily blocks are kept
+#define TIME_VALID_AFTER 1600000000UL           // Earlier clock values mean SNTP has not synced yet
+#define GMT_OFFSET_SECONDS (8 * 3600)
 
 // Intelligent feeding variables
 float feedDuration = 0;       // Duration to keep servo open in seconds
 unsigned long lastFeedingTime = 0;
 bool intelligentFeedingEnabled = true;
-String currentAgeGroup = "adult"; // Default age group (chick, grower, adult)
+char currentAgeGroup[12] = "adult"; // Default age group (chick, grower, adult)
 int chickenCount = 10;           // Default chicken count
 bool isFeeding = false;          // Flag to prevent multiple feeding commands
 unsigned long feedingStartTime = 0; // Track when feeding started
@@ -108,494 +683,3614 @@ unsigned long waterFillCooldown = 0;  // Cooldown period after water filling
 unsigned long lastWaterFillTime = 0;  // Track when the last water fill occurred
 unsigned long lastWaterCommandTime = 0; // Track when the last water command was received
 const unsigned long WATER_COMMAND_TIMEOUT = 60000; // 60 seconds timeout for water commands
-int lastWaterFillHour = -1;           // Track the last hour water was filled
-unsigned long totalWaterToday = 0;    // Total water dispensed today in ml
-unsigned long waterPerBird = 0;       // Water per bird in ml
+unsigned long waterPerBird = 0;       // Water drunk per bird today in ml
+unsigned long drinkRate = 0;          // Smoothed intake in ml per hour
+
+// Demand-driven refill - a fill runs until the drinker reaches its target
+// level, with waterFillDuration as the upper bound. It stops early if the
+// main tank drops below its low threshold (dry-run guard) or if the drinker
+// level has not risen after REFILL_RISE_TIMEOUT.
+#define REFILL_RISE_TIMEOUT 10000   // ms
+#define REFILL_MIN_RISE 2           // % the level must have risen by then
+#define WATER_LEVEL_DEADBAND 1      // % change before intake is booked
+#define DRINK_RATE_ALPHA 0.2
+#define HYDRATION_GRACE_PERIOD 7200 // s into the day before intake is judged
+#define HYDRATION_CHECK_INTERVAL 60000 // ms - also catches birds that stop drinking altogether
+
+int refillStartLevel = 0;             // Drinker level when the fill started (%)
+int refillTargetLevel = 0;            // Level the running fill stops at (%)
+uint8_t refillStopReason = REFILL_TIME_LIMIT;  // Set when a guard ends the fill early
+int intakeReferenceLevel = -1;        // Drinker level intake is measured from; -1 = not set
+unsigned long intakeReferenceTime = 0;
+unsigned long lastHydrationCheck = 0;
 unsigned long dayStartTime = 0;       // Start of the current day
 
-// Function to log events to Firebase
-void logEvent(String eventType, String description) {
-  if (Firebase.ready() && signupOK) {
-    FirebaseJson json;
-    json.set("timestamp", time(NULL));
-    json.set("type", eventType);
-    json.set("description", description);
-    
-    String path = "/events/" + String(time(NULL));  
-    if (Firebase.RTDB.setJSON(&fbdo, path.c_str(), &json)) {
-      Serial.println("Event logged: " + eventType + " - " + description);
-    } else {
-      Serial.println("Failed to log event: " + fbdo.errorReason());
+// Per-day feed and water totals for the last DAILY_HISTORY_DAYS calendar
+// days, kept by the control task and saved to flash so a restart keeps
+// today's counts. Entry 0 is the current day.
+#define DAILY_HISTORY_DAYS 7
+#define DAILY_SAVE_INTERVAL 900000  // ms between saving and publishing today's totals
+
+struct DayTotals {
+  uint32_t day;            // Local calendar day as YYYYMMDD; 0 = not known yet
+  uint32_t waterDrunk;     // ml, from the drinker level
+  uint32_t waterRefilled;  // ml
+  uint32_t feedGrams;
+  uint16_t feedings;
+  uint16_t refills;
+};
+
+DayTotals dailyHistory[DAILY_HISTORY_DAYS];
+time_t nextDayStart = 0;              // Local midnight that ends the current day
+unsigned long lastDailySave = 0;
+bool dailyHistoryDirty = false;
+
+// Actuator state machines - the feeder and pump are ticked by the control task instead of using delay()
+enum ActuatorPhase {
+  ACTUATOR_IDLE,       // Closed/off and ready for a new dispense
+  ACTUATOR_OPEN,       // Dispense requested, open on the next tick
+  ACTUATOR_DISPENSING, // Open, waiting for the dispense time to elapse
+  ACTUATOR_CLOSING,    // Closed, waiting for the mechanism to settle
+  ACTUATOR_SETTLED     // Done, run completion bookkeeping and go idle
+};
+
+struct Actuator {
+  ActuatorPhase phase;
+  unsigned long phaseStartTime;   // halMillis() when the current phase began
+  unsigned long dispenseMillis;   // How long to stay open
+  unsigned long settleMillis;     // How long to wait after closing
+  unsigned long cooldownAfter;    // Cooldown to apply once settled
+  bool resetControlOnDone;        // Clear the /controls flag that started the dispense
+};
+
+#define SERVO_SETTLE_TIME 1000   // Time for the feeder servo to close completely (ms)
+
+Actuator feeder = {ACTUATOR_IDLE, 0, 0, SERVO_SETTLE_TIME, 0, false};
+
+// Closed-loop feeding - a dispense is split into servo pulses. After each
+// pulse the hopper level is re-read through the ultrasonic filter and the
+// drop since the dispense started is credited, so a pulse too small to see
+// on its own is still measured as part of the total. The remaining pulses
+// use the rate measured so far, and the flow model (grams per second of
+// open servo) is moved towards it once the feeding is done. The model
+// starts from deviceConfig.gramsPerSecond and is kept in NVS ("feedRate").
+// Without a usable level reading the dispense falls back to one timed pulse.
+#define FEED_FIRST_PULSE_SHARE 0.8   // The first pulse aims short so it cannot overshoot
+#define FEED_MAX_PULSES 4
+#define FEED_MAX_EMPTY_PULSES 2      // Pulses that moved nothing before giving up
+#define FEED_MIN_PULSE_MS 200
+#define FEED_MEASURE_DELAY 3000      // ms after closing for the feed and the level filter to settle
+#define FEED_LEVEL_RESOLUTION 0.2    // cm; smaller level changes are treated as noise
+#define FEED_TOLERANCE_GRAMS 10
+#define FEED_RATE_ALPHA 0.3          // Model update weight per measured feeding
+#define FEED_RATE_MIN 5.0            // g/s
+#define FEED_RATE_MAX 500.0
+
+struct FeedDispense {
+  bool active;
+  bool closedLoop;              // The hopper level is being measured
+  bool measuring;               // Waiting FEED_MEASURE_DELAY after a pulse
+  bool stopRequested;           // Timed out - finish after the current pulse
+  bool learned;                 // The model changed during this dispense
+  float targetGrams;
+  float dispensedGrams;
+  float levelStart;             // Filtered distance before the first pulse (cm)
+  float levelBefore;            // Filtered distance before the current pulse (cm)
+  float pulseSeconds;
+  float totalSeconds;           // Servo open time over all pulses so far
+  float rate;                   // g/s for the next pulse - the model, then the measured rate
+  uint8_t pulses;
+  uint8_t emptyPulses;
+  unsigned long measureStart;
+  unsigned long cooldownAfter;
+  bool resetControlOnDone;
+};
+FeedDispense feedDispense = {};
+float feedRate = GRAMS_PER_SECOND;   // Learned flow model (g/s)
+Actuator waterPump = {ACTUATOR_IDLE, 0, 0, 0, 0, false};
+
+// Control channel - a single RTDB stream on DEVICE_ROOT pushes /controls,
+// the settings, the schedules and /config to us instead of polling them
+// every tick. One stream is one TLS connection; each event is routed to a
+// node's handler by the first segment of its path.
+#define DEVICE_ROOT "/device"
+
+struct StreamRoute {
+  const char* node;           // Child of DEVICE_ROOT
+  void (*handler)(const char* relativePath, const char* json);
+  unsigned long pollInterval; // Fallback poll interval while the stream is down
+  unsigned long lastPollTime;
+};
+
+bool controlStreamStarted = false;
+bool controlStreamHealthy = false;   // Connected and delivering events
+
+// Walks JSON text in place (see jsonOpen()/jsonNext())
+struct JsonCursor {
+  const char* next;
+  bool array;
+  int index;
+};
+
+#define CONTROL_POLL_FALLBACK_INTERVAL 1000 // Poll at the old cadence while the stream is down
+
+// Last values pushed by the dashboard (applied by checkManualControls())
+bool controlsSynced = false;          // A full /controls snapshot has been received
+bool requestedAutomation = true;
+bool requestedFan = false;
+bool requestedHeat = false;
+bool requestedPump = false;
+bool requestedFeed = false;
+float requestedFeedDuration = 0;
+float requestedFeedGrams = 0;
+bool requestedWaterFill = false;
+bool controlsChanged = false;         // Apply immediately instead of waiting for the next tick
+
+// Multi-path PATCH frames - a JSON object of "full/path": value pairs built in
+// a fixed buffer and sent as one update on the root
+struct PatchFrame {
+  char* buffer;
+  size_t size;
+  size_t length;
+  bool overflow;
+};
+
+// Telemetry frame - all per-tick values are sent as one multi-path PATCH on the root
+#define TELEMETRY_FRAME_SIZE 768
+char telemetryBuffer[TELEMETRY_FRAME_SIZE];
+PatchFrame telemetryFrame = {telemetryBuffer, TELEMETRY_FRAME_SIZE, 0, false};
+unsigned long telemetryFramesSent = 0;
+unsigned long telemetryFramesFailed = 0;
+
+// Heap watermark report - messages are formatted into fixed buffers, so once
+// the system has settled the free heap should stop moving. The report shows
+// drift from the settled baseline and how fragmented the free space is.
+#define HEAP_REPORT_INTERVAL 300000   // ms
+#define HEAP_SETTLE_TIME 120000       // Baseline is taken this long after boot (ms)
+#define DIAGNOSTICS_FRAME_SIZE 768   // Shared with the perf report
+char diagnosticsBuffer[DIAGNOSTICS_FRAME_SIZE];
+PatchFrame diagnosticsFrame = {diagnosticsBuffer, DIAGNOSTICS_FRAME_SIZE, 0, false};
+uint32_t heapBaseline = 0;
+unsigned long lastHeapReport = 0;
+
+// Delta publishing - only values that moved past their deadband are sent,
+// with a periodic full refresh so the database never drifts for long
+#define TEMP_DEADBAND 0.2          // °C
+#define HUMIDITY_DEADBAND 1.0      // %
+#define LEVEL_DEADBAND 1           // % for food and water levels
+#define WATER_TOTAL_DEADBAND 50    // ml
+#define TELEMETRY_HEARTBEAT_INTERVAL 60000 // Full refresh every 60 seconds
+
+// Copy of the values last acknowledged by the database
+struct TelemetryShadow {
+  float temperature;
+  float humidity;
+  long foodLevel;
+  long waterLevelMain;
+  long waterLevelDrinker;
+  bool fan;
+  bool heat;
+  bool pump;
+  bool highTemperature;
+  bool lowTemperature;
+  bool lowFood;
+  bool lowWaterMain;
+  bool lowWaterDrinker;
+  bool lowHydration;
+  bool isFeeding;
+  bool isWaterFilling;
+  long totalToday;
+  long perBird;
+  long drinkRate;
+};
+TelemetryShadow publishedShadow;  // Acknowledged by the database
+TelemetryShadow frameShadow;      // Values carried by the frame being built
+bool publishedShadowValid = false;
+bool telemetryFullRefresh = true;
+unsigned long lastFullTelemetryTime = 0;
+unsigned long telemetryFieldsSent = 0;
+unsigned long telemetryFieldsSuppressed = 0;
+
+// Task split - sensing, alerts, automation and actuators run in the control
+// task on core 1; all Firebase I/O runs in the network task on core 0.
+// The two tasks only exchange data through the queues below, so a stalled
+// TLS request can never delay a relay decision.
+#define CONTROL_TASK_CORE 1
+#define NETWORK_TASK_CORE 0
+#define CONTROL_TASK_PRIORITY 3
+#define NETWORK_TASK_PRIORITY 1
+#define CONTROL_TASK_STACK 8192
+#define NETWORK_TASK_STACK 16384
+#define CONTROL_TASK_PERIOD_MS 10
+TaskHandle_t controlTaskHandle = NULL;
+TaskHandle_t networkTaskHandle = NULL;
+unsigned long lastServoCheck = 0;
+
+// Single-producer/single-consumer ring queue. push() is only ever called
+// from one task and pop() from the other, so head and tail need no lock.
+// Holds N - 1 items.
+template <typename T, size_t N>
+class SpscQueue {
+ public:
+  bool push(const T& item) {
+    size_t head = headIndex.load(std::memory_order_relaxed);
+    size_t next = (head + 1) % N;
+    if (next == tailIndex.load(std::memory_order_acquire)) {
+      droppedCount++;
+      return false; // Full
     }
+    items[head] = item;
+    headIndex.store(next, std::memory_order_release);
+    return true;
   }
-}
-
-// Function to log feeding data for analytics
-void logFeedingData(int gramsDispensed, String ageGroup, int count) {
-  if (Firebase.ready() && signupOK) {
-    FirebaseJson json;
-    json.set("timestamp", time(NULL));
-    json.set("gramsDispensed", gramsDispensed);
-    json.set("ageGroup", ageGroup);
-    json.set("chickenCount", count);
-    
-    String path = "/feedingLogs/" + String(time(NULL));  
-    if (Firebase.RTDB.setJSON(&fbdo, path.c_str(), &json)) {
-      Serial.println("Feeding data logged successfully");
-    } else {
-      Serial.println("Failed to log feeding data: " + fbdo.errorReason());
+  
+  bool pop(T& item) {
+    size_t tail = tailIndex.load(std::memory_order_relaxed);
+    if (tail == headIndex.load(std::memory_order_acquire)) {
+      return false; // Empty
     }
+    item = items[tail];
+    tailIndex.store((tail + 1) % N, std::memory_order_release);
+    return true;
   }
+  
+  unsigned long dropped() const { return droppedCount; }
+  
+ private:
+  T items[N];
+  std::atomic<size_t> headIndex{0};
+  std::atomic<size_t> tailIndex{0};
+  unsigned long droppedCount = 0; // Only touched by the producer
+};
+
+// Logging - diagnostics are formatted into a ring of fixed slots and written
+// to the UART by the low-priority log task, so a full TX buffer stalls that
+// task instead of the control tick. LOG_LEVEL removes the levels above it at
+// compile time; logLevels[] filters per module at run time ("log" serial
+// command). The level check comes before the arguments are evaluated, so a
+// filtered line costs one compare. Replies to serial commands go through the
+// same ring as the console module, so they never split a log line and share
+// its rate limit; they are never filtered and print without a prefix.
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_RING_SLOTS 32          // Power of two, so the sequence numbers wrap cleanly
+#define LOG_LINE_SIZE 112
+#define LOG_RATE_LIMIT 20          // Lines per module per second; the rest are counted as dropped
+#define LOG_TASK_CORE 1
+#define LOG_TASK_PRIORITY 1        // Below the control task
+#define LOG_TASK_STACK 3072
+#define LOG_DRAIN_INTERVAL 20      // ms
+
+enum LogModule : uint8_t {
+  LOG_SYSTEM,
+  LOG_SENSOR,
+  LOG_CONTROL,
+  LOG_FEED,
+  LOG_WATER,
+  LOG_SCHEDULE,
+  LOG_CONFIG,
+  LOG_NETWORK,
+  LOG_DATABASE,
+  LOG_STORAGE,
+  LOG_CONSOLE,           // Serial command replies - always on, so it stays last
+  LOG_MODULE_COUNT
+};
+
+const char* const logModuleTags[LOG_MODULE_COUNT] = {
+  "sys", "sensor", "control", "feed", "water", "sched", "config", "net", "db", "store", "console"
+};
+const char logLevelLetters[] = "-EWID";
+
+// Written only by the serial command; a stale read costs at most one line
+uint8_t logLevels[LOG_MODULE_COUNT] = {
+  LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO,
+  LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO,
+  LOG_LEVEL_INFO
+};
+
+// Both tasks write log lines, so slots are claimed with a compare-and-swap
+// on logHead. A slot's sequence equals its position while free and position
+// + 1 once its text is complete; only then does the log task print it.
+struct LogSlot {
+  std::atomic<uint32_t> sequence;
+  uint32_t millis;
+  uint8_t level;
+  uint8_t module;
+  char text[LOG_LINE_SIZE];
+};
+LogSlot logRing[LOG_RING_SLOTS];
+std::atomic<uint32_t> logHead{0};
+uint32_t logTail = 0;                   // Only touched by the log task
+std::atomic<uint32_t> logDropped{0};    // Ring full or over the rate limit
+std::atomic<uint32_t> logRateSecond[LOG_MODULE_COUNT];
+std::atomic<uint16_t> logRateLines[LOG_MODULE_COUNT];
+TaskHandle_t logTaskHandle = NULL;
+
+#define LOG_AT(level, module, ...) \
+  do { if ((level) <= logLevels[module]) logWrite(level, module, __VA_ARGS__); } while (0)
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(module, ...) LOG_AT(LOG_LEVEL_ERROR, module, __VA_ARGS__)
+#else
+#define LOG_ERROR(module, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(module, ...) LOG_AT(LOG_LEVEL_WARN, module, __VA_ARGS__)
+#else
+#define LOG_WARN(module, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(module, ...) LOG_AT(LOG_LEVEL_INFO, module, __VA_ARGS__)
+#else
+#define LOG_INFO(module, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(module, ...) LOG_AT(LOG_LEVEL_DEBUG, module, __VA_ARGS__)
+#else
+#define LOG_DEBUG(module, ...) do {} while (0)
+#endif
+
+// Network -> control: a control, setting or schedule pushed by the dashboard
+enum InboundKind {
+  INBOUND_AUTOMATION,
+  INBOUND_FAN,
+  INBOUND_HEAT,
+  INBOUND_PUMP,
+  INBOUND_FEED,
+  INBOUND_FEED_DURATION,
+  INBOUND_FEED_GRAMS,
+  INBOUND_WATER_FILL,
+  INBOUND_CONTROLS_SYNCED,
+  INBOUND_AGE_GROUP,
+  INBOUND_CHICKEN_COUNT,
+  INBOUND_WATER_FLOW_RATE,
+  INBOUND_WATER_FILL_DURATION,
+  INBOUND_AUTO_WATER
+};
+
+struct InboundMessage {
+  uint8_t kind;
+  int32_t intValue;     // Booleans and counts
+  float floatValue;
+  char text[12];        // Age group
+};
+
+// Control -> network: a record to write to the database. Records are also
+// the on-flash format of the outbox, so keep the layout fixed-size.
+enum OutboundKind {
+  OUTBOUND_EVENT,
+  OUTBOUND_FEEDING_LOG,
+  OUTBOUND_WATER_LOG,
+  OUTBOUND_SET_BOOL,
+  OUTBOUND_HISTORY,       // One finished interval - stored into the history blocks, never uploaded as-is
+  OUTBOUND_HISTORY_HOUR,  // Upload the hour block starting at timestamp
+  OUTBOUND_HISTORY_DAY,   // Upload the daily block starting at timestamp
+  OUTBOUND_DELETE,        // Remove the node at key
+  OUTBOUND_DAILY_TOTALS   // One day's totals, written to the path in key
+};
+
+struct OutboundRecord {
+  uint8_t kind;
+  uint32_t timestamp;
+  char key[32];         // Event type, or the path for OUTBOUND_SET_BOOL and OUTBOUND_DELETE
+  char text[96];        // Event description, or the age group for feeding logs
+  int32_t values[9];    // Feeding: grams, chicken count. Water: ml, seconds. Bool: value.
+                        // History: one value per HistoryField. Event: see EventSlot
+                        // Daily totals: day, drunk, refilled, feed, feedings, refills, chickens
+};
+
+// Event record layout in OutboundRecord.values
+enum EventSlot {
+  EVENT_SLOT_SEQUENCE,     // Key sequence within the boot
+  EVENT_SLOT_OCCURRENCES,  // > 1 for a summary of repeats
+  EVENT_SLOT_CODE,
+  EVENT_SLOT_COUNT,        // How many values follow
+  EVENT_SLOT_VALUES
+};
+#define EVENT_MAX_VALUES (9 - EVENT_SLOT_VALUES)
+
+// Per-interval history values. Temperature and humidity are x10.
+enum HistoryField {
+  HISTORY_TEMP_MEAN,
+  HISTORY_TEMP_MIN,
+  HISTORY_TEMP_MAX,
+  HISTORY_HUMIDITY_MEAN,
+  HISTORY_HUMIDITY_MIN,
+  HISTORY_HUMIDITY_MAX,
+  HISTORY_FOOD,
+  HISTORY_WATER_MAIN,
+  HISTORY_WATER_DRINKER,
+  HISTORY_FIELDS
+};
+
+// Running aggregate of the current interval (control task)
+struct HistoryAccumulator {
+  uint32_t intervalStart;
+  uint16_t samples;
+  float temperatureSum, temperatureMin, temperatureMax;
+  float humiditySum, humidityMin, humidityMax;
+  long foodSum, waterMainSum, waterDrinkerSum;
+};
+
+// One hour (12 intervals) or one day (24 hours) of history, as stored on flash
+struct HistoryBlock {
+  uint32_t start;
+  uint32_t validMask;   // Bit N set when slot N holds data
+  int16_t slots[HISTORY_SLOTS_PER_DAY][HISTORY_FIELDS];
+};
+
+// Control -> network: everything updateFirebase() publishes
+struct TelemetrySnapshot {
+  float temperature;
+  float humidity;
+  int foodLevel;
+  int waterLevelMain;
+  int waterLevelDrinker;
+  bool fan;
+  bool heat;
+  bool pump;
+  bool highTemperature;
+  bool lowTemperature;
+  bool lowFood;
+  bool lowWaterMain;
+  bool lowWaterDrinker;
+  bool lowHydration;
+  bool isFeeding;
+  bool isWaterFilling;
+  unsigned long totalToday;
+  unsigned long perBird;
+  unsigned long drinkRate;
+};
+
+SpscQueue<InboundMessage, 32> inboundQueue;
+SpscQueue<OutboundRecord, 32> outboundQueue;
+
+// Control -> network: flash writes. An NVS commit can stall its caller for
+// milliseconds while a flash page is erased, so the control task queues
+// its writes and the network task makes them.
+#define NVS_WRITE_SIZE (DAILY_HISTORY_DAYS * sizeof(DayTotals))   // Largest value the control task saves
+
+enum NvsValueType : uint8_t {
+  NVS_BYTES,
+  NVS_UINT,
+  NVS_FLOAT
+};
+
+struct NvsWrite {
+  uint8_t type;
+  char key[16];          // NVS keys are at most 15 characters
+  uint16_t length;       // NVS_BYTES only
+  union {
+    uint32_t number;
+    float real;
+    uint8_t bytes[NVS_WRITE_SIZE];
+  } value;
+};
+
+SpscQueue<NvsWrite, 8> nvsQueue;
+
+// Event pipeline (network task) - every event is keyed by its second, the
+// boot number and a sequence number that runs for the whole boot, so no two
+// events share a key - not within a second, not across reboots. Codes with
+// a suppression window let one event through; repeats inside the window are
+// counted and folded into a single "N occurrences" event when the window
+// closes. Only identical transitions are repeats: a raise closes its
+// resolve's window (and the other way round), so raise -> resolve -> raise
+// always sends all three. Automation codes carry on/off in their first
+// value and are limited per state the same way.
+#define EVENT_LIMITER_SLOTS 16
+#define EVENT_STATE_ON 0x100          // Subject bit for an automation switching on
+#define EVENT_BOOT_MODULO 10000       // Boot number digits in the key
+#define EVENT_SEQUENCE_MODULO 1000000 // Sequence digits in the key
+
+struct EventPolicy {
+  uint8_t code;
+  uint16_t window;       // s
+  uint8_t opposite;      // Code of the reverse transition, itself for on/off codes, 0 = none
+};
+
+struct EventLimiter {
+  uint32_t subject;      // Event code (plus EVENT_STATE_ON), 0 = free
+  uint32_t windowStart;
+  uint16_t window;
+  uint16_t suppressed;   // Repeats since the window opened
+  OutboundRecord latest; // Newest repeat - becomes the summary
+};
+
+// Codes not listed are never limited
+constexpr EventPolicy eventPolicies[] = {
+  {EVENT_HIGH_TEMPERATURE, 300, EVENT_HIGH_TEMPERATURE_RESOLVED},
+  {EVENT_HIGH_TEMPERATURE_RESOLVED, 300, EVENT_HIGH_TEMPERATURE},
+  {EVENT_LOW_TEMPERATURE, 300, EVENT_LOW_TEMPERATURE_RESOLVED},
+  {EVENT_LOW_TEMPERATURE_RESOLVED, 300, EVENT_LOW_TEMPERATURE},
+  {EVENT_LOW_FOOD, 300, EVENT_LOW_FOOD_RESOLVED},
+  {EVENT_LOW_FOOD_RESOLVED, 300, EVENT_LOW_FOOD},
+  {EVENT_LOW_WATER_MAIN, 300, EVENT_LOW_WATER_MAIN_RESOLVED},
+  {EVENT_LOW_WATER_MAIN_RESOLVED, 300, EVENT_LOW_WATER_MAIN},
+  {EVENT_LOW_WATER_DRINKER, 300, EVENT_LOW_WATER_DRINKER_RESOLVED},
+  {EVENT_LOW_WATER_DRINKER_RESOLVED, 300, EVENT_LOW_WATER_DRINKER},
+  {EVENT_LOW_HYDRATION, 900, EVENT_HYDRATION_RESOLVED},
+  {EVENT_HYDRATION_RESOLVED, 300, EVENT_LOW_HYDRATION},
+  {EVENT_SENSOR_FAULT, 900, 0},
+  {EVENT_FAN_AUTO, 120, EVENT_FAN_AUTO},
+  {EVENT_HEAT_AUTO, 120, EVENT_HEAT_AUTO},
+  {EVENT_REFILL_AUTO, 120, 0},
+  {EVENT_PUMP_AUTO_OFF, 120, 0},
+};
+const int EVENT_POLICY_COUNT = sizeof(eventPolicies) / sizeof(eventPolicies[0]);
+
+EventLimiter eventLimiters[EVENT_LIMITER_SLOTS];
+uint32_t bootNumber = 0;               // Counted in NVS by setup()
+uint32_t eventSequence = 0;
+unsigned long eventsSuppressed = 0;
+SpscQueue<TelemetrySnapshot, 4> telemetryQueue;
+SpscQueue<DeviceConfig, 4> configQueue;
+SpscQueue<ScheduleUpdate, 4> scheduleQueue;
+SpscQueue<CalibrationUpdate, 2> calibrationQueue;
+
+// Store-and-forward outbox - records from the control task (and history
+// samples) are kept in a ring file on flash until the database has accepted
+// them, so Wi-Fi or token outages and reboots lose nothing. When the ring is
+// full the oldest record is evicted.
+#define OUTBOX_FILE "/outbox.bin"
+#define OUTBOX_MAGIC 0x504F5842UL     // "POXB"
+#define OUTBOX_CAPACITY 256           // Records kept on flash
+#define OUTBOX_BATCH_SIZE 10          // Records per upload
+#define OUTBOX_BATCH_FRAME_SIZE 2560
+#define OUTBOX_RETRY_DELAY 5000       // Wait after a failed upload (ms)
+#define OUTBOX_WRITE_PATHS 8          // Flag paths tracked for coalescing
+
+struct OutboxHeader {
+  uint32_t magic;
+  uint16_t recordSize;   // Layout check - a firmware change to OutboundRecord discards the file
+  uint16_t capacity;
+  uint16_t head;         // Next slot to write
+  uint16_t count;        // Records waiting
+  uint32_t evicted;      // Records dropped because the ring was full
+};
+
+OutboxHeader outboxHeader;
+File outboxFile;
+bool outboxReady = false;
+unsigned long outboxRetryTime = 0;
+int pendingHourMarkerSlot = -1;  // Outbox slot of the last queued block markers
+int pendingDayMarkerSlot = -1;
+
+// Last queued flag write per path - a newer write to the same path
+// overwrites the pending record instead of adding one
+struct PendingWrite {
+  char key[32];
+  int slot;
+};
+PendingWrite pendingWrites[OUTBOX_WRITE_PATHS];
+unsigned long outboxCoalesced = 0;
+OutboundRecord outboxBatch[OUTBOX_BATCH_SIZE];
+char outboxBuffer[OUTBOX_BATCH_FRAME_SIZE];
+PatchFrame outboxFrame = {outboxBuffer, OUTBOX_BATCH_FRAME_SIZE, 0, false};
+
+// Records made before the clock was set, waiting in RAM (network task)
+#define CLOCK_HOLD_RECORDS 16
+OutboundRecord clockHeldRecords[CLOCK_HOLD_RECORDS];
+uint8_t clockHeldCount = 0;
+unsigned long clockHeldDropped = 0;
+
+HistoryAccumulator historyAccumulator = {};
+HistoryBlock historyBlock;        // Scratch block for the network task
+bool historyStoreReady = false;
+
+// Network task's copy of the most recent snapshot
+TelemetrySnapshot latestTelemetry;
+bool latestTelemetryValid = false;
+bool latestTelemetryPublished = true;
+
+// Hardware abstraction - pins, sensors, actuators, the clock, serial, tasks,
+// Wi-Fi, Firebase and database requests all go through the hal*/rtdb*
+// functions below. With POULTRY_SIMULATION defined they run against simBarn
+// and the host stand-ins in sim/host_platform.h instead, so the harness in
+// sim/ can drive setup() and the task loops and inspect every request.
+unsigned long halMillis() {
+#ifdef POULTRY_SIMULATION
+  return simMillis();
+#else
+  return millis();
+#endif
 }
 
-// Function to log water data for analytics
-void logWaterData(int volumeDispensed, int durationSeconds) {
-  if (Firebase.ready() && signupOK) {
-    FirebaseJson json;
-    json.set("timestamp", time(NULL));
-    json.set("volumeDispensed", volumeDispensed);
-    json.set("durationSeconds", durationSeconds);
-    
-    String path = "/waterLogs/" + String(time(NULL));  
-    if (Firebase.RTDB.setJSON(&fbdo, path.c_str(), &json)) {
-      Serial.println("Water data logged successfully");
-      
-      // Update total water dispensed today
-      totalWaterToday += volumeDispensed;
-      
-      // Update water per bird
-      if (chickenCount > 0) {
-        waterPerBird = totalWaterToday / chickenCount;
-      }
-      
-      // Check hydration status and update alert if needed
-      checkHydrationStatus();
-    } else {
-      Serial.println("Failed to log water data: " + fbdo.errorReason());
-    }
-  }
+unsigned long halMicros() {
+#ifdef POULTRY_SIMULATION
+  return simMicros();
+#else
+  return micros();
+#endif
 }
 
-// Function to check hydration status
-void checkHydrationStatus() {
-  // Only check if we have birds
-  if (chickenCount <= 0) return;
-  
-  // Calculate water per bird
-  int waterPerBirdToday = totalWaterToday / chickenCount;
-  
-  // Check against thresholds
-  bool isLowHydration = waterPerBirdToday < HYDRATION_ALERT_THRESHOLD;
-  
-  // Update Firebase alert if status changed
-  if (isLowHydration != lowHydrationAlertActive) {
-    lowHydrationAlertActive = isLowHydration;
-    Firebase.RTDB.setBool(&fbdo, "/alerts/lowHydration", lowHydrationAlertActive);
-    
-    if (lowHydrationAlertActive) {
-      logEvent("lowHydration", "Low hydration detected: " + String(waterPerBirdToday) + "ml per bird (threshold: " + String(HYDRATION_ALERT_THRESHOLD) + "ml)");
-    } else {
-      logEvent("resolved", "Hydration level returned to normal: " + String(waterPerBirdToday) + "ml per bird");
-    }
-  }
+time_t halEpoch() {
+#ifdef POULTRY_SIMULATION
+  return simBarn.virtualEpoch + halMillis() / 1000;
+#else
+  return time(NULL);
+#endif
 }
 
-// Reset daily water counters at midnight
-void resetDailyWaterCounters() {
-  time_t now;
-  struct tm timeinfo;
-  time(&now);
-  localtime_r(&now, &timeinfo);
-  
-  // Check if it's a new day (midnight)
-  if (timeinfo.tm_hour == 0 && timeinfo.tm_min == 0 && timeinfo.tm_sec < 10) {
-    // Reset counters
-    totalWaterToday = 0;
-    waterPerBird = 0;
-    dayStartTime = now;
-    
-    // Log the reset
-    Serial.println("Daily water counters reset at midnight");
+void halBeginSerial() {
+#ifndef POULTRY_SIMULATION
+  Serial.begin(115200);
+#endif
+}
+
+void halSerialWrite(const char* text, size_t length) {
+#ifdef POULTRY_SIMULATION
+  simSerialWrite(text, length);
+#else
+  Serial.write((const uint8_t*)text, length);
+#endif
+}
+
+// printf to the serial console; longer lines are cut at the buffer size
+void halSerialPrintf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void halSerialPrintf(const char* format, ...) {
+  char text[128];
+  va_list arguments;
+  va_start(arguments, format);
+  int length = vsnprintf(text, sizeof(text), format, arguments);
+  va_end(arguments);
+  if (length > 0) halSerialWrite(text, min((size_t)length, sizeof(text) - 1));
+}
+
+// Next character typed on the console, if any
+bool halSerialRead(char& c) {
+#ifdef POULTRY_SIMULATION
+  return simSerialRead(c);
+#else
+  if (Serial.available() <= 0) return false;
+  c = (char)Serial.read();
+  return true;
+#endif
+}
+
+void halHeapStats(uint32_t& freeHeap, uint32_t& minFreeHeap, uint32_t& largestBlock) {
+#ifdef POULTRY_SIMULATION
+  SimHeapStats stats;
+  simHeapStats(stats);
+  freeHeap = stats.freeBytes;
+  minFreeHeap = stats.minFreeBytes;
+  largestBlock = stats.largestBlock;
+#else
+  freeHeap = ESP.getFreeHeap();
+  minFreeHeap = ESP.getMinFreeHeap();
+  largestBlock = ESP.getMaxAllocHeap();
+#endif
+}
+
+// Start a task pinned to core; on a host it becomes a std::thread once the
+// harness enables threads, otherwise the harness calls the loops itself
+void halStartTask(void (*task)(void*), const char* name, uint32_t stack, uint8_t priority,
+                  TaskHandle_t* handle, uint8_t core) {
+#ifdef POULTRY_SIMULATION
+  simStartTask(task, name, handle);
+#else
+  xTaskCreatePinnedToCore(task, name, stack, NULL, priority, handle, core);
+#endif
+}
+
+void halBeginWifi() {
+#ifndef POULTRY_SIMULATION
+  WiFi.mode(WIFI_STA);
+  WiFi.disconnect();
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+#endif
+}
+
+bool halWifiConnected() {
+#ifdef POULTRY_SIMULATION
+  return true;
+#else
+  return WiFi.status() == WL_CONNECTED;
+#endif
+}
+
+void halLocalIp(char* text, size_t size) {
+#ifdef POULTRY_SIMULATION
+  copyField(text, size, "127.0.0.1");
+#else
+  copyField(text, size, WiFi.localIP().toString().c_str());
+#endif
+}
+
+// Start SNTP; it keeps the clock set in the background
+void halBeginClock() {
+#ifndef POULTRY_SIMULATION
+  configTime(GMT_OFFSET_SECONDS, 0, "pool.ntp.org", "time.nist.gov");
+#endif
+}
+
+// Anonymous sign-in; on failure error says why
+bool halCloudSignUp(char* error, size_t size) {
+#ifdef POULTRY_SIMULATION
+  if (!simRtdb.online) copyField(error, size, "offline");
+  return simRtdb.online;
+#else
+  config.api_key = API_KEY;
+  config.database_url = DATABASE_URL;
+  if (Firebase.signUp(&config, &auth, "", "")) return true;
+  copyField(error, size, config.signer.signupError.message.c_str());
+  return false;
+#endif
+}
+
+void halCloudBegin() {
+#ifndef POULTRY_SIMULATION
+  config.token_status_callback = tokenStatusCallback; // Set token callback
+  Firebase.begin(&config, &auth);
+  Firebase.reconnectWiFi(true);
+#endif
+}
+
+// Signed in with a valid token. On the ESP32 this also refreshes the token,
+// so it is called every network pass.
+bool halCloudReady() {
+#ifdef POULTRY_SIMULATION
+  return signupOK;
+#else
+  return Firebase.ready();
+#endif
+}
+
+void halWriteRelay(uint8_t pin, bool on) {
+#ifdef POULTRY_SIMULATION
+  int relay = pin == RELAY_FAN ? 0 : pin == RELAY_HEAT ? 1 : pin == RELAY_PUMP ? 2 : 3;
+  simBarn.relayOn[relay] = on;
+  simBarn.relayWrites[relay]++;
+#else
+  digitalWrite(pin, on ? LOW : HIGH); // Relays are active LOW
+#endif
+}
+
+void halWriteServo(int angle) {
+#ifdef POULTRY_SIMULATION
+  // Feed leaves the hopper for as long as the feeder is open
+  if (angle != simBarn.servoAngle) {
+    if (angle == deviceConfig.servoOpenAngle) {
+      simBarn.servoOpenedAt = halMillis();
+    } else if (simBarn.servoAngle == deviceConfig.servoOpenAngle) {
+      float grams = (halMillis() - simBarn.servoOpenedAt) / 1000.0f * simBarn.feedFlowRate;
+      simBarn.feedDispensedGrams += grams;
+      simBarn.foodDistanceCm += grams / simBarn.hopperGramsPerCm;
+    }
   }
+  simBarn.servoAngle = angle;
+#else
+  feederServo.write(angle);
+#endif
 }
 
-void setup() {
-  Serial.begin(115200);
-  
-  // Initialize pins
+// Pin modes, echo interrupt, continuous ADC, relays off, feeder closed
+void halBeginHardware() {
+#ifndef POULTRY_SIMULATION
   pinMode(RELAY_FAN, OUTPUT);
   pinMode(RELAY_HEAT, OUTPUT);
   pinMode(RELAY_PUMP, OUTPUT);
   pinMode(RELAY_SPARE, OUTPUT);
   pinMode(WATER_LEVEL_MAIN, INPUT);
   pinMode(WATER_LEVEL_DRINKER, INPUT);
-  
-  // Initialize with everything off
-  digitalWrite(RELAY_FAN, HIGH);    // Relays are active LOW
-  digitalWrite(RELAY_HEAT, HIGH);
-  digitalWrite(RELAY_PUMP, HIGH);
-  digitalWrite(RELAY_SPARE, HIGH);
-  
-  // Initialize servo
+  pinMode(ULTRASONIC_TRIG, OUTPUT);
+  pinMode(ULTRASONIC_ECHO, INPUT);
+  pinMode(DHT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(ULTRASONIC_ECHO), echoIsr, CHANGE);
   feederServo.attach(SERVO_PIN);
-  feederServo.write(SERVO_CLOSE_ANGLE); // Ensure servo starts in closed position
-  
-  // Initialize DHT sensor
-  dht.begin();
+#endif
+  halBeginAdc();
   
-  // Connect to WiFi
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  Serial.print("Connecting to WiFi");
-  while (WiFi.status() != WL_CONNECTED) {
-    Serial.print(".");
-    delay(500);
+  // Initialize with everything off
+  halWriteRelay(RELAY_FAN, false);
+  halWriteRelay(RELAY_HEAT, false);
+  halWriteRelay(RELAY_PUMP, false);
+  halWriteRelay(RELAY_SPARE, false);
+  halWriteServo(deviceConfig.servoCloseAngle); // Ensure servo starts in closed position
+}
+
+// DHT falling edge - the spacing of consecutive edges encodes each bit
+void IRAM_ATTR dhtEdgeIsr() {
+#ifndef POULTRY_SIMULATION
+  if (dhtEdgeCount < DHT_EDGES) {
+    dhtEdgeTimes[dhtEdgeCount++] = micros();
   }
-  Serial.println();
-  Serial.print("Connected with IP: ");
-  Serial.println(WiFi.localIP());
-  
-  // Initialize time
-  configTime(8 * 3600, 0, "pool.ntp.org", "time.nist.gov");
-  
-  // Initialize Firebase
-  config.api_key = API_KEY;
-  config.database_url = DATABASE_URL;
+#endif
+}
 
-  // Anonymous sign-in
-  if (Firebase.signUp(&config, &auth, "", "")) {
-    Serial.println("✅ Firebase SignUp OK");
-    signupOK = true;
+// Ultrasonic echo - the pulse width is the round-trip time
+void IRAM_ATTR echoIsr() {
+#ifndef POULTRY_SIMULATION
+  if (digitalRead(ULTRASONIC_ECHO)) {
+    echoRiseMicros = micros();
   } else {
-    Serial.printf("❌ Firebase SignUp Failed: %s\n", config.signer.signupError.message.c_str());
+    echoFallMicros = micros();
+    echoDone = true;
   }
+#endif
+}
 
-  config.token_status_callback = tokenStatusCallback; // Set token callback
-  
-  Firebase.begin(&config, &auth);
-  Firebase.reconnectWiFi(true);
-  
-  Serial.println("System initialized");
-  
-  // Initialize day start time
-  time_t now;
-  time(&now);
-  struct tm timeinfo;
-  localtime_r(&now, &timeinfo);
-  
-  // Set day start time to the beginning of the current day
-  timeinfo.tm_hour = 0;
-  timeinfo.tm_min = 0;
-  timeinfo.tm_sec = 0;
-  dayStartTime = mktime(&timeinfo);
+// Busy-wait - only for pulses too short to time with control passes
+void halDelayMicros(unsigned long us) {
+#ifndef POULTRY_SIMULATION
+  delayMicroseconds(us);
+#endif
+}
+
+// Begin the DHT start signal: hold the data line low
+void halDhtStart() {
+#ifndef POULTRY_SIMULATION
+  pinMode(DHT_PIN, OUTPUT);
+  digitalWrite(DHT_PIN, LOW);
+#endif
+}
+
+// End the start signal and time the sensor's reply
+void halDhtRelease() {
+  dhtEdgeCount = 0;
+#ifndef POULTRY_SIMULATION
+  pinMode(DHT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(DHT_PIN), dhtEdgeIsr, FALLING);
+#endif
+}
+
+// Decode the captured frame. Returns false on a short frame or bad checksum.
+bool halDhtCollect(float& temperatureSample, float& humiditySample) {
+#ifdef POULTRY_SIMULATION
+  temperatureSample = simBarn.temperature;
+  humiditySample = simBarn.humidity;
+  return !isnan(simBarn.temperature) && !isnan(simBarn.humidity);
+#else
+  detachInterrupt(digitalPinToInterrupt(DHT_PIN));
+  if (dhtEdgeCount < DHT_EDGES) return false;
   
-  // Check if automation is enabled from Firebase
-  if (Firebase.ready() && signupOK) {
-    if (Firebase.RTDB.getBool(&fbdo, "/controls/automationEnabled")) {
-      automationEnabled = fbdo.boolData();
-    }
-    
-    // Reset feed control on startup to prevent accidental feeding
-    Firebase.RTDB.setBool(&fbdo, "/controls/feed", false);
-    
-    // Reset water fill control on startup
-    Firebase.RTDB.setBool(&fbdo, "/controls/waterFill", false);
-    
-    // Reset isFeeding state
-    Firebase.RTDB.setBool(&fbdo, "/deviceStates/isFeeding", false);
-    
-    // Reset isWaterFilling state
-    Firebase.RTDB.setBool(&fbdo, "/deviceStates/isWaterFilling", false);
-    
-    // Initialize water settings
-    if (Firebase.RTDB.getInt(&fbdo, "/waterSettings/flowRate")) {
-      waterFlowRate = fbdo.intData();
-    } else {
-      // Set default water flow rate
-      Firebase.RTDB.setInt(&fbdo, "/waterSettings/flowRate", waterFlowRate);
-    }
-    
-    if (Firebase.RTDB.getInt(&fbdo, "/waterSettings/fillDuration")) {
-      waterFillDuration = fbdo.intData();
-    } else {
-      // Set default water fill duration
-      Firebase.RTDB.setInt(&fbdo, "/waterSettings/fillDuration", waterFillDuration);
-    }
-    
-    if (Firebase.RTDB.getBool(&fbdo, "/waterSettings/autoEnabled")) {
-      autoWaterEnabled = fbdo.boolData();
-    } else {
-      // Set default auto water enabled
-      Firebase.RTDB.setBool(&fbdo, "/waterSettings/autoEnabled", autoWaterEnabled);
-    }
+  // Edge 0 is the sensor's response; bit N runs from edge N+1 to edge N+2
+  uint8_t data[5] = {0};
+  for (int bit = 0; bit < 40; bit++) {
+    uint32_t width = dhtEdgeTimes[bit + 2] - dhtEdgeTimes[bit + 1];
+    data[bit / 8] = (data[bit / 8] << 1) | (width > DHT_BIT_THRESHOLD ? 1 : 0);
   }
+  if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) return false;
   
-  // Initialize lastFeedingHour to current hour to prevent immediate feeding on boot
-  time_t now2;
-  struct tm timeinfo2;
-  time(&now2);
-  localtime_r(&now2, &timeinfo2);
-  lastFeedingHour = timeinfo2.tm_hour;
-  lastWaterFillHour = timeinfo2.tm_hour;
-  
-  Serial.print("System initialized. Last feeding hour set to: ");
-  Serial.println(lastFeedingHour);
-  
-  // Log system startup
-  logEvent("system", "Smart Poultry System started");
+  if (DHT_TYPE == 11) {
+    humiditySample = data[0] + data[1] * 0.1;
+    temperatureSample = data[2] + (data[3] & 0x7F) * 0.1;
+    if (data[3] & 0x80) temperatureSample = -temperatureSample;
+  } else {
+    humiditySample = ((data[0] << 8) | data[1]) * 0.1;
+    temperatureSample = (((data[2] & 0x7F) << 8) | data[3]) * 0.1;
+    if (data[2] & 0x80) temperatureSample = -temperatureSample;
+  }
+  return true;
+#endif
 }
 
-void readSensors() {
-  // Read DHT22 sensor
-  temperature = dht.readTemperature();
-  humidity = dht.readHumidity();
+// Send the 10 us trigger pulse; echoIsr() times the reply
+void halSonarTrigger() {
+  echoDone = false;
+#ifndef POULTRY_SIMULATION
+  digitalWrite(ULTRASONIC_TRIG, LOW);
+  delayMicroseconds(2);
+  digitalWrite(ULTRASONIC_TRIG, HIGH);
+  delayMicroseconds(10);
+  digitalWrite(ULTRASONIC_TRIG, LOW);
+#endif
+}
+
+// Distance of a finished echo in cm, or false while it is still in flight
+bool halSonarResult(float& distanceCm) {
+#ifdef POULTRY_SIMULATION
+  distanceCm = simBarn.foodDistanceCm;
+  return true;
+#else
+  if (!echoDone) return false;
+  distanceCm = (echoFallMicros - echoRiseMicros) / 58.0f; // ~58 us per cm there and back
+  return true;
+#endif
+}
+
+// Count one database request into rtdbStats
+bool recordRtdbRequest(uint8_t kind, const char* path, unsigned long startMillis, bool ok) {
+  unsigned long latency = halMillis() - startMillis;
+  rtdbStats.requests++;
+  if (!ok) rtdbStats.failures++;
+  linkRecordResult(ok, halMillis());
+  rtdbStats.lastLatency = latency;
+  if (latency > rtdbStats.maxLatency) rtdbStats.maxLatency = latency;
+#if PERF_PROFILING
+  perfRecord(PERF_RTDB_REQUEST, latency * 1000);
+#endif
+  return ok;
+}
+
+// May a request go out now? While the link is down only the probe may
+bool linkAllowsRequest() {
+  if (linkHealth.up) return true;
+  if ((long)(halMillis() - linkHealth.probeTime) >= 0) return true;
+  linkHealth.shortCircuited++;
+  return false;
+}
+
+// Fold one request result into the link state
+void linkRecordResult(bool ok, unsigned long now) {
+  if (ok) {
+    if (!linkHealth.up) {
+      LOG_INFO(LOG_DATABASE, "Link restored after %lu ms (%lu requests skipped)",
+               now - linkHealth.downSince, linkHealth.shortCircuited);
+    }
+    linkHealth.up = true;
+    linkHealth.consecutiveFailures = 0;
+    linkHealth.backoff = LINK_BACKOFF_MIN;
+    return;
+  }
   
-  // Check if readings are valid
-  if (isnan(temperature) || isnan(humidity)) {
-    Serial.println("Failed to read from DHT sensor!");
-    temperature = 0;
-    humidity = 0;
+  if (linkHealth.consecutiveFailures < 255) linkHealth.consecutiveFailures++;
+  if (linkHealth.up) {
+    if (linkHealth.consecutiveFailures < LINK_FAILURE_LIMIT) return;
+    linkHealth.up = false;
+    linkHealth.downSince = now;
+    linkHealth.outages++;
+    linkHealth.shortCircuited = 0;
+    LOG_WARN(LOG_DATABASE, "Link down - requests suspended");
   }
   
-  // Read ultrasonic sensor for food level
-  int distance = sonar.ping_cm();
-  if (distance == 0) distance = MAX_DISTANCE; // Handle out of range
+  // Schedule the next probe somewhere in backoff +/- jitter, then double the delay
+  unsigned long jitter = linkHealth.backoff * LINK_JITTER_PERCENT / 100;
+  linkHealth.probeTime = now + linkHealth.backoff - jitter + random(2 * jitter + 1);
+  linkHealth.backoff = min(linkHealth.backoff * 2, (unsigned long)LINK_BACKOFF_MAX);
+}
+
+// Set up the request session before first use. A fallback GET may return a
+// whole settings node. The TLS record buffers are fixed by the ESP32's
+// mbedTLS build configuration, so only the response limit is set here.
+void halBeginRtdbSession() {
+#ifndef POULTRY_SIMULATION
+  rtdbSession.setResponseSize(4096);
+  rtdbSession.keepAlive(5, 5, 1);   // TCP keep-alive: idle 5 s, interval 5 s, 1 probe
+#endif
+}
+
+// Build the response for a request that went out (or was refused)
+RtdbResponse rtdbResponse(bool ok, bool skipped, unsigned long startMillis) {
+  RtdbResponse response;
+  response.ok = ok;
+  response.skipped = skipped;
+#ifdef POULTRY_SIMULATION
+  response.httpCode = ok ? 200 : 0;
+#else
+  response.httpCode = skipped ? 0 : rtdbSession.httpCode();
+#endif
+  response.latency = skipped ? 0 : halMillis() - startMillis;
+#ifdef POULTRY_SIMULATION
+  response.payload = ok ? simRtdb.payload() : "null";
+#else
+  response.payload = ok ? rtdbSession.to<const char *>() : "null";
+#endif
+  return response;
+}
+
+void printRtdbError(const char* what, const RtdbResponse& response) {
+#ifdef POULTRY_SIMULATION
+  LOG_WARN(LOG_DATABASE, "%s: %s", what, response.skipped ? "link down" : "offline");
+#else
+  LOG_WARN(LOG_DATABASE, "%s: %s", what, response.skipped ? "link down" : rtdbSession.errorReason().c_str());
+#endif
+}
+
+// Multi-path PATCH of a JSON object body; the server answers 204 without
+// echoing the payload back
+RtdbResponse rtdbPatch(const char* path, const char* body) {
+  if (!linkAllowsRequest()) return rtdbResponse(false, true, 0);
+  unsigned long start = halMillis();
+  bool ok = false;
+#ifdef POULTRY_SIMULATION
+  ok = simRtdb.patch(RTDB_PATCH, path, body);
+#else
+  // The library only takes an update as FirebaseJson, which parses the body
+  // onto the heap; this is the one allocation left per PATCH, freed by clear()
+  patchJson.clear();
+  patchJson.setJsonData(body);
+  ok = Firebase.RTDB.updateNodeSilent(&rtdbSession, path, &patchJson);
+#endif
+  ok = recordRtdbRequest(RTDB_PATCH, path, start, ok);
+  return rtdbResponse(ok, false, start);
+}
+
+// GET a node as JSON; response.payload stays valid until the next request
+RtdbResponse rtdbGetJson(const char* path) {
+  if (!linkAllowsRequest()) return rtdbResponse(false, true, 0);
+  unsigned long start = halMillis();
+  bool ok = false;
+#ifdef POULTRY_SIMULATION
+  ok = simRtdb.get(RTDB_GET, path);
+#else
+  ok = Firebase.RTDB.getJSON(&rtdbSession, path);
+#endif
+  ok = recordRtdbRequest(RTDB_GET, path, start, ok);
+  return rtdbResponse(ok, false, start);
+}
+
+// Open the control stream on path; on failure streamErrorText says why
+bool rtdbBeginStream(const char* path) {
+  if (!linkAllowsRequest()) {
+    copyField(streamErrorText, sizeof(streamErrorText), "link down");
+    return false;
+  }
+  unsigned long start = halMillis();
+  bool ok = false;
+#ifdef POULTRY_SIMULATION
+  ok = simRtdb.beginStream(RTDB_STREAM_BEGIN, path);
+  if (!ok) copyField(streamErrorText, sizeof(streamErrorText), "offline");
+#else
+  ok = Firebase.RTDB.beginStream(&controlStream, path);
+  if (!ok) copyField(streamErrorText, sizeof(streamErrorText), controlStream.errorReason().c_str());
+#endif
+  return recordRtdbRequest(RTDB_STREAM_BEGIN, path, start, ok);
+}
+
+// Not counted - it runs every pass and usually only checks the open socket.
+// Skipped while the link is down so the library does not keep reconnecting.
+// False on a stream error or timeout; event.available is set when an event
+// arrived on this pass.
+bool rtdbReadStream(StreamEvent& event) {
+  event.available = false;
+  if (!linkHealth.up) return false;
+#ifdef POULTRY_SIMULATION
+  if (simRtdb.readStream(event.available, event.patch, event.path, sizeof(event.path), event.data)) return true;
+  copyField(streamErrorText, sizeof(streamErrorText), "offline");
+  return false;
+#else
+  if (!Firebase.RTDB.readStream(&controlStream)) {
+    copyField(streamErrorText, sizeof(streamErrorText), controlStream.errorReason().c_str());
+    return false;
+  }
+  if (controlStream.streamTimeout()) {
+    copyField(streamErrorText, sizeof(streamErrorText), "timeout");
+    return false;
+  }
+  if (!controlStream.streamAvailable()) return true;
+  
+  event.available = true;
+  event.patch = strcmp(controlStream.eventType().c_str(), "patch") == 0;
+  copyField(event.path, sizeof(event.path), controlStream.dataPath().c_str());
+  event.data = controlStream.to<const char *>();
+  return true;
+#endif
+}
+
+// Copy a string into a fixed-size record field
+void copyField(char* destination, size_t size, const char* source) {
+  strncpy(destination, source, size - 1);
+  destination[size - 1] = '\0';
+}
+
+// Hand a flash write to the network task
+void queueNvsWrite(NvsWrite& write, const char* key) {
+  copyField(write.key, sizeof(write.key), key);
+  if (!nvsQueue.push(write)) {
+    LOG_WARN(LOG_STORAGE, "NVS queue full - %s not saved", key);
+  }
+}
+
+void queueNvsBytes(const char* key, const void* data, size_t length) {
+  NvsWrite write;
+  write.type = NVS_BYTES;
+  write.length = min(length, sizeof(write.value.bytes));
+  memcpy(write.value.bytes, data, write.length);
+  queueNvsWrite(write, key);
+}
+
+void queueNvsUInt(const char* key, uint32_t value) {
+  NvsWrite write;
+  write.type = NVS_UINT;
+  write.value.number = value;
+  queueNvsWrite(write, key);
+}
+
+void queueNvsFloat(const char* key, float value) {
+  NvsWrite write;
+  write.type = NVS_FLOAT;
+  write.value.real = value;
+  queueNvsWrite(write, key);
+}
+
+// Make the flash writes queued by the control task - runs on the network task
+void writeQueuedNvs() {
+  NvsWrite write;
+  while (nvsQueue.pop(write)) {
+    if (write.type == NVS_BYTES) {
+      preferences.putBytes(write.key, write.value.bytes, write.length);
+    } else if (write.type == NVS_UINT) {
+      preferences.putUInt(write.key, write.value.number);
+    } else {
+      preferences.putFloat(write.key, write.value.real);
+    }
+  }
+}
+
+// Queue a record for the network task
+void queueOutbound(OutboundRecord& record) {
+  if (record.timestamp == 0) {
+    record.timestamp = (uint32_t)halEpoch();
+  }
+  if (!outboundQueue.push(record)) {
+    LOG_WARN(LOG_CONTROL, "Outbound queue full - record dropped");
+  }
+}
+
+// Function to log events to Firebase (queued for the network task) - an
+// EventCode and up to EVENT_MAX_VALUES numbers, see the code for their meaning
+void logEvent(uint8_t code, std::initializer_list<int32_t> values) {
+  OutboundRecord record = {};
+  record.kind = OUTBOUND_EVENT;
+  record.values[EVENT_SLOT_CODE] = code;
+  
+  int count = 0;
+  for (int32_t value : values) {
+    if (count == EVENT_MAX_VALUES) break;
+    record.values[EVENT_SLOT_VALUES + count++] = value;
+  }
+  record.values[EVENT_SLOT_COUNT] = count;
+  
+  queueOutbound(record);
+}
+
+// Readings in events and alert rules are sent as tenths
+int32_t tenths(float value) {
+  return lroundf(value * 10);
+}
+
+// Function to log feeding data for analytics (queued for the network task)
+void logFeedingData(int gramsDispensed, const char* ageGroup, int count) {
+  OutboundRecord record = {};
+  record.kind = OUTBOUND_FEEDING_LOG;
+  copyField(record.text, sizeof(record.text), ageGroup);
+  record.values[0] = gramsDispensed;
+  record.values[1] = count;
+  queueOutbound(record);
+}
+
+// Function to log water data for analytics (queued for the network task)
+void logWaterData(int volumeDispensed, int durationSeconds) {
+  OutboundRecord record = {};
+  record.kind = OUTBOUND_WATER_LOG;
+  record.values[0] = volumeDispensed;
+  record.values[1] = durationSeconds;
+  queueOutbound(record);
+}
+
+// Queue a single boolean write (control flag resets, device state changes)
+void queueBoolWrite(const char* path, bool value) {
+  OutboundRecord record = {};
+  record.kind = OUTBOUND_SET_BOOL;
+  copyField(record.key, sizeof(record.key), path);
+  record.values[0] = value ? 1 : 0;
+  queueOutbound(record);
+}
+
+// Queue one day's totals for /dailyTotals/<YYYYMMDD>
+void queueDailyTotals(const DayTotals& totals) {
+  if (totals.day == 0) return;
+  OutboundRecord record = {};
+  record.kind = OUTBOUND_DAILY_TOTALS;
+  snprintf(record.key, sizeof(record.key), "dailyTotals/%lu", (unsigned long)totals.day);
+  record.values[0] = totals.day;
+  record.values[1] = totals.waterDrunk;
+  record.values[2] = totals.waterRefilled;
+  record.values[3] = totals.feedGrams;
+  record.values[4] = totals.feedings;
+  record.values[5] = totals.refills;
+  record.values[6] = chickenCount;
+  queueOutbound(record);
+}
+
+// Copy a string into a JSON string literal (quotes included), escaping as needed
+void formatJsonString(char* destination, size_t size, const char* source) {
+  size_t length = 0;
+  if (size < 3) {
+    if (size > 0) destination[0] = '\0';
+    return;
+  }
+  destination[length++] = '"';
+  for (; *source != '\0' && length < size - 3; source++) {
+    char c = *source;
+    if (c == '"' || c == '\\') {
+      if (length >= size - 4) break;
+      destination[length++] = '\\';
+      destination[length++] = c;
+    } else if ((unsigned char)c < 0x20) {
+      destination[length++] = ' ';
+    } else {
+      destination[length++] = c;
+    }
+  }
+  destination[length++] = '"';
+  destination[length] = '\0';
+}
+
+// Database path and JSON value for one record. Returns false for unknown records.
+bool formatOutboundRecord(const OutboundRecord& record, char* path, size_t pathSize, char* value, size_t valueSize) {
+  char text[2 * sizeof(record.text) + 2];
+  
+  switch (record.kind) {
+    case OUTBOUND_EVENT: {
+      // Fixed-width keys, so key order is time order
+      snprintf(path, pathSize, "events/%lu-%04lu-%06ld", (unsigned long)record.timestamp,
+               (unsigned long)(bootNumber % EVENT_BOOT_MODULO), (long)record.values[EVENT_SLOT_SEQUENCE]);
+      size_t length = snprintf(value, valueSize, "{\"timestamp\":%lu,\"code\":%ld,\"v\":[",
+                               (unsigned long)record.timestamp, (long)record.values[EVENT_SLOT_CODE]);
+      int count = constrain(record.values[EVENT_SLOT_COUNT], 0, EVENT_MAX_VALUES);
+      for (int i = 0; i < count && length < valueSize; i++) {
+        length += snprintf(value + length, valueSize - length, i ? ",%ld" : "%ld", (long)record.values[EVENT_SLOT_VALUES + i]);
+      }
+      if (length < valueSize) {
+        if (record.values[EVENT_SLOT_OCCURRENCES] > 1) {
+          snprintf(value + length, valueSize - length, "],\"count\":%ld,\"window\":%u}",
+                   (long)record.values[EVENT_SLOT_OCCURRENCES], eventWindow(record.values[EVENT_SLOT_CODE]) / 60);
+        } else {
+          snprintf(value + length, valueSize - length, "]}");
+        }
+      }
+      return true;
+    }
+      
+    case OUTBOUND_FEEDING_LOG:
+      formatJsonString(text, sizeof(text), record.text);
+      snprintf(path, pathSize, "feedingLogs/%lu", (unsigned long)record.timestamp);
+      snprintf(value, valueSize, "{\"timestamp\":%lu,\"gramsDispensed\":%ld,\"ageGroup\":%s,\"chickenCount\":%ld}",
+               (unsigned long)record.timestamp, (long)record.values[0], text, (long)record.values[1]);
+      return true;
+      
+    case OUTBOUND_WATER_LOG:
+      snprintf(path, pathSize, "waterLogs/%lu", (unsigned long)record.timestamp);
+      snprintf(value, valueSize, "{\"timestamp\":%lu,\"volumeDispensed\":%ld,\"durationSeconds\":%ld}",
+               (unsigned long)record.timestamp, (long)record.values[0], (long)record.values[1]);
+      return true;
+      
+    case OUTBOUND_SET_BOOL:
+      // Stored as "/device/controls/feed" - frame keys have no leading slash
+      snprintf(path, pathSize, "%s", record.key[0] == '/' ? record.key + 1 : record.key);
+      snprintf(value, valueSize, "%s", record.values[0] ? "true" : "false");
+      return true;
+      
+    case OUTBOUND_HISTORY_HOUR:
+    case OUTBOUND_HISTORY_DAY: {
+      // The block is read from flash at upload time, so it carries every
+      // interval stored since the marker was queued
+      bool daily = record.kind == OUTBOUND_HISTORY_DAY;
+      if (!loadHistoryBlock(daily, record.timestamp, historyBlock, false)) return false;
+      snprintf(path, pathSize, "%s/%lu", daily ? "historyDaily" : "historyBlocks", (unsigned long)record.timestamp);
+      return encodeHistoryBlock(historyBlock, daily, value, valueSize);
+    }
+      
+    case OUTBOUND_DELETE:
+      snprintf(path, pathSize, "%s", record.key);
+      snprintf(value, valueSize, "null");
+      return true;
+      
+    case OUTBOUND_DAILY_TOTALS: {
+      long day = record.values[0];
+      long chickens = record.values[6];
+      snprintf(path, pathSize, "%s", record.key);
+      snprintf(value, valueSize,
+               "{\"date\":\"%04ld-%02ld-%02ld\",\"waterDrunk\":%ld,\"waterRefilled\":%ld,\"feedGrams\":%ld,"
+               "\"feedings\":%ld,\"refills\":%ld,\"chickenCount\":%ld,\"waterPerBird\":%ld,\"updated\":%lu}",
+               day / 10000, day / 100 % 100, day % 100, (long)record.values[1], (long)record.values[2],
+               (long)record.values[3], (long)record.values[4], (long)record.values[5], chickens,
+               chickens > 0 ? (long)record.values[1] / chickens : 0L, (unsigned long)record.timestamp);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Upload up to count records as one multi-path PATCH. Returns how many were sent.
+int sendOutboundBatch(const OutboundRecord* records, int count) {
+  char path[48];
+  static char value[1024]; // Sized for a full daily history block
+  int added = 0;
+  
+  beginFrame(outboxFrame);
+  for (int i = 0; i < count; i++) {
+    if (!formatOutboundRecord(records[i], path, sizeof(path), value, sizeof(value))) {
+      added++; // Unknown record - skip it so it cannot block the outbox
+      continue;
+    }
+    
+    // Stop at the first record that does not fit; it goes in the next batch
+    size_t lengthBefore = outboxFrame.length;
+    addFrameField(outboxFrame, path, value);
+    if (outboxFrame.overflow) {
+      outboxFrame.overflow = false;
+      outboxFrame.length = lengthBefore;
+      outboxFrame.buffer[lengthBefore] = '\0';
+      break;
+    }
+    added++;
+  }
+  
+  if (added == 0) return 0;
+  if (!sendFrame(outboxFrame)) return 0;
+  return added;
+}
+
+size_t outboxSlotOffset(uint16_t slot) {
+  return sizeof(OutboxHeader) + (size_t)slot * sizeof(OutboundRecord);
+}
+
+bool writeOutboxHeader() {
+  outboxFile.seek(0);
+  bool ok = outboxFile.write((const uint8_t*)&outboxHeader, sizeof(outboxHeader)) == sizeof(outboxHeader);
+  outboxFile.flush();
+  return ok;
+}
+
+// Open (or create) the outbox ring file - records left by the previous run are kept
+void beginOutbox() {
+  if (!LittleFS.begin(true)) {
+    LOG_ERROR(LOG_STORAGE, "LittleFS mount failed - records will only be sent while online");
+    return;
+  }
+  
+  bool valid = false;
+  if (LittleFS.exists(OUTBOX_FILE)) {
+    outboxFile = LittleFS.open(OUTBOX_FILE, "r+");
+    if (outboxFile &&
+        outboxFile.read((uint8_t*)&outboxHeader, sizeof(outboxHeader)) == sizeof(outboxHeader) &&
+        outboxHeader.magic == OUTBOX_MAGIC &&
+        outboxHeader.recordSize == sizeof(OutboundRecord) &&
+        outboxHeader.capacity == OUTBOX_CAPACITY &&
+        outboxHeader.head < OUTBOX_CAPACITY &&
+        outboxHeader.count <= OUTBOX_CAPACITY) {
+      valid = true;
+    } else if (outboxFile) {
+      outboxFile.close();
+    }
+  }
+  
+  if (!valid) {
+    // New or incompatible file - start an empty ring
+    outboxFile = LittleFS.open(OUTBOX_FILE, "w+");
+    if (!outboxFile) {
+      LOG_ERROR(LOG_STORAGE, "Failed to create outbox file");
+      return;
+    }
+    outboxHeader.magic = OUTBOX_MAGIC;
+    outboxHeader.recordSize = sizeof(OutboundRecord);
+    outboxHeader.capacity = OUTBOX_CAPACITY;
+    outboxHeader.head = 0;
+    outboxHeader.count = 0;
+    outboxHeader.evicted = 0;
+    writeOutboxHeader();
+  }
+  
+  outboxReady = true;
+  LOG_INFO(LOG_STORAGE, "Outbox ready with %lu pending records", (unsigned long)outboxHeader.count);
+}
+
+// Append a record, evicting the oldest one if the ring is full
+void outboxAppend(const OutboundRecord& record) {
+  if (!outboxReady) {
+    // No flash - best effort, like before the outbox existed
+    if (halCloudReady() && signupOK) {
+      sendOutboundBatch(&record, 1);
+    }
+    return;
+  }
+  
+  if (outboxHeader.count == OUTBOX_CAPACITY) {
+    outboxHeader.count--;
+    outboxHeader.evicted++;
+  }
+  
+  outboxFile.seek(outboxSlotOffset(outboxHeader.head));
+  outboxFile.write((const uint8_t*)&record, sizeof(record));
+  outboxHeader.head = (outboxHeader.head + 1) % OUTBOX_CAPACITY;
+  outboxHeader.count++;
+  writeOutboxHeader();
+}
+
+// Read up to maxCount of the oldest records without removing them
+int outboxPeek(OutboundRecord* records, int maxCount) {
+  int count = outboxHeader.count < maxCount ? outboxHeader.count : maxCount;
+  uint16_t tail = (outboxHeader.head + OUTBOX_CAPACITY - outboxHeader.count) % OUTBOX_CAPACITY;
+  
+  for (int i = 0; i < count; i++) {
+    uint16_t slot = (tail + i) % OUTBOX_CAPACITY;
+    outboxFile.seek(outboxSlotOffset(slot));
+    if (outboxFile.read((uint8_t*)&records[i], sizeof(OutboundRecord)) != sizeof(OutboundRecord)) {
+      return i;
+    }
+  }
+  return count;
+}
+
+// Drop the oldest count records once they have been uploaded
+void outboxRemove(int count) {
+  if (count > outboxHeader.count) count = outboxHeader.count;
+  outboxHeader.count -= count;
+  writeOutboxHeader();
+}
+
+// Records made before SNTP synced carry seconds since boot; move them onto
+// the wall clock. Only records from this boot get here (see holdForClock),
+// so this boot's offset is the right one.
+uint32_t wallClockTimestamp(uint32_t timestamp) {
+  if (timestamp >= TIME_VALID_AFTER) return timestamp;
+  time_t now = halEpoch();
+  if (now < (time_t)TIME_VALID_AFTER) return timestamp;
+  return (uint32_t)(now - halMillis() / 1000) + timestamp;
+}
+
+// Policy for an event code, NULL if it is never limited
+const EventPolicy* eventPolicy(int32_t code) {
+  for (int i = 0; i < EVENT_POLICY_COUNT; i++) {
+    if (eventPolicies[i].code == code) return &eventPolicies[i];
+  }
+  return NULL;
+}
+
+// Suppression window for an event code in seconds, 0 if it is never limited
+uint16_t eventWindow(int32_t code) {
+  const EventPolicy* policy = eventPolicy(code);
+  return policy ? policy->window : 0;
+}
+
+// Give an event the next sequence number of this boot
+void appendEvent(OutboundRecord& record) {
+  record.values[EVENT_SLOT_SEQUENCE] = eventSequence++ % EVENT_SEQUENCE_MODULO;
+  outboxAppend(record);
+}
+
+// Free a limiter slot, first emitting one summary for the repeats it held
+void closeEventWindow(EventLimiter& limiter) {
+  if (limiter.suppressed > 0) {
+    // Dated at the last repeat, not at the pass that noticed the window closed
+    OutboundRecord summary = limiter.latest;
+    summary.values[EVENT_SLOT_OCCURRENCES] = limiter.suppressed;
+    appendEvent(summary);
+  }
+  limiter.subject = 0;
+}
+
+// Should this event go out now? Repeats inside an open window are held back
+bool admitEvent(const OutboundRecord& record) {
+  int32_t code = record.values[EVENT_SLOT_CODE];
+  const EventPolicy* policy = eventPolicy(code);
+  if (!policy || policy->window == 0 || code == 0) return true;
+
+  // On/off codes are limited per state, alerts per code
+  uint32_t subject = code;
+  uint32_t opposite = policy->opposite;
+  if (policy->opposite == policy->code) {
+    if (record.values[EVENT_SLOT_COUNT] > 0 && record.values[EVENT_SLOT_VALUES] != 0) subject |= EVENT_STATE_ON;
+    opposite = subject ^ EVENT_STATE_ON;
+  }
+  
+  // The state changed, so the reverse transition's repeats are over
+  if (opposite != 0) {
+    for (int i = 0; i < EVENT_LIMITER_SLOTS; i++) {
+      if (eventLimiters[i].subject == opposite) closeEventWindow(eventLimiters[i]);
+    }
+  }
+
+  EventLimiter* free = NULL;
+  for (int i = 0; i < EVENT_LIMITER_SLOTS; i++) {
+    EventLimiter& limiter = eventLimiters[i];
+    if (limiter.subject == subject) {
+      limiter.suppressed++;
+      limiter.latest = record;
+      eventsSuppressed++;
+      return false;
+    }
+    if (!free && limiter.subject == 0) free = &limiter;
+  }
+  
+  // Open a window; with every slot busy the event simply goes through
+  if (free) {
+    free->subject = subject;
+    free->windowStart = record.timestamp;
+    free->window = policy->window;
+    free->suppressed = 0;
+  }
+  return true;
+}
+
+// Close the windows that have run out, emitting one summary for the repeats
+void flushEventAggregates() {
+  uint32_t now = (uint32_t)halEpoch();
+  for (int i = 0; i < EVENT_LIMITER_SLOTS; i++) {
+    EventLimiter& limiter = eventLimiters[i];
+    if (limiter.subject == 0 || now - limiter.windowStart < limiter.window) continue;
+    closeEventWindow(limiter);
+  }
+}
+
+// File one record from the control task on the wall clock
+void storeOutboundRecord(OutboundRecord& record) {
+  record.timestamp = wallClockTimestamp(record.timestamp);
+  if (record.kind == OUTBOUND_HISTORY) {
+    storeHistoryInterval(record);
+  } else if (record.kind == OUTBOUND_SET_BOOL || record.kind == OUTBOUND_DAILY_TOTALS) {
+    outboxAppendWrite(record);
+  } else if (record.kind == OUTBOUND_EVENT) {
+    if (admitEvent(record)) appendEvent(record);
+  } else {
+    outboxAppend(record);
+  }
+}
+
+// Keep a boot-relative record in RAM until SNTP syncs. On flash it would
+// outlive this boot, and a later boot could not tell what its time was.
+// When the hold is full the oldest record makes room.
+void holdForClock(const OutboundRecord& record) {
+  if (clockHeldCount == CLOCK_HOLD_RECORDS) {
+    memmove(&clockHeldRecords[0], &clockHeldRecords[1], (CLOCK_HOLD_RECORDS - 1) * sizeof(OutboundRecord));
+    clockHeldCount--;
+    clockHeldDropped++;
+    LOG_WARN(LOG_STORAGE, "No clock yet - oldest held record dropped");
+  }
+  clockHeldRecords[clockHeldCount++] = record;
+}
+
+// Move records handed over by the control task into the outbox - runs even while offline
+void receiveOutboundRecords() {
+  bool clockValid = halEpoch() >= (time_t)TIME_VALID_AFTER;
+  if (clockValid && clockHeldCount > 0) {
+    for (int i = 0; i < clockHeldCount; i++) storeOutboundRecord(clockHeldRecords[i]);
+    LOG_INFO(LOG_STORAGE, "Clock set - %u held records stored", (unsigned)clockHeldCount);
+    clockHeldCount = 0;
+  }
+  flushEventAggregates();
+  
+  OutboundRecord record;
+  while (outboundQueue.pop(record)) {
+    if (!clockValid && record.timestamp < TIME_VALID_AFTER) {
+      holdForClock(record);
+    } else {
+      storeOutboundRecord(record);
+    }
+  }
+}
+
+// Upload one batch of pending records. After a failure the outbox waits
+// before retrying so a dead link does not eat every network pass.
+void drainOutbox() {
+  if (!outboxReady || outboxHeader.count == 0) return;
+  
+  // Records are keyed by timestamp, so hold them until the clock is set
+  if (halEpoch() < (time_t)TIME_VALID_AFTER) return;
+  
+  unsigned long currentMillis = halMillis();
+  if (outboxRetryTime != 0 && (long)(currentMillis - outboxRetryTime) < 0) return;
+  
+  int count = outboxPeek(outboxBatch, OUTBOX_BATCH_SIZE);
+  if (count == 0) return;
+  for (int i = 0; i < count; i++) {
+    outboxBatch[i].timestamp = wallClockTimestamp(outboxBatch[i].timestamp);
+  }
+  
+  int sent = sendOutboundBatch(outboxBatch, count);
+  if (sent > 0) {
+    outboxRemove(sent);
+    outboxRetryTime = 0;
+  } else {
+    outboxRetryTime = currentMillis + OUTBOX_RETRY_DELAY;
+  }
+}
+
+// Queue a flag (or daily totals) write. If a write to the same path is
+// still waiting it is replaced in place, so after an outage only the latest
+// value of each path is sent.
+void outboxAppendWrite(const OutboundRecord& record) {
+  PendingWrite* entry = NULL;
+  for (int i = 0; i < OUTBOX_WRITE_PATHS && !entry; i++) {
+    if (strncmp(pendingWrites[i].key, record.key, sizeof(record.key)) == 0) entry = &pendingWrites[i];
+  }
+  
+  if (entry && outboxReady && outboxSlotPending(entry->slot)) {
+    OutboundRecord pending;
+    outboxFile.seek(outboxSlotOffset(entry->slot));
+    if (outboxFile.read((uint8_t*)&pending, sizeof(pending)) == sizeof(pending) &&
+        pending.kind == record.kind && strncmp(pending.key, record.key, sizeof(record.key)) == 0) {
+      outboxFile.seek(outboxSlotOffset(entry->slot));
+      outboxFile.write((const uint8_t*)&record, sizeof(record));
+      outboxFile.flush();
+      outboxCoalesced++;
+      return;
+    }
+  }
+  
+  // Track the new record, reusing an entry whose write has been sent
+  for (int i = 0; i < OUTBOX_WRITE_PATHS && !entry; i++) {
+    if (pendingWrites[i].key[0] == '\0' || !outboxSlotPending(pendingWrites[i].slot)) entry = &pendingWrites[i];
+  }
+  if (entry) {
+    copyField(entry->key, sizeof(entry->key), record.key);
+    entry->slot = outboxReady ? outboxHeader.head : -1;
+  }
+  outboxAppend(record);
+}
+
+// Is this outbox slot still waiting to be uploaded?
+bool outboxSlotPending(int slot) {
+  if (slot < 0 || slot >= OUTBOX_CAPACITY) return false;
+  uint16_t tail = (outboxHeader.head + OUTBOX_CAPACITY - outboxHeader.count) % OUTBOX_CAPACITY;
+  return (slot - tail + OUTBOX_CAPACITY) % OUTBOX_CAPACITY < outboxHeader.count;
+}
+
+// Queue a history block upload unless the same block is already waiting -
+// uploads read the block from flash, so one pending marker covers every update
+void outboxAppendMarker(const OutboundRecord& record, int& pendingSlot) {
+  if (outboxReady && outboxSlotPending(pendingSlot)) {
+    OutboundRecord pending;
+    outboxFile.seek(outboxSlotOffset(pendingSlot));
+    if (outboxFile.read((uint8_t*)&pending, sizeof(pending)) == sizeof(pending) &&
+        pending.kind == record.kind && pending.timestamp == record.timestamp) {
+      return;
+    }
+  }
+  pendingSlot = outboxReady ? outboxHeader.head : -1;
+  outboxAppend(record);
+}
+
+void historyBlockFile(char* fileName, size_t size, bool daily, uint32_t start) {
+  snprintf(fileName, size, HISTORY_DIR "/%c%lu.bin", daily ? 'd' : 'h', (unsigned long)start);
+}
+
+// Read a block from flash. With create set, a missing block is returned empty.
+bool loadHistoryBlock(bool daily, uint32_t start, HistoryBlock& block, bool create) {
+  char fileName[32];
+  historyBlockFile(fileName, sizeof(fileName), daily, start);
+  
+  if (historyStoreReady && LittleFS.exists(fileName)) {
+    File file = LittleFS.open(fileName, "r");
+    if (file) {
+      bool ok = file.read((uint8_t*)&block, sizeof(block)) == sizeof(block) && block.start == start;
+      file.close();
+      if (ok) return true;
+    }
+  }
+  
+  if (!create) return false;
+  memset(&block, 0, sizeof(block));
+  block.start = start;
+  return true;
+}
+
+bool saveHistoryBlock(bool daily, const HistoryBlock& block) {
+  if (!historyStoreReady) return false;
+  char fileName[32];
+  historyBlockFile(fileName, sizeof(fileName), daily, block.start);
+  File file = LittleFS.open(fileName, "w");
+  if (!file) return false;
+  bool ok = file.write((const uint8_t*)&block, sizeof(block)) == sizeof(block);
+  file.close();
+  return ok;
+}
+
+// Delete local blocks that have aged out (they have long since been uploaded)
+void pruneHistoryStore(uint32_t now) {
+  File directory = LittleFS.open(HISTORY_DIR);
+  if (!directory || !directory.isDirectory()) return;
+  
+  char fileName[32];
+  for (File file = directory.openNextFile(); file; file = directory.openNextFile()) {
+    // name() is the bare name on newer cores and the full path on older ones
+    const char* name = file.name();
+    const char* slash = strrchr(name, '/');
+    if (slash != NULL) name = slash + 1;
+    
+    bool daily = name[0] == 'd';
+    uint32_t start = strtoul(name + 1, NULL, 10);
+    uint32_t retention = daily ? HISTORY_DAILY_LOCAL_RETENTION : HISTORY_LOCAL_RETENTION;
+    file.close();
+    
+    if ((name[0] == 'h' || daily) && start + retention < now) {
+      historyBlockFile(fileName, sizeof(fileName), daily, start);
+      LittleFS.remove(fileName);
+    }
+  }
+  directory.close();
+}
+
+void beginHistoryStore() {
+  // beginOutbox() has already mounted the filesystem (or failed to)
+  if (!outboxReady) return;
+  if (!LittleFS.exists(HISTORY_DIR) && !LittleFS.mkdir(HISTORY_DIR)) {
+    LOG_ERROR(LOG_STORAGE, "Failed to create history directory");
+    return;
+  }
+  historyStoreReady = true;
+}
+
+// Fold the filled intervals of an hour block into one daily slot
+void rollUpHistoryHour(const HistoryBlock& hour, int16_t* daySlot) {
+  long sums[HISTORY_FIELDS] = {0};
+  int filled = 0;
+  
+  for (int slot = 0; slot < HISTORY_SLOTS_PER_HOUR; slot++) {
+    if (!(hour.validMask & (1UL << slot))) continue;
+    const int16_t* values = hour.slots[slot];
+    if (filled == 0) {
+      daySlot[HISTORY_TEMP_MIN] = values[HISTORY_TEMP_MIN];
+      daySlot[HISTORY_TEMP_MAX] = values[HISTORY_TEMP_MAX];
+      daySlot[HISTORY_HUMIDITY_MIN] = values[HISTORY_HUMIDITY_MIN];
+      daySlot[HISTORY_HUMIDITY_MAX] = values[HISTORY_HUMIDITY_MAX];
+    } else {
+      daySlot[HISTORY_TEMP_MIN] = min(daySlot[HISTORY_TEMP_MIN], values[HISTORY_TEMP_MIN]);
+      daySlot[HISTORY_TEMP_MAX] = max(daySlot[HISTORY_TEMP_MAX], values[HISTORY_TEMP_MAX]);
+      daySlot[HISTORY_HUMIDITY_MIN] = min(daySlot[HISTORY_HUMIDITY_MIN], values[HISTORY_HUMIDITY_MIN]);
+      daySlot[HISTORY_HUMIDITY_MAX] = max(daySlot[HISTORY_HUMIDITY_MAX], values[HISTORY_HUMIDITY_MAX]);
+    }
+    for (int field = 0; field < HISTORY_FIELDS; field++) {
+      sums[field] += values[field];
+    }
+    filled++;
+  }
+  if (filled == 0) return;
+  
+  daySlot[HISTORY_TEMP_MEAN] = sums[HISTORY_TEMP_MEAN] / filled;
+  daySlot[HISTORY_HUMIDITY_MEAN] = sums[HISTORY_HUMIDITY_MEAN] / filled;
+  daySlot[HISTORY_FOOD] = sums[HISTORY_FOOD] / filled;
+  daySlot[HISTORY_WATER_MAIN] = sums[HISTORY_WATER_MAIN] / filled;
+  daySlot[HISTORY_WATER_DRINKER] = sums[HISTORY_WATER_DRINKER] / filled;
+}
+
+// Store a finished interval in its hour block, refresh that hour's slot in
+// the daily block and queue both blocks for upload - runs on the network task
+void storeHistoryInterval(const OutboundRecord& record) {
+  uint32_t hourStart = record.timestamp - record.timestamp % 3600;
+  int slot = (record.timestamp - hourStart) / HISTORY_INTERVAL_SECONDS;
+  // Days start at local midnight
+  uint32_t dayStart = hourStart - (hourStart + GMT_OFFSET_SECONDS) % 86400;
+  int hourSlot = (hourStart - dayStart) / 3600;
+  
+  if (!historyStoreReady) {
+    LOG_WARN(LOG_STORAGE, "History store unavailable - interval dropped");
+    return;
+  }
+  
+  bool newHour = !loadHistoryBlock(false, hourStart, historyBlock, false);
+  if (newHour) {
+    loadHistoryBlock(false, hourStart, historyBlock, true);
+    pruneHistoryStore(record.timestamp);
+    
+    // Age the oldest hour block out of the database as well
+    OutboundRecord expired = {};
+    expired.kind = OUTBOUND_DELETE;
+    expired.timestamp = record.timestamp;
+    snprintf(expired.key, sizeof(expired.key), "historyBlocks/%lu", (unsigned long)(hourStart - HISTORY_CLOUD_RETENTION));
+    outboxAppend(expired);
+  }
+  
+  for (int field = 0; field < HISTORY_FIELDS; field++) {
+    historyBlock.slots[slot][field] = (int16_t)record.values[field];
+  }
+  historyBlock.validMask |= 1UL << slot;
+  saveHistoryBlock(false, historyBlock);
+  
+  int16_t daySlot[HISTORY_FIELDS] = {0};
+  rollUpHistoryHour(historyBlock, daySlot);
+  loadHistoryBlock(true, dayStart, historyBlock, true);
+  memcpy(historyBlock.slots[hourSlot], daySlot, sizeof(daySlot));
+  historyBlock.validMask |= 1UL << hourSlot;
+  saveHistoryBlock(true, historyBlock);
+  
+  OutboundRecord marker = {};
+  marker.kind = OUTBOUND_HISTORY_HOUR;
+  marker.timestamp = hourStart;
+  outboxAppendMarker(marker, pendingHourMarkerSlot);
+  marker.kind = OUTBOUND_HISTORY_DAY;
+  marker.timestamp = dayStart;
+  outboxAppendMarker(marker, pendingDayMarkerSlot);
+}
+
+// Pack a block as JSON: {"start","step","mask","data"}. data is base64url of
+// zigzag varints - each field's change from the previous filled slot, so a
+// quiet hour costs about one byte per value.
+bool encodeHistoryBlock(const HistoryBlock& block, bool daily, char* value, size_t valueSize) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+  static uint8_t packed[HISTORY_SLOTS_PER_DAY * HISTORY_FIELDS * 3];
+  int slotCount = daily ? HISTORY_SLOTS_PER_DAY : HISTORY_SLOTS_PER_HOUR;
+  int16_t previous[HISTORY_FIELDS] = {0};
+  size_t packedLength = 0;
+  
+  for (int slot = 0; slot < slotCount; slot++) {
+    if (!(block.validMask & (1UL << slot))) continue;
+    for (int field = 0; field < HISTORY_FIELDS; field++) {
+      int32_t delta = (int32_t)block.slots[slot][field] - previous[field];
+      uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+      previous[field] = block.slots[slot][field];
+      do {
+        uint8_t byte = zigzag & 0x7F;
+        zigzag >>= 7;
+        packed[packedLength++] = zigzag ? (byte | 0x80) : byte;
+      } while (zigzag);
+    }
+  }
+  
+  int length = snprintf(value, valueSize, "{\"start\":%lu,\"step\":%d,\"mask\":%lu,\"data\":\"",
+                        (unsigned long)block.start, daily ? 3600 : HISTORY_INTERVAL_SECONDS,
+                        (unsigned long)block.validMask);
+  if (length < 0 || (size_t)length + (packedLength + 2) / 3 * 4 + 3 > valueSize) return false;
+  
+  for (size_t i = 0; i < packedLength; i += 3) {
+    uint32_t bits = (uint32_t)packed[i] << 16;
+    if (i + 1 < packedLength) bits |= (uint32_t)packed[i + 1] << 8;
+    if (i + 2 < packedLength) bits |= packed[i + 2];
+    value[length++] = alphabet[(bits >> 18) & 0x3F];
+    value[length++] = alphabet[(bits >> 12) & 0x3F];
+    if (i + 1 < packedLength) value[length++] = alphabet[(bits >> 6) & 0x3F];
+    if (i + 2 < packedLength) value[length++] = alphabet[bits & 0x3F];
+  }
+  value[length++] = '"';
+  value[length++] = '}';
+  value[length] = '\0';
+  return true;
+}
+
+// Book intake from the drinker level falling between refills. The reference
+// only moves once the level has changed by WATER_LEVEL_DEADBAND, so sensor
+// noise is not counted as drinking; while the pump runs it is dropped.
+void updateWaterIntake(unsigned long now) {
+  if (pumpState || isWaterFilling) {
+    intakeReferenceLevel = -1;
+    return;
+  }
+  if (intakeReferenceLevel < 0) {
+    intakeReferenceLevel = waterLevelDrinker;
+    intakeReferenceTime = now;
+    return;
+  }
+  
+  if (waterLevelDrinker <= intakeReferenceLevel - WATER_LEVEL_DEADBAND) {
+    unsigned long ml = (unsigned long)(intakeReferenceLevel - waterLevelDrinker) * deviceConfig.drinkerCapacity / 100;
+    float hours = (now - intakeReferenceTime) / 3600000.0f;
+    if (hours > 0) {
+      float rate = ml / hours;
+      drinkRate = drinkRate == 0 ? lroundf(rate) : lroundf(drinkRate + DRINK_RATE_ALPHA * (rate - drinkRate));
+    }
+    
+    dailyHistory[0].waterDrunk += ml;
+    dailyHistoryDirty = true;
+    if (chickenCount > 0) {
+      waterPerBird = dailyHistory[0].waterDrunk / chickenCount;
+    }
+    intakeReferenceLevel = waterLevelDrinker;
+    intakeReferenceTime = now;
+    
+    // Check hydration status and update alert if needed
+    checkHydrationStatus();
+  } else if (waterLevelDrinker >= intakeReferenceLevel + WATER_LEVEL_DEADBAND) {
+    // Topped up by hand
+    intakeReferenceLevel = waterLevelDrinker;
+    intakeReferenceTime = now;
+  }
+}
+
+// Function to check hydration status
+void checkHydrationStatus() {
+  // Only check if we have birds
+  if (chickenCount <= 0) return;
+  
+  // Intake is measured through the day, so judge it against the share of
+  // the daily threshold that should have been drunk by now
+  if (!clockReady) return;
+  long elapsed = (long)(halEpoch() - dayStartTime);
+  if (elapsed < HYDRATION_GRACE_PERIOD) return;
+  int expectedPerBird = deviceConfig.hydrationAlert * min(elapsed, 86400L) / 86400L;
+  
+  // Calculate water per bird
+  int waterPerBirdToday = dailyHistory[0].waterDrunk / chickenCount;
+  
+  // Check against thresholds
+  bool isLowHydration = waterPerBirdToday < expectedPerBird;
+  
+  // Update Firebase alert if status changed
+  if (isLowHydration != lowHydrationAlertActive) {
+    lowHydrationAlertActive = isLowHydration;
+    
+    if (lowHydrationAlertActive) {
+      logEvent(EVENT_LOW_HYDRATION, {waterPerBirdToday, expectedPerBird});
+    } else {
+      logEvent(EVENT_HYDRATION_RESOLVED, {waterPerBirdToday});
+    }
+  }
+}
+
+// Local calendar day as YYYYMMDD
+uint32_t calendarDay(const struct tm& timeinfo) {
+  return (uint32_t)(timeinfo.tm_year + 1900) * 10000 + (timeinfo.tm_mon + 1) * 100 + timeinfo.tm_mday;
+}
+
+// Daily totals saved by the last run - today's counts survive a restart
+void loadDailyHistory() {
+  if (preferences.getBytes("dayTotals", dailyHistory, sizeof(dailyHistory)) != sizeof(dailyHistory)) {
+    memset(dailyHistory, 0, sizeof(dailyHistory));
+  }
+}
+
+// Written by the network task (see writeQueuedNvs)
+void saveDailyHistory() {
+  queueNvsBytes("dayTotals", dailyHistory, sizeof(dailyHistory));
+  lastDailySave = halMillis();
+  dailyHistoryDirty = false;
+}
+
+// A new calendar day started. Anything booked before the clock was set
+// stays with the day it was booked on (the last one saved).
+void startNewDay(uint32_t today) {
+  if (dailyHistory[0].day != 0 && dailyHistory[0].day < today) {
+    // The finished day's final totals go out with the new day
+    queueDailyTotals(dailyHistory[0]);
+    memmove(&dailyHistory[1], &dailyHistory[0], (DAILY_HISTORY_DAYS - 1) * sizeof(DayTotals));
+    memset(&dailyHistory[0], 0, sizeof(DayTotals));
+    LOG_INFO(LOG_SYSTEM, "Daily counters reset for the new day");
+  }
+  dailyHistory[0].day = today;
+  waterPerBird = chickenCount > 0 ? dailyHistory[0].waterDrunk / chickenCount : 0;
+  
+  // Yesterday's shortfall says nothing about today; the periodic check
+  // raises the alert again once today's grace period is over
+  lowHydrationAlertActive = false;
+  
+  saveDailyHistory();
+  queueDailyTotals(dailyHistory[0]);
+}
+
+// Calendar-day rollover. The local date is only worked out again once the
+// clock passes the precomputed next midnight (or steps back before today),
+// so a stalled tick around midnight still rolls the day over, and mktime
+// takes care of 23 and 25 hour DST days.
+void serviceDayRollover(time_t now) {
+  if (nextDayStart == 0 || now >= nextDayStart || now < (time_t)dayStartTime) {
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
+    uint32_t today = calendarDay(timeinfo);
+    
+    timeinfo.tm_hour = 0;
+    timeinfo.tm_min = 0;
+    timeinfo.tm_sec = 0;
+    timeinfo.tm_isdst = -1;
+    dayStartTime = mktime(&timeinfo);
+    timeinfo.tm_mday++;
+    timeinfo.tm_isdst = -1;
+    nextDayStart = mktime(&timeinfo);
+    
+    if (today != dailyHistory[0].day) startNewDay(today);
+  }
+  
+  // Keep flash and the dashboard reasonably current without a write per drink
+  if (dailyHistoryDirty && halMillis() - lastDailySave >= DAILY_SAVE_INTERVAL) {
+    saveDailyHistory();
+    queueDailyTotals(dailyHistory[0]);
+  }
+}
+
+// The wall clock became valid - anchor the current day and arm the
+// schedules from where the last run left off
+void startDayClock() {
+  time_t now = halEpoch();
+  clockReady = true;
+  serviceDayRollover(now);
+  
+  // Entries missed while the device was off still run if they are within
+  // the grace window and did not already run before the restart. A device
+  // that never fired anything starts from now rather than catching up.
+  for (int kind = 0; kind < SCHEDULE_KIND_COUNT; kind++) {
+    ScheduleTimer& timer = scheduleTimers[kind];
+    time_t fired = timer.handledUntil;   // Loaded by loadCachedSchedules()
+    timer.handledUntil = fired == 0 ? now : max(fired, now - (time_t)SCHEDULE_CATCHUP_GRACE);
+    armSchedule(timer);
+  }
+  
+  LOG_INFO(LOG_SCHEDULE, "Clock set. Schedules armed");
+}
+
+void setup() {
+  halBeginSerial();
+  
+  // Log lines queue up in the ring until the log task prints them
+  logBegin();
+  halStartTask(logTask, "log", LOG_TASK_STACK, LOG_TASK_PRIORITY, &logTaskHandle, LOG_TASK_CORE);
+  
+  // Load settings cached in flash by the previous run - the servo angles
+  // in the configuration are needed before the hardware is set up
+  preferences.begin(PREFERENCES_NAMESPACE, false);
+  bootNumber = preferences.getUInt("boots", 0) + 1;
+  preferences.putUInt("boots", bootNumber);
+  loadDeviceConfig();
+  refreshAlertThresholds();
+  loadFeedModel();
+  loadCachedSchedules();
+  loadDailyHistory();
+  loadLevelCalibrations();
+  
+  // Pins, relays (all off), feeder servo (closed) and DHT sensor
+  halBeginHardware();
+  
+  // The request session is set up now; it connects on first use
+  halBeginRtdbSession();
+  
+  // Records that were still waiting for upload at the last reboot
+  beginOutbox();
+  beginHistoryStore();
+  
+  // Log system startup
+  logEvent(EVENT_SYSTEM_STARTED, {});
+  
+  // Start the control task on the application core and the network task
+  // on the protocol core next to the Wi-Fi stack. Wi-Fi, SNTP and Firebase
+  // come up later in the network task (serviceNetworkBringUp).
+  halStartTask(controlTask, "control", CONTROL_TASK_STACK, CONTROL_TASK_PRIORITY,
+               &controlTaskHandle, CONTROL_TASK_CORE);
+  halStartTask(networkTask, "network", NETWORK_TASK_STACK, NETWORK_TASK_PRIORITY,
+               &networkTaskHandle, NETWORK_TASK_CORE);
+}
+
+// Add a sample: median of the last FILTER_WINDOW samples, smoothed by an EMA
+void filterPush(SensorFilter& filter, float sample, unsigned long now) {
+  filter.window[filter.next] = sample;
+  filter.next = (filter.next + 1) % FILTER_WINDOW;
+  if (filter.count < FILTER_WINDOW) filter.count++;
+  
+  float sorted[FILTER_WINDOW];
+  for (int i = 0; i < filter.count; i++) {
+    float value = filter.window[i];
+    int j = i;
+    for (; j > 0 && sorted[j - 1] > value; j--) sorted[j] = sorted[j - 1];
+    sorted[j] = value;
+  }
+  float median = sorted[filter.count / 2];
+  
+  filter.value = filter.valid ? filter.value + FILTER_EMA_ALPHA * (median - filter.value) : median;
+  filter.valid = true;
+  filter.lastGoodTime = now;
+}
+
+// A filter is usable until it has gone SENSOR_STALE_TIMEOUT without a good sample
+bool filterFresh(const SensorFilter& filter, unsigned long now) {
+  return filter.valid && now - filter.lastGoodTime < SENSOR_STALE_TIMEOUT;
+}
+
+// Advance the DHT and ultrasonic measurements - called on every control task
+// pass; each step only touches pins or reads what the interrupts captured
+void serviceSensorSampling(unsigned long now) {
+  switch (dhtPhase) {
+    case DHT_IDLE:
+      if (dhtPhaseTime == 0 || now - dhtPhaseTime >= DHT_SAMPLE_INTERVAL) {
+        halDhtStart();
+        dhtPhaseTime = now;
+        if (DHT_TYPE == 22) {
+          halDelayMicros(DHT22_START_LOW_MICROS);
+          halDhtRelease();
+          dhtCaptureTime = now;
+          dhtPhase = DHT_CAPTURING;
+        } else {
+          dhtPhase = DHT_START_LOW;
+        }
+      }
+      break;
+      
+    case DHT_START_LOW:
+      if (now - dhtPhaseTime >= DHT_START_LOW_TIME) {
+        halDhtRelease();
+        dhtCaptureTime = now;
+        dhtPhase = DHT_CAPTURING;
+      }
+      break;
+      
+    case DHT_CAPTURING:
+      if (now - dhtCaptureTime >= DHT_CAPTURE_TIME) {
+        float temperatureSample, humiditySample;
+        if (halDhtCollect(temperatureSample, humiditySample)) {
+          filterPush(temperatureFilter, temperatureSample, now);
+          filterPush(humidityFilter, humiditySample, now);
+        } else {
+          temperatureFilter.failures++;
+          humidityFilter.failures++;
+        }
+        dhtPhase = DHT_IDLE; // dhtPhaseTime still marks the start, so samples stay 2 s apart
+      }
+      break;
+  }
+  
+  if (sonarPending) {
+    float distanceCm;
+    if (halSonarResult(distanceCm)) {
+      sonarPending = false;
+      filterPush(distanceFilter, distanceCm < 1 ? MAX_DISTANCE : distanceCm, now);
+    } else if (now - sonarStartTime >= SONAR_ECHO_TIMEOUT) {
+      // No echo within range - treated as out of range, as ping_cm() did
+      sonarPending = false;
+      filterPush(distanceFilter, MAX_DISTANCE, now);
+    }
+  } else if (now - lastSonarSample >= SONAR_SAMPLE_INTERVAL) {
+    lastSonarSample = now;
+    sonarStartTime = now;
+    sonarPending = true;
+    halSonarTrigger();
+  }
+}
+
+void readSensors() {
+  unsigned long now = halMillis();
+  
+  // Filtered DHT values. A failed read keeps the last good value; once the
+  // sensor has been silent for SENSOR_STALE_TIMEOUT the climate readings are
+  // marked invalid and automation stops acting on them.
+  bool wasValid = climateValid;
+  climateValid = filterFresh(temperatureFilter, now) && filterFresh(humidityFilter, now);
+  if (climateValid) {
+    temperature = temperatureFilter.value;
+    humidity = humidityFilter.value;
+  } else if (wasValid) {
+    logEvent(EVENT_SENSOR_FAULT, {SENSOR_STALE_TIMEOUT / 1000});
+  }
+  
+  // Filtered ultrasonic distance for food level
+  if (distanceFilter.valid) {
+    // Convert distance to percentage between the full and empty distances
+    foodLevel = lroundf(hopperGrams(distanceFilter.value) * 100 / deviceConfig.hopperCapacity);
+  }
+  
+  // Water levels from the decimated ADC channels
+  // Assuming analog sensors that give higher values when more water is present
+  if (waterMainAdc.primed) {
+    waterLevelMain = applyLevelCalibration(waterMainCalibration, waterMainAdc.value);
+  }
+  if (waterDrinkerAdc.primed) {
+    waterLevelDrinker = applyLevelCalibration(waterDrinkerCalibration, waterDrinkerAdc.value);
+  }
+  
+  LOG_DEBUG(LOG_SENSOR, "Temperature %.1f °C, humidity %.1f %%, food %d %%, main tank %d %%, drinker %d %%",
+            temperature, humidity, foodLevel, waterLevelMain, waterLevelDrinker);
+}
+
+// Start a new PATCH frame
+void beginFrame(PatchFrame& frame) {
+  frame.length = 0;
+  frame.overflow = false;
+  frame.buffer[frame.length++] = '{';
+  frame.buffer[frame.length] = '\0';
+}
+
+// Append one "path":value pair to a frame (value is already JSON-formatted)
+void addFrameField(PatchFrame& frame, const char* path, const char* value) {
+  if (frame.overflow) return;
+  
+  int written = snprintf(frame.buffer + frame.length, frame.size - frame.length,
+                         "%s\"%s\":%s", frame.length > 1 ? "," : "", path, value);
+  
+  // Leave room for the closing brace
+  if (written < 0 || frame.length + written >= frame.size - 1) {
+    frame.overflow = true;
+    frame.buffer[frame.length] = '\0';
+    return;
+  }
+  frame.length += written;
+}
+
+void addFrameFloat(PatchFrame& frame, const char* path, float value) {
+  // JSON has no NaN, so skip invalid readings instead of corrupting the frame
+  if (isnan(value)) return;
+  
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%.2f", value);
+  addFrameField(frame, path, buffer);
+}
+
+void addFrameInt(PatchFrame& frame, const char* path, long value) {
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%ld", value);
+  addFrameField(frame, path, buffer);
+}
+
+void addFrameBool(PatchFrame& frame, const char* path, bool value) {
+  addFrameField(frame, path, value ? "true" : "false");
+}
+
+// Close the frame's JSON object
+void closeFrame(PatchFrame& frame) {
+  frame.buffer[frame.length++] = '}';
+  frame.buffer[frame.length] = '\0';
+}
+
+// Close the frame and send it as a single multi-path update.
+// Keys are full paths ("sensors/temperature"), so the PATCH only touches
+// those leaves and leaves sibling nodes written elsewhere untouched.
+bool sendFrame(PatchFrame& frame) {
+  if (frame.overflow) return false;
+  if (frame.length <= 1) return true; // Nothing to send
+  
+  closeFrame(frame);
+  RtdbResponse response = rtdbPatch("/", frame.buffer);
+  if (!response.ok) printRtdbError("PATCH failed", response);
+  return response.ok;
+}
+
+bool sendTelemetryFrame() {
+  if (telemetryFrame.overflow) {
+    LOG_WARN(LOG_NETWORK, "Telemetry frame overflow - frame dropped");
+    telemetryFramesFailed++;
+    return false;
+  }
+  if (telemetryFrame.length <= 1) return true; // Nothing changed
+  
+  if (sendFrame(telemetryFrame)) {
+    telemetryFramesSent++;
+    return true;
+  }
+  
+  telemetryFramesFailed++;
+  return false;
+}
+
+// Add a float to the frame if it moved past its deadband since the last acknowledged value
+bool publishFloat(const char* path, float value, float& shadow, float deadband) {
+  if (isnan(value)) return false;
+  if (!telemetryFullRefresh && fabs(value - shadow) < deadband) {
+    telemetryFieldsSuppressed++;
+    return false;
+  }
+  addFrameFloat(telemetryFrame, path, value);
+  shadow = value;
+  telemetryFieldsSent++;
+  return true;
+}
+
+bool publishInt(const char* path, long value, long& shadow, long deadband) {
+  if (!telemetryFullRefresh && labs(value - shadow) < deadband) {
+    telemetryFieldsSuppressed++;
+    return false;
+  }
+  addFrameInt(telemetryFrame, path, value);
+  shadow = value;
+  telemetryFieldsSent++;
+  return true;
+}
+
+bool publishBool(const char* path, bool value, bool& shadow) {
+  if (!telemetryFullRefresh && value == shadow) {
+    telemetryFieldsSuppressed++;
+    return false;
+  }
+  addFrameBool(telemetryFrame, path, value);
+  shadow = value;
+  telemetryFieldsSent++;
+  return true;
+}
+
+// Capture everything the network task publishes - runs at the end of each control tick
+void publishTelemetrySnapshot() {
+  TelemetrySnapshot snapshot;
+  snapshot.temperature = temperature;
+  snapshot.humidity = humidity;
+  snapshot.foodLevel = foodLevel;
+  snapshot.waterLevelMain = waterLevelMain;
+  snapshot.waterLevelDrinker = waterLevelDrinker;
+  snapshot.fan = fanState;
+  snapshot.heat = heatState;
+  snapshot.pump = pumpState;
+  snapshot.highTemperature = activeAlerts & (1U << ALERT_HIGH_TEMPERATURE);
+  snapshot.lowTemperature = activeAlerts & (1U << ALERT_LOW_TEMPERATURE);
+  snapshot.lowFood = activeAlerts & (1U << ALERT_LOW_FOOD);
+  snapshot.lowWaterMain = activeAlerts & (1U << ALERT_LOW_WATER_MAIN);
+  snapshot.lowWaterDrinker = activeAlerts & (1U << ALERT_LOW_WATER_DRINKER);
+  snapshot.lowHydration = lowHydrationAlertActive;
+  snapshot.isFeeding = isFeeding;
+  snapshot.isWaterFilling = isWaterFilling;
+  snapshot.totalToday = dailyHistory[0].waterDrunk;
+  snapshot.perBird = waterPerBird;
+  snapshot.drinkRate = drinkRate;
+  
+  // If the network task is behind, the snapshot is dropped - it only ever
+  // publishes the newest one anyway
+  telemetryQueue.push(snapshot);
+}
+
+// Take the newest snapshot from the control task - runs on the network task
+void receiveTelemetrySnapshots() {
+  TelemetrySnapshot snapshot;
+  while (telemetryQueue.pop(snapshot)) {
+    latestTelemetry = snapshot;
+    latestTelemetryValid = true;
+    latestTelemetryPublished = false;
+  }
+}
+
+void updateFirebase(const TelemetrySnapshot& snapshot) {
+  unsigned long currentMillis = halMillis();
+  
+  // Send everything on the first frame and on every heartbeat
+  telemetryFullRefresh = !publishedShadowValid ||
+                         currentMillis - lastFullTelemetryTime >= TELEMETRY_HEARTBEAT_INTERVAL;
+  
+  frameShadow = publishedShadow;
+  beginFrame(telemetryFrame);
+  
+  // Sensor readings - the timestamp rides along whenever any reading changed
+  bool sensorsChanged = false;
+  sensorsChanged |= publishFloat("sensors/temperature", snapshot.temperature, frameShadow.temperature, TEMP_DEADBAND);
+  sensorsChanged |= publishFloat("sensors/humidity", snapshot.humidity, frameShadow.humidity, HUMIDITY_DEADBAND);
+  sensorsChanged |= publishInt("sensors/foodLevel", snapshot.foodLevel, frameShadow.foodLevel, LEVEL_DEADBAND);
+  sensorsChanged |= publishInt("sensors/waterLevelMain", snapshot.waterLevelMain, frameShadow.waterLevelMain, LEVEL_DEADBAND);
+  sensorsChanged |= publishInt("sensors/waterLevelDrinker", snapshot.waterLevelDrinker, frameShadow.waterLevelDrinker, LEVEL_DEADBAND);
+  if (sensorsChanged) {
+    addFrameInt(telemetryFrame, "sensors/timestamp", halEpoch());
+  }
+  
+  // Device states
+  publishBool("deviceStates/fan", !snapshot.fan, frameShadow.fan); // Invert because relays are active LOW
+  publishBool("deviceStates/heat", !snapshot.heat, frameShadow.heat);
+  publishBool("deviceStates/pump", !snapshot.pump, frameShadow.pump);
+  
+  // Alert states
+  publishBool("alerts/highTemperature", snapshot.highTemperature, frameShadow.highTemperature);
+  publishBool("alerts/lowTemperature", snapshot.lowTemperature, frameShadow.lowTemperature);
+  publishBool("alerts/lowFood", snapshot.lowFood, frameShadow.lowFood);
+  publishBool("alerts/lowWaterMain", snapshot.lowWaterMain, frameShadow.lowWaterMain);
+  publishBool("alerts/lowWaterDrinker", snapshot.lowWaterDrinker, frameShadow.lowWaterDrinker);
+  publishBool("alerts/lowHydration", snapshot.lowHydration, frameShadow.lowHydration);
+  
+  // Feeding and water filling status
+  publishBool("deviceStates/isFeeding", snapshot.isFeeding, frameShadow.isFeeding);
+  publishBool("deviceStates/isWaterFilling", snapshot.isWaterFilling, frameShadow.isWaterFilling);
+  
+  // Water consumption data
+  publishInt("waterConsumption/totalToday", snapshot.totalToday, frameShadow.totalToday, WATER_TOTAL_DEADBAND);
+  publishInt("waterConsumption/perBird", snapshot.perBird, frameShadow.perBird, 1);
+  publishInt("waterConsumption/ratePerHour", snapshot.drinkRate, frameShadow.drinkRate, WATER_TOTAL_DEADBAND);
+  
+  // One round-trip for the whole tick, and only if something changed.
+  // The shadow only advances once the database has acknowledged the frame,
+  // so a failed frame is retried with the same deltas next tick.
+  if (sendTelemetryFrame()) {
+    publishedShadow = frameShadow;
+    publishedShadowValid = true;
+    if (telemetryFullRefresh) {
+      lastFullTelemetryTime = currentMillis;
+    }
+  }
+}
+
+// Fold the latest readings into the current history interval and hand each
+// finished interval to the network task - runs on the control task
+void updateHistory() {
+  uint32_t now = (uint32_t)halEpoch();
+  if (now < TIME_VALID_AFTER) return; // No wall clock yet, so no slot to file it under
+  
+  HistoryAccumulator& acc = historyAccumulator;
+  uint32_t intervalStart = now - now % HISTORY_INTERVAL_SECONDS;
+  
+  if (acc.samples > 0 && acc.intervalStart != intervalStart) {
+    OutboundRecord record = {};
+    record.kind = OUTBOUND_HISTORY;
+    record.timestamp = acc.intervalStart;
+    record.values[HISTORY_TEMP_MEAN] = lroundf(acc.temperatureSum * 10 / acc.samples);
+    record.values[HISTORY_TEMP_MIN] = lroundf(acc.temperatureMin * 10);
+    record.values[HISTORY_TEMP_MAX] = lroundf(acc.temperatureMax * 10);
+    record.values[HISTORY_HUMIDITY_MEAN] = lroundf(acc.humiditySum * 10 / acc.samples);
+    record.values[HISTORY_HUMIDITY_MIN] = lroundf(acc.humidityMin * 10);
+    record.values[HISTORY_HUMIDITY_MAX] = lroundf(acc.humidityMax * 10);
+    record.values[HISTORY_FOOD] = acc.foodSum / acc.samples;
+    record.values[HISTORY_WATER_MAIN] = acc.waterMainSum / acc.samples;
+    record.values[HISTORY_WATER_DRINKER] = acc.waterDrinkerSum / acc.samples;
+    queueOutbound(record);
+    acc.samples = 0;
+  }
+  
+  float currentTemperature = isnan(temperature) ? 0 : temperature;
+  float currentHumidity = isnan(humidity) ? 0 : humidity;
+  if (acc.samples == 0) {
+    acc.intervalStart = intervalStart;
+    acc.temperatureSum = acc.humiditySum = 0;
+    acc.temperatureMin = acc.temperatureMax = currentTemperature;
+    acc.humidityMin = acc.humidityMax = currentHumidity;
+    acc.foodSum = acc.waterMainSum = acc.waterDrinkerSum = 0;
+  }
+  
+  acc.temperatureSum += currentTemperature;
+  acc.temperatureMin = min(acc.temperatureMin, currentTemperature);
+  acc.temperatureMax = max(acc.temperatureMax, currentTemperature);
+  acc.humiditySum += currentHumidity;
+  acc.humidityMin = min(acc.humidityMin, currentHumidity);
+  acc.humidityMax = max(acc.humidityMax, currentHumidity);
+  acc.foodSum += foodLevel;
+  acc.waterMainSum += waterLevelMain;
+  acc.waterDrinkerSum += waterLevelDrinker;
+  acc.samples++;
+}
+
+// Report free heap, low-water mark, largest free block and drift since the
+// baseline to serial and /diagnostics/heap - runs on the network task
+void reportHeap() {
+  unsigned long currentMillis = halMillis();
+  if (heapBaseline == 0) {
+    if (currentMillis < HEAP_SETTLE_TIME) return;
+    uint32_t minFreeHeap, largestBlock;
+    halHeapStats(heapBaseline, minFreeHeap, largestBlock);
+    lastHeapReport = currentMillis - HEAP_REPORT_INTERVAL; // Report the baseline right away
+  }
+  if (currentMillis - lastHeapReport < HEAP_REPORT_INTERVAL) return;
+  lastHeapReport = currentMillis;
+  
+  uint32_t freeHeap, minFreeHeap, largestBlock;
+  halHeapStats(freeHeap, minFreeHeap, largestBlock);
+  int32_t drift = (int32_t)heapBaseline - (int32_t)freeHeap;
+  int fragmentation = freeHeap > 0 ? 100 - (int)((uint64_t)largestBlock * 100 / freeHeap) : 0;
+  
+  LOG_INFO(LOG_SYSTEM, "Heap: free %lu, min %lu, largest block %lu, fragmentation %d%%, drift %ld",
+           (unsigned long)freeHeap, (unsigned long)minFreeHeap, (unsigned long)largestBlock,
+           fragmentation, (long)drift);
+  
+  if (!halCloudReady() || !signupOK) return;
+  
+  beginFrame(diagnosticsFrame);
+  addFrameInt(diagnosticsFrame, "diagnostics/heap/free", freeHeap);
+  addFrameInt(diagnosticsFrame, "diagnostics/heap/minFree", minFreeHeap);
+  addFrameInt(diagnosticsFrame, "diagnostics/heap/largestBlock", largestBlock);
+  addFrameInt(diagnosticsFrame, "diagnostics/heap/fragmentation", fragmentation);
+  addFrameInt(diagnosticsFrame, "diagnostics/heap/baseline", heapBaseline);
+  addFrameInt(diagnosticsFrame, "diagnostics/heap/drift", drift);
+  addFrameInt(diagnosticsFrame, "diagnostics/heap/timestamp", halEpoch());
+  sendFrame(diagnosticsFrame);
+}
+
+#if PERF_PROFILING
+void perfRecord(uint8_t phase, uint32_t elapsedMicros) {
+  PerfHistogram& histogram = perfHistograms[phase];
+  int bucket = elapsedMicros == 0 ? 0 : 31 - __builtin_clz(elapsedMicros);
+  if (bucket >= PERF_BUCKETS) bucket = PERF_BUCKETS - 1;
+  histogram.buckets[bucket]++;
+  histogram.count++;
+  histogram.totalMicros += elapsedMicros;
+  if (elapsedMicros > histogram.maxMicros) histogram.maxMicros = elapsedMicros;
+}
+
+// Upper bound of the bucket holding the given percentile (us)
+uint32_t perfPercentile(const PerfHistogram& histogram, int percent) {
+  if (histogram.count == 0) return 0;
+  uint32_t target = ((uint64_t)histogram.count * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int bucket = 0; bucket < PERF_BUCKETS; bucket++) {
+    seen += histogram.buckets[bucket];
+    if (seen >= target) {
+      return bucket == PERF_BUCKETS - 1 ? histogram.maxMicros : (2UL << bucket);
+    }
+  }
+  return histogram.maxMicros;
+}
+
+// Start the serial report; printPerfReport sends it a line at a time
+void startPerfReport() {
+  perfReportPhase = -1;
+  perfReportBucket = -1;
+}
+
+// Print the next lines of the report while the console has room: each phase
+// with its non-empty buckets packed several to a line ("us>=N:count").
+// Runs every network pass, so a long report spreads over a few seconds.
+void printPerfReport() {
+  while (perfReportPhase > -2 && logHasRoom(LOG_CONSOLE, 1)) {
+    if (perfReportPhase == -1) {
+      consolePrintf("Perf: %lu missed ticks", (unsigned long)perfMissedTicks);
+      perfReportPhase = 0;
+      continue;
+    }
+    
+    const PerfHistogram& histogram = perfHistograms[perfReportPhase];
+    if (perfReportBucket < 0) {
+      consolePrintf("%-16s n=%lu mean=%lu p50<=%lu p99<=%lu max=%lu us", perfPhaseNames[perfReportPhase],
+                    (unsigned long)histogram.count,
+                    (unsigned long)(histogram.count ? histogram.totalMicros / histogram.count : 0),
+                    (unsigned long)perfPercentile(histogram, 50), (unsigned long)perfPercentile(histogram, 99),
+                    (unsigned long)histogram.maxMicros);
+      perfReportBucket = 0;
+    } else {
+      char line[LOG_LINE_SIZE];
+      size_t length = snprintf(line, sizeof(line), "  us>=");
+      for (; perfReportBucket < PERF_BUCKETS; perfReportBucket++) {
+        if (histogram.buckets[perfReportBucket] == 0) continue;
+        char entry[24];
+        size_t entryLength = snprintf(entry, sizeof(entry), " %lu:%lu", (unsigned long)(1UL << perfReportBucket),
+                                      (unsigned long)histogram.buckets[perfReportBucket]);
+        if (length + entryLength >= sizeof(line)) break;
+        memcpy(line + length, entry, entryLength + 1);
+        length += entryLength;
+      }
+      if (length > 5) consolePrintf("%s", line);
+    }
+    
+    if (perfReportBucket >= PERF_BUCKETS) {
+      perfReportBucket = -1;
+      if (++perfReportPhase == PERF_PHASE_COUNT) perfReportPhase = -2;
+    }
+  }
+}
+
+// Publish "count/mean/p50/p99/max" per phase as one PATCH - runs on the network task
+void reportPerf() {
+  unsigned long currentMillis = halMillis();
+  if (currentMillis - lastPerfReport < PERF_REPORT_INTERVAL) return;
+  lastPerfReport = currentMillis;
+  
+  char path[48];
+  char value[64];
+  beginFrame(diagnosticsFrame);
+  for (int phase = 0; phase < PERF_PHASE_COUNT; phase++) {
+    const PerfHistogram& histogram = perfHistograms[phase];
+    snprintf(path, sizeof(path), "diagnostics/perf/%s", perfPhaseNames[phase]);
+    snprintf(value, sizeof(value), "\"%lu/%lu/%lu/%lu/%lu\"", (unsigned long)histogram.count,
+             (unsigned long)(histogram.count ? histogram.totalMicros / histogram.count : 0),
+             (unsigned long)perfPercentile(histogram, 50), (unsigned long)perfPercentile(histogram, 99),
+             (unsigned long)histogram.maxMicros);
+    addFrameField(diagnosticsFrame, path, value);
+  }
+  addFrameInt(diagnosticsFrame, "diagnostics/perf/missedTicks", perfMissedTicks);
+  addFrameInt(diagnosticsFrame, "diagnostics/perf/timestamp", halEpoch());
+  sendFrame(diagnosticsFrame);
+}
+#endif
+
+// Mark every ring slot free - before the first line is written
+void logBegin() {
+  for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) {
+    logRing[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+// Over LOG_RATE_LIMIT lines this second for the module? Two tasks racing on
+// a new second may let a line or two extra through, which is fine here.
+bool logRateLimited(uint8_t module, uint32_t now) {
+  uint32_t second = now / 1000;
+  if (logRateSecond[module].load(std::memory_order_relaxed) != second) {
+    logRateSecond[module].store(second, std::memory_order_relaxed);
+    logRateLines[module].store(0, std::memory_order_relaxed);
+  }
+  return logRateLines[module].fetch_add(1, std::memory_order_relaxed) >= LOG_RATE_LIMIT;
+}
+
+// Could the module write this many lines now without one being dropped?
+// Only a hint - the other task may take the room first.
+bool logHasRoom(uint8_t module, uint32_t lines) {
+  uint32_t now = halMillis();
+  if (logRateSecond[module].load(std::memory_order_relaxed) == now / 1000 &&
+      logRateLines[module].load(std::memory_order_relaxed) + lines > LOG_RATE_LIMIT) {
+    return false;
+  }
+  uint32_t position = logHead.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < lines; i++) {
+    if (logRing[(position + i) % LOG_RING_SLOTS].sequence.load(std::memory_order_acquire) != position + i) return false;
+  }
+  return true;
+}
+
+// Format one line into a free slot; never blocks
+void logWriteV(uint8_t level, uint8_t module, const char* format, va_list arguments) {
+  uint32_t now = halMillis();
+  if (logRateLimited(module, now)) {
+    logDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
   
-  // Convert distance to percentage (assuming 1cm is full and 5cm is empty)
-  foodLevel = map(constrain(distance, 1, 5), 1, 5, 100, 0);
+  uint32_t position = logHead.load(std::memory_order_relaxed);
+  LogSlot* slot;
+  for (;;) {
+    slot = &logRing[position % LOG_RING_SLOTS];
+    int32_t lag = (int32_t)(slot->sequence.load(std::memory_order_acquire) - position);
+    if (lag == 0) {
+      if (logHead.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+    } else if (lag < 0) {
+      logDropped.fetch_add(1, std::memory_order_relaxed); // Ring full - the log task is behind
+      return;
+    } else {
+      position = logHead.load(std::memory_order_relaxed);
+    }
+  }
   
-  // Read water level sensors
-  // Assuming analog sensors that give higher values when more water is present
-  int waterMainRaw = analogRead(WATER_LEVEL_MAIN);
-  int waterDrinkerRaw = analogRead(WATER_LEVEL_DRINKER);
-  
-  // Main tank calibration (e.g., 13cm = full)
-  waterLevelMain = map(constrain(waterMainRaw, 600, 2800), 600, 2800, 0, 100);
-
-  // Drinker tank calibration (e.g., 4.5cm = full)
-  waterLevelDrinker = map(constrain(waterDrinkerRaw, 700, 2400), 700, 2400, 0, 100);
-
-  // Clamp values just in case
-  waterLevelMain = constrain(waterLevelMain, 0, 100);
-  waterLevelDrinker = constrain(waterLevelDrinker, 0, 100);
-  
-  // Print sensor readings for debugging
-  Serial.println("Sensor Readings:");
-  Serial.print("Temperature: "); Serial.print(temperature); Serial.println(" °C");
-  Serial.print("Humidity: "); Serial.print(humidity); Serial.println(" %");
-  Serial.print("Food Level: "); Serial.print(foodLevel); Serial.println(" %");
-  Serial.print("Main Water Level: "); Serial.print(waterLevelMain); Serial.println(" %");
-  Serial.print("Drinker Water Level: "); Serial.print(waterLevelDrinker); Serial.println(" %");
-}
-
-void updateFirebase() {
-  if (Firebase.ready() && signupOK) {
-    // Update sensor readings
-    Firebase.RTDB.setFloat(&fbdo, "/sensors/temperature", temperature);
-    Firebase.RTDB.setFloat(&fbdo, "/sensors/humidity", humidity);
-    Firebase.RTDB.setInt(&fbdo, "/sensors/foodLevel", foodLevel);
-    Firebase.RTDB.setInt(&fbdo, "/sensors/waterLevelMain", waterLevelMain);
-    Firebase.RTDB.setInt(&fbdo, "/sensors/waterLevelDrinker", waterLevelDrinker);
-    Firebase.RTDB.setInt(&fbdo, "/sensors/timestamp", time(NULL));
+  slot->millis = now;
+  slot->level = level;
+  slot->module = module;
+  vsnprintf(slot->text, sizeof(slot->text), format, arguments);
+  slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+// Called through the LOG_* macros
+void logWrite(uint8_t level, uint8_t module, const char* format, ...) __attribute__((format(printf, 3, 4)));
+void logWrite(uint8_t level, uint8_t module, const char* format, ...) {
+  va_list arguments;
+  va_start(arguments, format);
+  logWriteV(level, module, format, arguments);
+  va_end(arguments);
+}
+
+// One reply line to a serial command (no trailing newline); not affected by
+// LOG_LEVEL or the runtime levels
+void consolePrintf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void consolePrintf(const char* format, ...) {
+  va_list arguments;
+  va_start(arguments, format);
+  logWriteV(LOG_LEVEL_INFO, LOG_CONSOLE, format, arguments);
+  va_end(arguments);
+}
+
+// Print the completed lines in order - runs on the log task (or the harness)
+void drainLog() {
+  char prefix[32];
+  for (;;) {
+    LogSlot& slot = logRing[logTail % LOG_RING_SLOTS];
+    if (slot.sequence.load(std::memory_order_acquire) != logTail + 1) break; // Empty or still being written
+    
+    if (slot.module != LOG_CONSOLE) {
+      int length = snprintf(prefix, sizeof(prefix), "%lu %c %s: ", (unsigned long)slot.millis,
+                            logLevelLetters[slot.level], logModuleTags[slot.module]);
+      halSerialWrite(prefix, length);
+    }
+    halSerialWrite(slot.text, strlen(slot.text));
+    halSerialWrite("\n", 1);
+    
+    slot.sequence.store(logTail + LOG_RING_SLOTS, std::memory_order_release);
+    logTail++;
+  }
+  
+  uint32_t dropped = logDropped.exchange(0, std::memory_order_relaxed);
+  if (dropped) halSerialPrintf("%lu log lines dropped\n", (unsigned long)dropped);
+}
+
+void logTask(void* parameter) {
+  for (;;) {
+    drainLog();
+    vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL));
+  }
+}
+
+// "log" lists the levels; "log <module>|all <0-4>" changes them. The
+// console module is left out - its replies are never filtered.
+void handleLogCommand(const char* arguments) {
+  if (*arguments == '\0') {
+    for (int module = 0; module < LOG_CONSOLE; module++) {
+      consolePrintf("%-8s %c", logModuleTags[module], logLevelLetters[logLevels[module]]);
+    }
+    return;
+  }
+  
+  char tag[16];
+  int level;
+  if (sscanf(arguments, "%15s %d", tag, &level) != 2 || level < LOG_LEVEL_NONE || level > LOG_LEVEL_DEBUG) {
+    consolePrintf("Usage: log <module>|all <0-4> (none, error, warn, info, debug)");
+    return;
+  }
+  bool all = strcmp(tag, "all") == 0;
+  bool found = all;
+  for (int module = 0; module < LOG_CONSOLE; module++) {
+    if (all || strcmp(tag, logModuleTags[module]) == 0) {
+      logLevels[module] = level;
+      found = true;
+    }
+  }
+  if (!found) consolePrintf("Unknown log module: %s", tag);
+}
+
+// Serial commands, read a character at a time so the network task never
+// waits. Replies go through the log ring like every other line:
+//   perf        print the profiler histograms
+//   perf reset  clear them (control-task phases may lose a sample or two)
+//   cal         print the water level calibration curves
+//   cal main|drinker <raw>:<percent> ...  replace a curve (saved to flash)
+//   log         list the log level of every module
+//   log <module>|all <level>  set a runtime log level (0 none - 4 debug)
+void serviceSerialCommands() {
+  static char line[64];
+  static size_t length = 0;
+  
+#if PERF_PROFILING
+  printPerfReport();
+#endif
+  char c;
+  while (halSerialRead(c)) {
+    if (c != '\n' && c != '\r') {
+      if (length < sizeof(line) - 1) line[length++] = c;
+      continue;
+    }
+    if (length == 0) continue;
+    line[length] = '\0';
+    length = 0;
+    
+    if (strcmp(line, "cal") == 0) {
+      printLevelCalibration("main:", waterMainCalibration);
+      printLevelCalibration("drinker:", waterDrinkerCalibration);
+    } else if (strncmp(line, "cal ", 4) == 0) {
+      handleCalibrationCommand(line + 4);
+    } else if (strcmp(line, "log") == 0 || strncmp(line, "log ", 4) == 0) {
+      handleLogCommand(line[3] ? line + 4 : line + 3);
+    } else
+#if PERF_PROFILING
+    if (strcmp(line, "perf") == 0) {
+      startPerfReport();
+      printPerfReport();
+    } else if (strcmp(line, "perf reset") == 0) {
+      memset(perfHistograms, 0, sizeof(perfHistograms));
+      perfMissedTicks = 0;
+      consolePrintf("Perf counters cleared");
+    } else
+#endif
+    {
+      consolePrintf("Unknown command: %s", line);
+    }
+  }
+}
+
+// Add one averaged block; every ADC_DECIMATION blocks produce a sample that
+// is folded into the smoothed value. Integer-only, so it runs the same on a host.
+void adcDecimatorPush(AdcDecimator& decimator, uint16_t raw) {
+  decimator.sum += raw;
+  if (++decimator.count < ADC_DECIMATION) return;
+  
+  int32_t sample = (int32_t)((decimator.sum << 8) / ADC_DECIMATION);
+  decimator.sum = 0;
+  decimator.count = 0;
+  if (!decimator.primed) {
+    decimator.value = sample;
+    decimator.primed = true;
+  } else {
+    decimator.value += (sample - decimator.value) >> ADC_IIR_SHIFT;
+  }
+}
+
+// Map a Q8 raw value through the calibration curve, clamped to 0-100%
+int applyLevelCalibration(const LevelCalibration& calibration, int32_t rawQ8) {
+  const int last = calibration.count - 1;
+  if (rawQ8 <= ((int32_t)calibration.raw[0] << 8)) return calibration.percent[0];
+  if (rawQ8 >= ((int32_t)calibration.raw[last] << 8)) return calibration.percent[last];
+  
+  int segment = 0;
+  while (segment < last - 1 && rawQ8 > ((int32_t)calibration.raw[segment + 1] << 8)) segment++;
+  
+  int32_t rawStart = (int32_t)calibration.raw[segment] << 8;
+  int32_t rawSpan = ((int32_t)calibration.raw[segment + 1] << 8) - rawStart;
+  int32_t percentSpan = calibration.percent[segment + 1] - calibration.percent[segment];
+  int32_t percent = calibration.percent[segment] + ((rawQ8 - rawStart) * percentSpan + rawSpan / 2) / rawSpan;
+  return constrain(percent, 0, 100);
+}
+
+// At least two points, raw strictly ascending, percent within 0-100
+bool validLevelCalibration(const LevelCalibration& calibration) {
+  if (calibration.count < 2 || calibration.count > CALIBRATION_POINTS) return false;
+  for (int i = 0; i < calibration.count; i++) {
+    if (calibration.percent[i] > 100) return false;
+    if (i > 0 && calibration.raw[i] <= calibration.raw[i - 1]) return false;
+  }
+  return true;
+}
+
+// Replace the compiled-in curves with the ones saved in flash, if any - at
+// boot only; later curves reach the control task through calibrationQueue
+void loadLevelCalibrations() {
+  LevelCalibration calibration;
+  if (preferences.getBytes("calMain", &calibration, sizeof(calibration)) == sizeof(calibration) &&
+      validLevelCalibration(calibration)) {
+    waterMainCalibration = calibration;
+  }
+  if (preferences.getBytes("calDrinker", &calibration, sizeof(calibration)) == sizeof(calibration) &&
+      validLevelCalibration(calibration)) {
+    waterDrinkerCalibration = calibration;
+  }
+}
+
+void printLevelCalibration(const char* name, const LevelCalibration& calibration) {
+  char line[LOG_LINE_SIZE];
+  size_t length = snprintf(line, sizeof(line), "%s", name);
+  for (int i = 0; i < calibration.count && length < sizeof(line); i++) {
+    length += snprintf(line + length, sizeof(line) - length, " %u:%u",
+                       (unsigned)calibration.raw[i], (unsigned)calibration.percent[i]);
+  }
+  consolePrintf("%s", line);
+}
+
+// "cal main 600:0 2800:100" - parse, save to flash and hand to the control task
+void handleCalibrationCommand(const char* arguments) {
+  bool isMain = strncmp(arguments, "main ", 5) == 0;
+  bool drinker = strncmp(arguments, "drinker ", 8) == 0;
+  if (!isMain && !drinker) {
+    consolePrintf("Usage: cal main|drinker <raw>:<percent> ... (2-4 points)");
+    return;
+  }
+  
+  LevelCalibration calibration = {};
+  const char* cursor = arguments + (isMain ? 5 : 8);
+  unsigned raw, percent;
+  int consumed;
+  while (calibration.count < CALIBRATION_POINTS &&
+         sscanf(cursor, " %u:%u%n", &raw, &percent, &consumed) == 2) {
+    if (raw > 4095 || percent > 100) {
+      consolePrintf("Raw values are 0-4095 and percentages 0-100");
+      return;
+    }
+    calibration.raw[calibration.count] = raw;
+    calibration.percent[calibration.count] = percent;
+    calibration.count++;
+    cursor += consumed;
+  }
+  if (!validLevelCalibration(calibration)) {
+    consolePrintf("Invalid calibration - need 2-4 points with ascending raw values");
+    return;
+  }
+  
+  preferences.putBytes(isMain ? "calMain" : "calDrinker", &calibration, sizeof(calibration));
+  CalibrationUpdate update;
+  update.channel = isMain ? 0 : 1;
+  update.calibration = calibration;
+  if (!calibrationQueue.push(update)) {
+    LOG_WARN(LOG_SENSOR, "Calibration queue full - curve applies after a reboot");
+  }
+  printLevelCalibration(isMain ? "Saved main:" : "Saved drinker:", calibration);
+}
+
+// Driver callback (ISR context) - a new averaged block is waiting
+void IRAM_ATTR adcBlockIsr() {
+  adcBlockReady = true;
+}
+
+// Start continuous sampling of both water level channels
+void halBeginAdc() {
+#if !defined(POULTRY_SIMULATION) && ESP_ARDUINO_VERSION_MAJOR >= 3
+  const uint8_t pins[] = {WATER_LEVEL_MAIN, WATER_LEVEL_DRINKER};
+  if (!analogContinuous(pins, 2, ADC_CONVERSIONS_PER_PIN, ADC_SAMPLE_RATE, adcBlockIsr) ||
+      !analogContinuousStart()) {
+    LOG_ERROR(LOG_SENSOR, "Continuous ADC failed to start");
+  }
+#endif
+}
+
+// Latest averaged block for both channels, if a new one is available
+bool halReadAdcBlock(uint16_t& mainRaw, uint16_t& drinkerRaw) {
+#if defined(POULTRY_SIMULATION)
+  // The drinker fills while the pump relay is on; time too short for a
+  // whole raw step is carried over to the next block
+  unsigned long now = halMillis();
+  if (simBarn.relayOn[2] && simBarn.pumpRawPerSecond > 0) {
+    int gained = (now - simBarn.pumpCheckedAt) * simBarn.pumpRawPerSecond / 1000;
+    simBarn.waterDrinkerRaw += gained;
+    simBarn.pumpCheckedAt += (unsigned long)gained * 1000 / simBarn.pumpRawPerSecond;
+  } else {
+    simBarn.pumpCheckedAt = now;
+  }
+  mainRaw = simBarn.waterMainRaw;
+  drinkerRaw = simBarn.waterDrinkerRaw;
+  return true;
+#elif ESP_ARDUINO_VERSION_MAJOR >= 3
+  if (!adcBlockReady) return false;
+  adcBlockReady = false;
+  adc_continuous_data_t* result = NULL;
+  if (!analogContinuousRead(&result, 0) || result == NULL) return false;
+  mainRaw = result[0].avg_read_raw;
+  drinkerRaw = result[1].avg_read_raw;
+  return true;
+#else
+  // Older cores have no continuous mode - oversample with a short burst instead
+  uint32_t mainSum = 0, drinkerSum = 0;
+  for (int i = 0; i < ADC_FALLBACK_SAMPLES; i++) {
+    mainSum += analogRead(WATER_LEVEL_MAIN);
+    drinkerSum += analogRead(WATER_LEVEL_DRINKER);
+  }
+  mainRaw = mainSum / ADC_FALLBACK_SAMPLES;
+  drinkerRaw = drinkerSum / ADC_FALLBACK_SAMPLES;
+  return true;
+#endif
+}
+
+// Feed new ADC blocks to the decimators - called on every control task pass
+void serviceWaterLevelSampling() {
+  uint16_t mainRaw, drinkerRaw;
+  if (halReadAdcBlock(mainRaw, drinkerRaw)) {
+    adcDecimatorPush(waterMainAdc, mainRaw);
+    adcDecimatorPush(waterDrinkerAdc, drinkerRaw);
+  }
+}
+
+// Pick the alert thresholds out of the configuration - runs when it changes
+void refreshAlertThresholds() {
+  for (int i = 0; i < THRESHOLD_COUNT; i++) {
+    const ConfigField& field = alertThresholdFields[i];
+    const uint8_t* slot = (const uint8_t*)&deviceConfig + field.offset;
+    alertInputs.threshold[i] = field.type == CONFIG_FLOAT ? tenths(*(const float*)slot) : *(const int32_t*)slot * 10;
+  }
+}
+
+void checkAndUpdateAlerts() {
+  // Temperature alerts only follow current DHT readings
+  alertInputs.reading[ALERT_SENSOR_TEMPERATURE] = tenths(temperature);
+  alertInputs.reading[ALERT_SENSOR_FOOD] = foodLevel * 10;
+  alertInputs.reading[ALERT_SENSOR_WATER_MAIN] = waterLevelMain * 10;
+  alertInputs.reading[ALERT_SENSOR_WATER_DRINKER] = waterLevelDrinker * 10;
+  alertInputs.validSensors = climateValid ? 0xFF : (uint8_t)~(1 << ALERT_SENSOR_TEMPERATURE);
+  
+  for (int i = 0; i < ALERT_RULE_COUNT; i++) {
+    const AlertRule& rule = alertRules[i];
+    if (!(alertInputs.validSensors & (1 << rule.sensor))) continue;
+    
+    int32_t reading = alertInputs.reading[rule.sensor];
+    int32_t limit = alertInputs.threshold[rule.threshold];
+    bool active = rule.comparator == ALERT_ABOVE ? reading > limit : reading < limit;
+    uint16_t bit = 1U << i;
+    if (active == ((activeAlerts & bit) != 0)) continue;
+    
+    activeAlerts ^= bit;
+    logEvent(active ? rule.raised : rule.resolved, {reading, limit});
+  }
+}
+
+// Minimal JSON reader for stream events and GET payloads. It walks the text
+// in place - values are pointers into the payload, nothing is copied or
+// allocated - and knows only what RTDB sends: objects, arrays, strings,
+// numbers and true/false/null.
+const char* jsonSkipSpace(const char* json) {
+  while (*json == ' ' || *json == '\t' || *json == '\n' || *json == '\r') json++;
+  return json;
+}
+
+// Past the closing quote of the string starting at json, or NULL if it is unterminated
+const char* jsonSkipString(const char* json) {
+  for (json++; *json != '"'; json++) {
+    if (*json == '\0') return NULL;
+    if (*json == '\\' && *++json == '\0') return NULL;
+  }
+  return json + 1;
+}
+
+// Past the value starting at json, or NULL if it is malformed
+const char* jsonSkipValue(const char* json) {
+  json = jsonSkipSpace(json);
+  if (*json == '"') return jsonSkipString(json);
+  
+  if (*json != '{' && *json != '[') {
+    // Number or literal - runs up to the next delimiter
+    const char* start = json;
+    while (*json != '\0' && *json != ',' && *json != '}' && *json != ']' && !isspace((unsigned char)*json)) json++;
+    return json == start ? NULL : json;
+  }
+  
+  int depth = 0;
+  while (*json != '\0') {
+    if (*json == '"') {
+      json = jsonSkipString(json);
+      if (json == NULL) return NULL;
+      continue;
+    }
+    if (*json == '{' || *json == '[') {
+      depth++;
+    } else if ((*json == '}' || *json == ']') && --depth == 0) {
+      return json + 1;
+    }
+    json++;
+  }
+  return NULL;
+}
+
+// Start walking the members of an object or the elements of an array
+bool jsonOpen(JsonCursor& cursor, const char* json) {
+  json = jsonSkipSpace(json);
+  if (*json != '{' && *json != '[') return false;
+  cursor.array = *json == '[';
+  cursor.next = json + 1;
+  cursor.index = 0;
+  return true;
+}
+
+// Next member (key is its name) or element (key is its index). Keys longer
+// than keySize are cut short, which none of the keys we look for are.
+bool jsonNext(JsonCursor& cursor, char* key, size_t keySize, const char*& value) {
+  if (cursor.next == NULL) return false;
+  const char* json = jsonSkipSpace(cursor.next);
+  if (*json == ',') json = jsonSkipSpace(json + 1);
+  if (*json == '}' || *json == ']' || *json == '\0') return false;
+  
+  if (cursor.array) {
+    snprintf(key, keySize, "%d", cursor.index++);
+  } else {
+    if (*json != '"') return false;
+    const char* end = jsonSkipString(json);
+    if (end == NULL) return false;
+    size_t length = min((size_t)(end - json - 2), keySize - 1);
+    memcpy(key, json + 1, length);
+    key[length] = '\0';
+    json = jsonSkipSpace(end);
+    if (*json != ':') return false;
+    json++;
+  }
+  
+  value = jsonSkipSpace(json);
+  cursor.next = jsonSkipValue(value);
+  return cursor.next != NULL;
+}
+
+// One member of an object, or NULL if json is not an object or has no such key
+const char* jsonMember(const char* json, const char* key) {
+  JsonCursor cursor;
+  if (!jsonOpen(cursor, json) || cursor.array) return NULL;
+  
+  char name[32];
+  const char* value;
+  while (jsonNext(cursor, name, sizeof(name), value)) {
+    if (strcmp(name, key) == 0) return value;
+  }
+  return NULL;
+}
+
+// Numbers, true/false as 1/0 and null as 0 (a deleted child reads as unset)
+bool jsonReadNumber(const char* value, float& result) {
+  value = jsonSkipSpace(value);
+  if (strncmp(value, "true", 4) == 0) {
+    result = 1;
+  } else if (strncmp(value, "false", 5) == 0 || strncmp(value, "null", 4) == 0) {
+    result = 0;
+  } else {
+    char* end;
+    result = strtof(value, &end);
+    if (end == value) return false;
+  }
+  return true;
+}
+
+// Anything jsonReadNumber() takes (non-zero is true), plus the string "true"
+bool jsonReadBool(const char* value, bool& result) {
+  value = jsonSkipSpace(value);
+  if (*value == '"') {
+    result = strncmp(value, "\"true\"", 6) == 0;
+    return true;
+  }
+  float number;
+  if (!jsonReadNumber(value, number)) return false;
+  result = number != 0;
+  return true;
+}
+
+// Copy a string value; escaped characters are kept without their backslash
+bool jsonReadString(const char* value, char* text, size_t size) {
+  value = jsonSkipSpace(value);
+  if (*value != '"') return false;
+  const char* end = jsonSkipString(value);
+  if (end == NULL) return false;
+  
+  size_t length = 0;
+  for (const char* c = value + 1; c < end - 1 && length + 1 < size; c++) {
+    if (*c == '\\') c++;
+    text[length++] = *c;
+  }
+  text[length] = '\0';
+  return true;
+}
+
+// Where a key's value sits in a stream event or GET payload. relativePath is
+// the event path under the node ("/" for a whole-node snapshot, "/<key>"
+// when a single child changed); NULL when the event does not touch the key.
+const char* eventField(const char* relativePath, const char* json, const char* key) {
+  if (strcmp(relativePath, "/") == 0) return jsonMember(json, key);
+  
+  // Single child - only accept an exact "/<key>" match
+  if (relativePath[0] != '/' || strcmp(relativePath + 1, key) != 0) return NULL;
+  return json;
+}
+
+bool readEventBool(const char* relativePath, const char* json, const char* key, bool& result) {
+  const char* value = eventField(relativePath, json, key);
+  return value != NULL && jsonReadBool(value, result);
+}
+
+bool readEventNumber(const char* relativePath, const char* json, const char* key, float& result) {
+  const char* value = eventField(relativePath, json, key);
+  return value != NULL && jsonReadNumber(value, result);
+}
+
+bool readEventString(const char* relativePath, const char* json, const char* key, char* text, size_t size) {
+  const char* value = eventField(relativePath, json, key);
+  return value != NULL && jsonReadString(value, text, size);
+}
+
+// Hand a control or setting to the control task
+void postInbound(uint8_t kind, int32_t intValue, float floatValue, const char* text) {
+  InboundMessage message = {};
+  message.kind = kind;
+  message.intValue = intValue;
+  message.floatValue = floatValue;
+  if (text != NULL) {
+    copyField(message.text, sizeof(message.text), text);
+  }
+  if (!inboundQueue.push(message)) {
+    LOG_WARN(LOG_NETWORK, "Inbound queue full - control update dropped");
+  }
+}
+
+// /controls changed
+void handleControlsData(const char* relativePath, const char* json) {
+  bool flag;
+  float number;
+  
+  if (readEventBool(relativePath, json, "automationEnabled", flag)) postInbound(INBOUND_AUTOMATION, flag, 0, NULL);
+  if (readEventBool(relativePath, json, "fan", flag)) postInbound(INBOUND_FAN, flag, 0, NULL);
+  if (readEventBool(relativePath, json, "heat", flag)) postInbound(INBOUND_HEAT, flag, 0, NULL);
+  if (readEventBool(relativePath, json, "pump", flag)) postInbound(INBOUND_PUMP, flag, 0, NULL);
+  if (readEventBool(relativePath, json, "feed", flag)) postInbound(INBOUND_FEED, flag, 0, NULL);
+  if (readEventNumber(relativePath, json, "feedDuration", number)) postInbound(INBOUND_FEED_DURATION, 0, number, NULL);
+  if (readEventNumber(relativePath, json, "feedGrams", number)) postInbound(INBOUND_FEED_GRAMS, 0, number, NULL);
+  if (readEventBool(relativePath, json, "waterFill", flag)) postInbound(INBOUND_WATER_FILL, flag, 0, NULL);
+  
+  // Only act on manual relay values once we have seen the whole node
+  if (strcmp(relativePath, "/") == 0) {
+    postInbound(INBOUND_CONTROLS_SYNCED, 1, 0, NULL);
+  }
+}
+
+// /feedingSettings changed
+void handleFeedingSettingsData(const char* relativePath, const char* json) {
+  char text[sizeof(InboundMessage::text)];
+  float number;
+  
+  // Get age group
+  if (readEventString(relativePath, json, "ageGroup", text, sizeof(text)) && text[0] != '\0') {
+    postInbound(INBOUND_AGE_GROUP, 0, 0, text);
+  }
+  
+  // Get chicken count
+  if (readEventNumber(relativePath, json, "chickenCount", number) && (int)number > 0) {
+    postInbound(INBOUND_CHICKEN_COUNT, (int)number, 0, NULL);
+  }
+}
+
+// /waterSettings changed
+void handleWaterSettingsData(const char* relativePath, const char* json) {
+  bool flag;
+  float number;
+  
+  if (readEventNumber(relativePath, json, "flowRate", number) && (int)number > 0) {
+    postInbound(INBOUND_WATER_FLOW_RATE, (int)number, 0, NULL);
+  }
+  if (readEventNumber(relativePath, json, "fillDuration", number) && (int)number > 0) {
+    postInbound(INBOUND_WATER_FILL_DURATION, (int)number, 0, NULL);
+  }
+  if (readEventBool(relativePath, json, "autoEnabled", flag)) {
+    postInbound(INBOUND_AUTO_WATER, flag, 0, NULL);
+  }
+}
+
+// Schedule key -> minute of the day. "8" means 08:00, "8:30"/"08:30" a minute.
+bool parseScheduleKey(const char* key, uint16_t& minute) {
+  if (!isdigit((unsigned char)key[0])) return false;
+  char* end;
+  long hour = strtol(key, &end, 10);
+  long minutes = 0;
+  if (*end == ':') {
+    if (!isdigit((unsigned char)end[1])) return false;
+    minutes = strtol(end + 1, &end, 10);
+  }
+  if (*end != '\0' || hour > 23 || minutes > 59) return false;
+  minute = hour * 60 + minutes;
+  return true;
+}
+
+// Schedule value (JSON text) -> amount. Returns false when the entry is not scheduled.
+bool parseScheduleValue(const char* json, uint16_t& amount) {
+  json = jsonSkipSpace(json);
+  if (strncmp(json, "true", 4) == 0) {
+    amount = 0;
+    return true;
+  }
+  long value = atol(json);   // false, null and strings read as 0
+  if (value <= 0) return false;
+  amount = min(value, 65535L);
+  return true;
+}
+
+// Insert, update or remove one entry, keeping the list sorted
+void setScheduleEntry(DailySchedule& schedule, uint16_t minute, bool enabled, uint16_t amount) {
+  int index = 0;
+  while (index < schedule.count && schedule.entries[index].minute < minute) index++;
+  bool present = index < schedule.count && schedule.entries[index].minute == minute;
+  
+  if (!enabled) {
+    if (present) {
+      memmove(&schedule.entries[index], &schedule.entries[index + 1],
+              (schedule.count - index - 1) * sizeof(ScheduleEntry));
+      schedule.count--;
+    }
+    return;
+  }
+  if (!present) {
+    if (schedule.count >= SCHEDULE_MAX_ENTRIES) {
+      LOG_WARN(LOG_SCHEDULE, "Schedule full - entry ignored");
+      return;
+    }
+    memmove(&schedule.entries[index + 1], &schedule.entries[index],
+            (schedule.count - index) * sizeof(ScheduleEntry));
+    schedule.count++;
+  }
+  schedule.entries[index].minute = minute;
+  schedule.entries[index].amount = amount;
+}
+
+// Apply a schedule node (whole object/array, or one "/<key>" child) to a
+// compiled schedule. Returns true if the schedule changed.
+bool applyScheduleData(const char* relativePath, const char* json, DailySchedule& schedule) {
+  DailySchedule updated = schedule;
+  uint16_t minute, amount;
+  
+  if (strcmp(relativePath, "/") == 0) {
+    // Whole schedule - rebuild from scratch. RTDB returns hour keys 0..23 as
+    // an array when most of them are present; the cursor numbers those.
+    updated = {};
+    JsonCursor cursor;
+    if (jsonOpen(cursor, json)) {
+      char key[16];
+      const char* value;
+      while (jsonNext(cursor, key, sizeof(key), value)) {
+        if (parseScheduleKey(key, minute) && parseScheduleValue(value, amount)) {
+          setScheduleEntry(updated, minute, true, amount);
+        }
+      }
+    } else if (strncmp(jsonSkipSpace(json), "null", 4) != 0) {
+      return false;
+    }
+  } else {
+    // Single entry changed - "/<key>"
+    if (!parseScheduleKey(relativePath + 1, minute)) return false;
+    bool enabled = parseScheduleValue(json, amount);
+    setScheduleEntry(updated, minute, enabled, enabled ? amount : 0);
+  }
+  
+  if (memcmp(&updated, &schedule, sizeof(updated)) == 0) return false;
+  schedule = updated;
+  return true;
+}
+
+// Save a changed schedule and hand it to the control task
+void publishSchedule(ScheduleKind kind, const char* name) {
+  DailySchedule& schedule = networkSchedules[kind];
+  preferences.putBytes(scheduleStoreKeys[kind], &schedule, sizeof(schedule));
+  
+  ScheduleUpdate update = {};
+  update.kind = kind;
+  update.schedule = schedule;
+  if (!scheduleQueue.push(update)) {
+    LOG_WARN(LOG_SCHEDULE, "Schedule queue full - update dropped");
+  }
+  
+  // One line for the whole schedule; entries past the line length are cut off
+  char text[LOG_LINE_SIZE];
+  size_t length = 0;
+  for (int i = 0; i < schedule.count && length < sizeof(text); i++) {
+    length += snprintf(text + length, sizeof(text) - length, " %02d:%02d", schedule.entries[i].minute / 60,
+                       schedule.entries[i].minute % 60);
+    if (schedule.entries[i].amount && length < sizeof(text)) {
+      length += snprintf(text + length, sizeof(text) - length, "(%u)", (unsigned)schedule.entries[i].amount);
+    }
+  }
+  text[min(length, sizeof(text) - 1)] = '\0';
+  LOG_INFO(LOG_SCHEDULE, "%s schedule updated:%s", name, text);
+}
+
+// /feedingSchedule changed
+void handleFeedingScheduleData(const char* relativePath, const char* json) {
+  if (applyScheduleData(relativePath, json, networkSchedules[SCHEDULE_FEEDING])) {
+    publishSchedule(SCHEDULE_FEEDING, "Feeding");
+  }
+}
+
+// /waterSchedule changed
+void handleWaterScheduleData(const char* relativePath, const char* json) {
+  if (applyScheduleData(relativePath, json, networkSchedules[SCHEDULE_WATER])) {
+    publishSchedule(SCHEDULE_WATER, "Water");
+  }
+}
+
+// Checks that need more than one field
+bool validDeviceConfig(const DeviceConfig& candidate) {
+  return candidate.tempLow < candidate.tempHigh &&
+         candidate.hydrationAlert <= candidate.hydrationWarning &&
+         candidate.foodFullCm < candidate.foodEmptyCm &&
+         candidate.drinkerRefillLevel < candidate.drinkerTarget;
+}
+
+// Load the configuration saved by the last sync; defaults if there is none
+void loadDeviceConfig() {
+  DeviceConfig saved;
+  if (preferences.getBytes("config", &saved, sizeof(saved)) == sizeof(saved) &&
+      saved.version == CONFIG_VERSION && saved.size == sizeof(DeviceConfig) &&
+      validDeviceConfig(saved)) {
+    deviceConfig = saved;
+    LOG_INFO(LOG_CONFIG, "Configuration loaded from flash");
+  } else {
+    deviceConfig = defaultConfig;
+  }
+  networkConfig = deviceConfig;
+}
+
+// /config changed - apply the keys present, then save and hand the whole
+// struct to the control task if anything actually changed
+void handleConfigData(const char* relativePath, const char* json) {
+  DeviceConfig updated = networkConfig;
+  
+  for (int i = 0; i < CONFIG_FIELD_COUNT; i++) {
+    const ConfigField& field = configFields[i];
+    float value;
+    if (!readEventNumber(relativePath, json, field.key, value)) continue;
     
-    // Update device states
-    Firebase.RTDB.setBool(&fbdo, "/deviceStates/fan", !fanState); // Invert because relays are active LOW
-    Firebase.RTDB.setBool(&fbdo, "/deviceStates/heat", !heatState);
-    Firebase.RTDB.setBool(&fbdo, "/deviceStates/pump", !pumpState);
+    if (field.type != CONFIG_FLOAT) value = (int32_t)value;
+    if (value < field.minValue || value > field.maxValue) {
+      LOG_WARN(LOG_CONFIG, "Ignoring out of range config value for %s", field.key);
+      continue;
+    }
+    uint8_t* target = (uint8_t*)&updated + field.offset;
+    if (field.type == CONFIG_FLOAT) {
+      *(float*)target = value;
+    } else {
+      *(int32_t*)target = (int32_t)value;
+    }
+  }
+  
+  if (memcmp(&updated, &networkConfig, sizeof(updated)) == 0) return;
+  if (!validDeviceConfig(updated)) {
+    LOG_WARN(LOG_CONFIG, "Ignoring inconsistent /config update");
+    return;
+  }
+  
+  networkConfig = updated;
+  preferences.putBytes("config", &networkConfig, sizeof(networkConfig));
+  if (!configQueue.push(networkConfig)) {
+    LOG_WARN(LOG_CONFIG, "Config queue full - update dropped");
+  }
+  LOG_INFO(LOG_CONFIG, "Configuration updated");
+}
+
+// Load the schedules saved by the last run so scheduling works before (or without) the network
+void loadCachedSchedules() {
+  for (int kind = 0; kind < SCHEDULE_KIND_COUNT; kind++) {
+    DailySchedule& schedule = networkSchedules[kind];
+    schedule = {};
     
-    // Update alert states
-    Firebase.RTDB.setBool(&fbdo, "/alerts/highTemperature", temperature > TEMP_HIGH_THRESHOLD);
-    Firebase.RTDB.setBool(&fbdo, "/alerts/lowTemperature", temperature < TEMP_LOW_THRESHOLD);
-    Firebase.RTDB.setBool(&fbdo, "/alerts/lowFood", foodLevel < FOOD_LOW_THRESHOLD);
-    Firebase.RTDB.setBool(&fbdo, "/alerts/lowWaterMain", waterLevelMain < WATER_MAIN_LOW_THRESHOLD);
-    Firebase.RTDB.setBool(&fbdo, "/alerts/lowWaterDrinker", waterLevelDrinker < WATER_DRINKER_LOW_THRESHOLD);
+    if (preferences.getBytes(scheduleStoreKeys[kind], &schedule, sizeof(schedule)) != sizeof(schedule) ||
+        schedule.count > SCHEDULE_MAX_ENTRIES) {
+      // Nothing in the current format - convert the hour bitmap older firmware saved
+      schedule = {};
+      uint32_t hours = preferences.getUInt(scheduleLegacyKeys[kind], 0);
+      for (int hour = 0; hour < 24; hour++) {
+        if (hours & (1UL << hour)) setScheduleEntry(schedule, hour * 60, true, 0);
+      }
+    }
     
-    // Update feeding status
-    Firebase.RTDB.setBool(&fbdo, "/deviceStates/isFeeding", isFeeding);
+    // The control task starts with the same copy. Until the clock is set,
+    // handledUntil holds the last entry handled by the previous run, read
+    // here so startDayClock() does not touch flash from the control task.
+    scheduleTimers[kind].schedule = schedule;
+    scheduleTimers[kind].handledUntil = (time_t)preferences.getUInt(scheduleFiredKeys[kind], 0);
+  }
+  
+  LOG_INFO(LOG_SCHEDULE, "Cached schedules loaded - feeding: %d entries, water: %d entries",
+           (int)networkSchedules[SCHEDULE_FEEDING].count, (int)networkSchedules[SCHEDULE_WATER].count);
+}
+
+StreamRoute streamRoutes[] = {
+  {"controls", handleControlsData, CONTROL_POLL_FALLBACK_INTERVAL, 0},
+  {"feedingSettings", handleFeedingSettingsData, CONTROL_POLL_FALLBACK_INTERVAL, 0},
+  {"waterSettings", handleWaterSettingsData, CONTROL_POLL_FALLBACK_INTERVAL, 0},
+  {"feedingSchedule", handleFeedingScheduleData, SCHEDULE_CACHE_TTL, 0},
+  {"waterSchedule", handleWaterScheduleData, SCHEDULE_CACHE_TTL, 0},
+  {"config", handleConfigData, SCHEDULE_CACHE_TTL, 0},
+};
+const int STREAM_ROUTE_COUNT = sizeof(streamRoutes) / sizeof(streamRoutes[0]);
+
+// Open the control stream on the parent of all the nodes we watch
+void beginControlStream() {
+  controlStreamStarted = rtdbBeginStream(DEVICE_ROOT);
+  if (!controlStreamStarted) {
+    LOG_WARN(LOG_NETWORK, "Failed to start control stream: %s", streamErrorText);
+  }
+}
+
+// Route a put under DEVICE_ROOT to the node it touches. A put on "/"
+// replaces the whole tree, so every node gets its part ("null" if missing).
+void dispatchStreamPut(const char* path, const char* json) {
+  if (strcmp(path, "/") == 0) {
+    for (int i = 0; i < STREAM_ROUTE_COUNT; i++) {
+      const char* node = jsonMember(json, streamRoutes[i].node);
+      streamRoutes[i].handler("/", node != NULL ? node : "null");
+    }
+    return;
+  }
+  
+  for (int i = 0; i < STREAM_ROUTE_COUNT; i++) {
+    const StreamRoute& route = streamRoutes[i];
+    size_t length = strlen(route.node);
+    if (path[0] != '/' || strncmp(path + 1, route.node, length) != 0) continue;
     
-    // Update water filling status
-    Firebase.RTDB.setBool(&fbdo, "/deviceStates/isWaterFilling", isWaterFilling);
+    const char* rest = path + 1 + length;
+    if (*rest == '\0') {
+      route.handler("/", json);
+    } else if (*rest == '/') {
+      route.handler(rest, json);
+    }
+  }
+}
+
+// A patch only replaces the children it lists - deliver each one as a put
+void dispatchStreamPatch(const char* path, const char* json) {
+  JsonCursor cursor;
+  if (!jsonOpen(cursor, json) || cursor.array) return;
+  
+  char key[32];
+  char childPath[STREAM_PATH_SIZE];
+  const char* value;
+  while (jsonNext(cursor, key, sizeof(key), value)) {
+    snprintf(childPath, sizeof(childPath), "%s/%s", strcmp(path, "/") == 0 ? "" : path, key);
+    dispatchStreamPut(childPath, value);
+  }
+}
+
+// Read pending stream events - called on every network task pass so a
+// dashboard command reaches the control task as soon as it arrives
+void serviceControlStream() {
+  if (!controlStreamStarted) {
+    controlStreamStarted = rtdbBeginStream(DEVICE_ROOT);
+    if (!controlStreamStarted) {
+      controlStreamHealthy = false;
+      return;
+    }
+  }
+  
+  // readStream() reconnects by itself; after a reconnect the server
+  // replays the whole tree as a put on "/", which resyncs every node
+  StreamEvent event;
+  if (!rtdbReadStream(event)) {
+    if (controlStreamHealthy) {
+      LOG_WARN(LOG_NETWORK, "Control stream error: %s", streamErrorText);
+    }
+    controlStreamHealthy = false;
+    return;
+  }
+  if (!event.available) return;
+  
+  controlStreamHealthy = true;
+  if (event.patch) {
+    dispatchStreamPatch(event.path, event.data);
+  } else {
+    dispatchStreamPut(event.path, event.data);
+  }
+}
+
+// Fallback while the stream is down: fetch each node with one GET at its
+// own interval - controls every second, schedules and config far less often
+void pollControlChannelFallback() {
+  if (controlStreamHealthy) return;
+  
+  unsigned long currentMillis = halMillis();
+  for (int i = 0; i < STREAM_ROUTE_COUNT; i++) {
+    StreamRoute& route = streamRoutes[i];
+    if (route.lastPollTime != 0 && currentMillis - route.lastPollTime < route.pollInterval) continue;
+    route.lastPollTime = currentMillis;
     
-    // Update water consumption data
-    Firebase.RTDB.setInt(&fbdo, "/waterConsumption/totalToday", totalWaterToday);
-    Firebase.RTDB.setInt(&fbdo, "/waterConsumption/perBird", waterPerBird);
+    // A missing node comes back as "null", which the handlers treat as empty
+    char path[48];
+    snprintf(path, sizeof(path), "%s/%s", DEVICE_ROOT, route.node);
+    RtdbResponse response = rtdbGetJson(path);
+    if (response.ok) {
+      route.handler("/", response.payload);
+    }
   }
 }
 
-void updateHistory() {
-  unsigned long currentMillis = millis();
-  if (currentMillis - lastHistoryUpdate >= historyInterval) {
-    lastHistoryUpdate = currentMillis;
-
-    FirebaseJson historyData;
-    historyData.set("timestamp", time(NULL));
-    historyData.set("temperature", temperature);
-    historyData.set("humidity", humidity);
-    historyData.set("foodLevel", foodLevel);
-    historyData.set("waterLevelMain", waterLevelMain);
-    historyData.set("waterLevelDrinker", waterLevelDrinker);
-
-    String historyPath = "/history/" + String(time(NULL));
-    if (Firebase.RTDB.setJSON(&fbdo, historyPath.c_str(), &historyData)) {
-      Serial.println("History data added successfully");
+// Apply controls and settings handed over by the network task - runs on the control task
+void processInboundMessages() {
+  // A new configuration replaces the whole struct between ticks
+  DeviceConfig updatedConfig;
+  while (configQueue.pop(updatedConfig)) {
+    deviceConfig = updatedConfig;
+    refreshAlertThresholds();
+  }
+  
+  ScheduleUpdate scheduleUpdate;
+  while (scheduleQueue.pop(scheduleUpdate)) {
+    replaceSchedule(scheduleTimers[scheduleUpdate.kind], scheduleUpdate.schedule);
+  }
+  
+  CalibrationUpdate calibrationUpdate;
+  while (calibrationQueue.pop(calibrationUpdate)) {
+    if (calibrationUpdate.channel == 0) {
+      waterMainCalibration = calibrationUpdate.calibration;
     } else {
-      Serial.println("Failed to add history data");
-      Serial.println(fbdo.errorReason());
+      waterDrinkerCalibration = calibrationUpdate.calibration;
+    }
+  }
+  
+  InboundMessage message;
+  while (inboundQueue.pop(message)) {
+    switch (message.kind) {
+      case INBOUND_AUTOMATION:      requestedAutomation = message.intValue != 0; controlsChanged = true; break;
+      case INBOUND_FAN:             requestedFan = message.intValue != 0; controlsChanged = true; break;
+      case INBOUND_HEAT:            requestedHeat = message.intValue != 0; controlsChanged = true; break;
+      case INBOUND_PUMP:            requestedPump = message.intValue != 0; controlsChanged = true; break;
+      case INBOUND_FEED:            requestedFeed = message.intValue != 0; controlsChanged = true; break;
+      case INBOUND_FEED_DURATION:   requestedFeedDuration = message.floatValue; break;
+      case INBOUND_FEED_GRAMS:      requestedFeedGrams = message.floatValue; break;
+      case INBOUND_WATER_FILL:      requestedWaterFill = message.intValue != 0; controlsChanged = true; break;
+      case INBOUND_CONTROLS_SYNCED: controlsSynced = true; controlsChanged = true; break;
+      case INBOUND_AGE_GROUP:
+        copyField(currentAgeGroup, sizeof(currentAgeGroup), message.text);
+        LOG_INFO(LOG_CONFIG, "Age group updated: %s", currentAgeGroup);
+        break;
+      case INBOUND_CHICKEN_COUNT:
+        chickenCount = message.intValue;
+        LOG_INFO(LOG_CONFIG, "Chicken count updated: %d", chickenCount);
+        break;
+      case INBOUND_WATER_FLOW_RATE:     waterFlowRate = message.intValue; break;
+      case INBOUND_WATER_FILL_DURATION: waterFillDuration = message.intValue; break;
+      case INBOUND_AUTO_WATER:          autoWaterEnabled = message.intValue != 0; break;
     }
   }
 }
 
-void checkAndUpdateAlerts() {
-  // Check temperature alerts - high
-  bool highTemp = temperature > TEMP_HIGH_THRESHOLD;
-  if (highTemp && !highTempAlertActive) {
-    logEvent("highTemperature", "High temperature detected: " + String(temperature) + "°C");
-    highTempAlertActive = true;
-  } else if (!highTemp && highTempAlertActive) {
-    logEvent("resolved", "High temperature alert resolved: " + String(temperature) + "°C");
-    highTempAlertActive = false;
-  }
-  
-  // Check temperature alerts - low
-  bool lowTemp = temperature < TEMP_LOW_THRESHOLD;
-  if (lowTemp && !lowTempAlertActive) {
-    logEvent("lowTemperature", "Low temperature detected: " + String(temperature) + "°C");
-    lowTempAlertActive = true;
-  } else if (!lowTemp && lowTempAlertActive) {
-    logEvent("resolved", "Low temperature alert resolved: " + String(temperature) + "°C");
-    lowTempAlertActive = false;
-  }
-  
-  // Check food level alert
-  bool lowFood = foodLevel < FOOD_LOW_THRESHOLD;
-  if (lowFood && !lowFoodAlertActive) {
-    logEvent("lowFood", "Low food level detected: " + String(foodLevel) + "%");
-    lowFoodAlertActive = true;
-  } else if (!lowFood && lowFoodAlertActive) {
-    logEvent("resolved", "Low food level alert resolved: " + String(foodLevel) + "%");
-    lowFoodAlertActive = false;
-  }
-  
-  // Check main water tank alert
-  bool lowWaterMain = waterLevelMain < WATER_MAIN_LOW_THRESHOLD;
-  if (lowWaterMain && !lowWaterMainAlertActive) {
-    logEvent("lowWaterMain", "Low water level in main tank: " + String(waterLevelMain) + "%");
-    lowWaterMainAlertActive = true;
-  } else if (!lowWaterMain && lowWaterMainAlertActive) {
-    logEvent("resolved", "Main tank water level alert resolved: " + String(waterLevelMain) + "%");
-    lowWaterMainAlertActive = false;
-  }
-  
-  // Check drinker water level alert
-  bool lowWaterDrinker = waterLevelDrinker < WATER_DRINKER_LOW_THRESHOLD;
-  if (lowWaterDrinker && !lowWaterDrinkerAlertActive) {
-    logEvent("lowWaterDrinker", "Low water level in drinker: " + String(waterLevelDrinker) + "%");
-    lowWaterDrinkerAlertActive = true;
-  } else if (!lowWaterDrinker && lowWaterDrinkerAlertActive) {
-    logEvent("resolved", "Drinker water level alert resolved: " + String(waterLevelDrinker) + "%");
-    lowWaterDrinkerAlertActive = false;
-  }
-}
-
-// Modified checkManualControls function to log manual actions
+// Apply the cached dashboard controls - no network reads happen here
 void checkManualControls() {
-  if (Firebase.ready() && signupOK) {
-    // Check if automation is enabled
-    bool previousAutomation = automationEnabled;
-    if (Firebase.RTDB.getBool(&fbdo, "/controls/automationEnabled")) {
-      automationEnabled = fbdo.boolData();
-      Serial.print("Automation enabled: ");
-      Serial.println(automationEnabled);
-      
-      // Log automation mode change
-      if (previousAutomation != automationEnabled) {
-        if (automationEnabled) {
-          logEvent("system", "System switched to automatic mode");
-        } else {
-          logEvent("system", "System switched to manual mode");
-        }
-      }
+  // Nothing to apply until the first /controls snapshot has arrived
+  if (!controlsSynced) return;
+  
+  // Check if automation is enabled
+  bool previousAutomation = automationEnabled;
+  automationEnabled = requestedAutomation;
+  
+  // Log automation mode change
+  if (previousAutomation != automationEnabled) {
+    LOG_INFO(LOG_CONTROL, "Automation enabled: %d", automationEnabled);
+    logEvent(automationEnabled ? EVENT_AUTOMATIC_MODE : EVENT_MANUAL_MODE, {});
+  }
+  
+  // If automation is disabled, apply manual controls
+  if (!automationEnabled) {
+    // Fan control - dashboard commands skip the dwell times
+    unsigned long now = halMillis();
+    if (setClimateRelay(fanRelay, requestedFan, now, false)) {
+      logEvent(EVENT_FAN_MANUAL, {requestedFan});
+      LOG_INFO(LOG_CONTROL, "Fan state set to: %d", requestedFan);
     }
     
-    // If automation is disabled, check manual controls
-    if (!automationEnabled) {
-      Serial.println("Checking manual controls...");
-      
-      // Check fan control - FIXED
-      if (Firebase.RTDB.getBool(&fbdo, "/controls/fan")) {
-        bool newFanState = fbdo.boolData();
-        Serial.print("Fan control value from Firebase: ");
-        Serial.println(newFanState);
-        
-        // Log if state changed
-        if (fanState != newFanState) {
-          logEvent("manual", newFanState ? "Fan manually turned ON" : "Fan manually turned OFF");
-        }
-        
-        // Always update the state and relay regardless of previous state
-        fanState = newFanState;
-        digitalWrite(RELAY_FAN, !fanState); // Invert because relays are active LOW
-        Serial.print("Fan state set to: ");
-        Serial.println(fanState);
-      }
-      
-      // Check heat lamp control - FIXED
-      if (Firebase.RTDB.getBool(&fbdo, "/controls/heat")) {
-        bool newHeatState = fbdo.boolData();
-        Serial.print("Heat control value from Firebase: ");
-        Serial.println(newHeatState);
-        
-        // Log if state changed
-        if (heatState != newHeatState) {
-          logEvent("manual", newHeatState ? "Heat lamp manually turned ON" : "Heat lamp manually turned OFF");
-        }
-        
-        // Always update the state and relay regardless of previous state
-        heatState = newHeatState;
-        digitalWrite(RELAY_HEAT, !heatState); // Invert because relays are active LOW
-        Serial.print("Heat state set to: ");
-        Serial.println(heatState);
-      }
-      
-      // Check water pump control - FIXED
-      if (Firebase.RTDB.getBool(&fbdo, "/controls/pump")) {
-        bool newPumpState = fbdo.boolData();
-        Serial.print("Pump control value from Firebase: ");
-        Serial.println(newPumpState);
-        
-        // Log if state changed
-        if (pumpState != newPumpState) {
-          logEvent("manual", newPumpState ? "Water pump manually turned ON" : "Water pump manually turned OFF");
-        }
-        
-        // Always update the state and relay regardless of previous state
-        pumpState = newPumpState;
-        digitalWrite(RELAY_PUMP, !pumpState); // Invert because relays are active LOW
-        Serial.print("Pump state set to: ");
-        Serial.println(pumpState);
-      }
+    // Heat lamp control
+    if (setClimateRelay(heatRelay, requestedHeat, now, false)) {
+      logEvent(EVENT_HEAT_MANUAL, {requestedHeat});
+      LOG_INFO(LOG_CONTROL, "Heat state set to: %d", requestedHeat);
     }
     
-    // Check for intelligent feeding controls (these work regardless of automation mode)
-    checkIntelligentFeedingControls();
-    
-    // Check for water filling controls (these work regardless of automation mode)
-    checkWaterFillingControls();
+    // Water pump control (a running water fill owns the pump)
+    if (!isWaterFilling && pumpState != requestedPump) {
+      logEvent(EVENT_PUMP_MANUAL, {requestedPump});
+      LOG_INFO(LOG_CONTROL, "Pump state set to: %d", requestedPump);
+      pumpState = requestedPump;
+      halWriteRelay(RELAY_PUMP, pumpState);
+    }
   }
+  
+  // Check for intelligent feeding controls (these work regardless of automation mode)
+  checkIntelligentFeedingControls();
+  
+  // Check for water filling controls (these work regardless of automation mode)
+  checkWaterFillingControls();
 }
 
 // New function to check water filling controls
 void checkWaterFillingControls() {
-  unsigned long currentMillis = millis();
+  unsigned long currentMillis = halMillis();
   
   // Check if we're already filling water
   if (isWaterFilling) {
     // Check if we've been filling for too long (timeout)
-    if (currentMillis - waterFillStartTime > WATER_COMMAND_TIMEOUT) {
-      Serial.println("Water filling timeout reached - resetting water filling state");
-      isWaterFilling = false;
-      digitalWrite(RELAY_PUMP, HIGH); // Turn off pump (active LOW)
-      Firebase.RTDB.setBool(&fbdo, "/deviceStates/isWaterFilling", false);
-      Firebase.RTDB.setBool(&fbdo, "/controls/waterFill", false);
+    if (currentMillis - waterFillStartTime > waterPump.dispenseMillis + WATER_COMMAND_TIMEOUT) {
+      LOG_WARN(LOG_WATER, "Water filling timeout reached - resetting water filling state");
+      abortActuator(waterPump, closeWaterPump, currentMillis);
     }
     return; // Don't process new water fill commands while filling
   }
@@ -606,91 +4301,123 @@ void checkWaterFillingControls() {
     return;
   }
   
-  // Check for water fill command
-  if (Firebase.RTDB.getBool(&fbdo, "/controls/waterFill")) {
-    bool shouldFill = fbdo.boolData();
+  // Check for water fill command (water settings are kept current by the stream)
+  if (requestedWaterFill) {
+    // Consume the command locally; the remote flag is reset when the fill completes
+    requestedWaterFill = false;
     
-    // Only process if the command is true
-    if (shouldFill) {
-      Serial.println("Water fill command received");
-      
-      // Record the time we received the command
-      lastWaterCommandTime = currentMillis;
-      
-      // Set water filling flag to prevent multiple activations
-      isWaterFilling = true;
-      waterFillStartTime = currentMillis;
-      
-      // Update water filling state in Firebase
-      Firebase.RTDB.setBool(&fbdo, "/deviceStates/isWaterFilling", true);
-      
-      // Get water settings
-      if (Firebase.RTDB.getInt(&fbdo, "/waterSettings/fillDuration")) {
-        waterFillDuration = fbdo.intData();
-      }
-      
-      if (Firebase.RTDB.getInt(&fbdo, "/waterSettings/flowRate")) {
-        waterFlowRate = fbdo.intData();
-      }
-      
-      // Fill water
-      fillWater(waterFillDuration);
-      
-      // Reset the water fill control
-      Firebase.RTDB.setBool(&fbdo, "/controls/waterFill", false);
-      
-      // Set cooldown period to prevent rapid re-triggering (30 seconds)
-      waterFillCooldown = 30000;
-      
-      // Reset water filling flag
-      isWaterFilling = false;
-      Firebase.RTDB.setBool(&fbdo, "/deviceStates/isWaterFilling", false);
-    }
+    LOG_INFO(LOG_WATER, "Water fill command received");
+    
+    // Record the time we received the command
+    lastWaterCommandTime = currentMillis;
+    
+    // Update water filling state in Firebase
+    queueBoolWrite("/deviceStates/isWaterFilling", true);
+    
+    // Start filling - the pump state machine resets the control and
+    // applies a 30 second cooldown once the fill is complete
+    fillWater(deviceConfig.drinkerTarget, waterFillDuration, 30000, true);
   }
 }
 
-// Function to fill water
-void fillWater(int durationSeconds) {
-  Serial.print("Filling water for ");
-  Serial.print(durationSeconds);
-  Serial.println(" seconds");
-  
-  // Calculate volume based on flow rate
-  int volumeDispensed = durationSeconds * waterFlowRate;
-  
-  // Log water filling event BEFORE activating the pump
-  String description = "Dispensed " + String(volumeDispensed) + "ml of water";
-  logEvent("waterFilling", description);
-  
-  // Log water data for analytics
-  logWaterData(volumeDispensed, durationSeconds);
+// Refill the drinker up to targetLevel % (non-blocking - the pump is driven by
+// tickWaterPump()). maxSeconds bounds the fill if the level never gets there.
+// Returns FILL_STARTED, or why the pump was not started.
+FillRefusal fillWater(int targetLevel, int maxSeconds, unsigned long cooldownAfter, bool fromCommand) {
+  // Dry-run guard and nothing-to-do check before the pump starts
+  FillRefusal refusal = FILL_STARTED;
+  if (waterLevelMain < deviceConfig.waterMainLow) {
+    refusal = FILL_MAIN_LOW;
+  } else if (waterLevelDrinker >= targetLevel) {
+    refusal = FILL_DRINKER_FULL;
+  }
+  if (refusal != FILL_STARTED) {
+    LOG_INFO(LOG_WATER, "Water fill skipped - %s", refusal == FILL_MAIN_LOW ? "main tank low" : "drinker already full");
+    if (fromCommand) {
+      queueBoolWrite(DEVICE_ROOT "/controls/waterFill", false);
+      queueBoolWrite("/deviceStates/isWaterFilling", false);
+    }
+    return refusal;
+  }
   
-  // Turn on the pump
-  digitalWrite(RELAY_PUMP, LOW); // Active LOW
+  LOG_INFO(LOG_WATER, "Refilling drinker from %d%% to %d%% (at most %d s)", waterLevelDrinker, targetLevel, maxSeconds);
   
-  // Keep the pump on for the specified duration
-  delay(durationSeconds * 1000);
+  // Set water filling flag to prevent multiple activations
+  isWaterFilling = true;
+  waterFillStartTime = halMillis();
+  refillStartLevel = waterLevelDrinker;
+  refillTargetLevel = targetLevel;
+  refillStopReason = REFILL_TIME_LIMIT;
   
-  // Turn off the pump
-  digitalWrite(RELAY_PUMP, HIGH); // Active LOW (OFF)
+  startActuator(waterPump, (unsigned long)maxSeconds * 1000, cooldownAfter, fromCommand);
+  return FILL_STARTED;
+}
+
+// Stop a running fill once the target is reached or a guard trips
+void checkRefillProgress(unsigned long currentMillis) {
+  if (waterPump.phase != ACTUATOR_DISPENSING) return;
   
-  // Update last water fill time
-  lastWaterFillTime = millis();
+  if (waterLevelDrinker >= refillTargetLevel) {
+    refillStopReason = REFILL_TARGET_REACHED;
+  } else if (waterLevelMain < deviceConfig.waterMainLow) {
+    refillStopReason = REFILL_MAIN_LOW;
+  } else if (currentMillis - waterPump.phaseStartTime >= REFILL_RISE_TIMEOUT &&
+             waterLevelDrinker - refillStartLevel < REFILL_MIN_RISE) {
+    refillStopReason = REFILL_NOT_RISING;
+    logEvent(EVENT_PUMP_FAULT, {REFILL_RISE_TIMEOUT / 1000});
+  } else {
+    return;
+  }
+  abortActuator(waterPump, closeWaterPump, currentMillis);
+}
+
+void openWaterPump() {
+  pumpState = true;
+  halWriteRelay(RELAY_PUMP, true);
+}
+
+void closeWaterPump() {
+  pumpState = false;
+  halWriteRelay(RELAY_PUMP, false);
+}
+
+// Advance the pump state machine - called on every control task pass
+void tickWaterPump(unsigned long currentMillis) {
+  checkRefillProgress(currentMillis);
+  if (tickActuator(waterPump, openWaterPump, closeWaterPump, currentMillis)) {
+    // Book what the level says actually went in
+    int seconds = (currentMillis - waterFillStartTime) / 1000;
+    int volume = max(waterLevelDrinker - refillStartLevel, 0) * deviceConfig.drinkerCapacity / 100;
+    logEvent(EVENT_WATER_REFILLED, {volume, refillStartLevel, waterLevelDrinker, seconds, refillStopReason});
+    logWaterData(volume, seconds);
+    dailyHistory[0].waterRefilled += volume;
+    dailyHistory[0].refills++;
+    dailyHistoryDirty = true;
+    
+    // Update last water fill time and apply the cooldown
+    lastWaterFillTime = currentMillis;
+    waterFillCooldown = waterPump.cooldownAfter;
+    isWaterFilling = false;
+    
+    if (waterPump.resetControlOnDone) {
+      queueBoolWrite(DEVICE_ROOT "/controls/waterFill", false);
+    }
+    queueBoolWrite("/deviceStates/isWaterFilling", false);
+    LOG_INFO(LOG_WATER, "Water filling complete");
+  }
 }
 
 // New function to check intelligent feeding controls
 void checkIntelligentFeedingControls() {
-  unsigned long currentMillis = millis();
+  unsigned long currentMillis = halMillis();
   
   // Check if we're already feeding
   if (isFeeding) {
     // Check if we've been feeding for too long (timeout)
-    if (currentMillis - feedingStartTime > FEED_COMMAND_TIMEOUT) {
-      Serial.println("Feeding timeout reached - resetting feeding state");
-      isFeeding = false;
-      feederServo.write(SERVO_CLOSE_ANGLE); // Ensure servo is closed
-      Firebase.RTDB.setBool(&fbdo, "/deviceStates/isFeeding", false);
-      Firebase.RTDB.setBool(&fbdo, "/controls/feed", false);
+    if (currentMillis - feedingStartTime > feeder.dispenseMillis + FEED_COMMAND_TIMEOUT) {
+      LOG_WARN(LOG_FEED, "Feeding timeout reached - resetting feeding state");
+      feedDispense.stopRequested = true;
+      abortActuator(feeder, closeFeeder, currentMillis);
     }
     return; // Don't process new feed commands while feeding
   }
@@ -702,197 +4429,141 @@ void checkIntelligentFeedingControls() {
   }
   
   // Check for feed command - now works regardless of automation mode
-  if (Firebase.RTDB.getBool(&fbdo, "/controls/feed")) {
-    bool shouldFeed = fbdo.boolData();
+  if (requestedFeed) {
+    // Consume the command locally; the remote flag is reset when feeding completes
+    requestedFeed = false;
     
-    // Only process if the command is true
-    if (shouldFeed) {
-      Serial.println("Feed command received");
-      
-      // Record the time we received the command
-      lastFeedCommandTime = currentMillis;
-      
-      // Set feeding flag to prevent multiple activations
-      isFeeding = true;
-      feedingStartTime = currentMillis;
-      
-      // Update feeding state in Firebase
-      Firebase.RTDB.setBool(&fbdo, "/deviceStates/isFeeding", true);
-      
-      // Check if we have a custom feed duration
-      float customDuration = 0;
-      if (Firebase.RTDB.getFloat(&fbdo, "/controls/feedDuration")) {
-        customDuration = fbdo.floatData();
-        Serial.print("Custom feed duration: ");
-        Serial.println(customDuration);
-      }
+    LOG_INFO(LOG_FEED, "Feed command received");
+    
+    // Record the time we received the command
+    lastFeedCommandTime = currentMillis;
+    
+    // Update feeding state in Firebase
+    queueBoolWrite("/deviceStates/isFeeding", true);
+    
+    // Target mass: feedGrams from the dashboard, or a duration from an
+    // older client converted at the nominal rate it was computed with
+    float customGrams = requestedFeedGrams > 0 ? requestedFeedGrams
+                                               : requestedFeedDuration * deviceConfig.gramsPerSecond;
+    LOG_INFO(LOG_FEED, "Custom feed amount: %.1f", customGrams);
 
-      // Only proceed with feeding if we have a valid duration
-      if (customDuration > 0) {
-        // Use intelligent feeding with custom duration
-        activateFeederWithDuration(customDuration);
-
-        // Log the feed command details
-        Serial.print("Feed command executed with duration: ");
-        Serial.print(customDuration);
-        Serial.println(" seconds");
-      } else {
-        Serial.println("Feed command received but no valid duration provided");
-        // Use standard feeding based on current settings
-        activateFeeder();
-      }
-      
-      // Reset the feed control - IMPORTANT: This must happen AFTER feeding is complete
-      Firebase.RTDB.setBool(&fbdo, "/controls/feed", false);
-      
-      // Set cooldown period to prevent rapid re-triggering (30 seconds)
-      feedingCooldown = 30000;
-      
-      // Reset feeding flag
-      isFeeding = false;
-      Firebase.RTDB.setBool(&fbdo, "/deviceStates/isFeeding", false);
+    // The feeder state machine resets the feed control and applies a
+    // 30 second cooldown once the last pulse has been measured.
+    if (customGrams > 0) {
+      dispenseFeed(customGrams, 30000, true);
+    } else {
+      LOG_WARN(LOG_FEED, "Feed command received but no valid amount provided");
+      // Use standard feeding based on current settings
+      activateFeeder(30000, true);
     }
   }
+}
+
+// Switch a climate relay, writing the pin only when the state changes.
+// With respectDwell set the switch waits out the relay's minimum on/off
+// time. Returns true if the relay changed.
+bool setClimateRelay(ClimateRelay& relay, bool on, unsigned long now, bool respectDwell) {
+  if (*relay.state == on) return false;
+  if (respectDwell && relay.lastChange != 0) {
+    unsigned long dwell = *relay.state ? relay.minOnTime : relay.minOffTime;
+    if (now - relay.lastChange < dwell) return false;
+  }
   
-  // Check for feeding settings updates
-  if (Firebase.RTDB.getJSON(&fbdo, "/feedingSettings")) {
-    FirebaseJson *json = fbdo.jsonObjectPtr();
-    if (json != NULL) {
-      FirebaseJsonData result;
-      
-      // Get age group
-      json->get(result, "ageGroup");
-      if (result.success) {
-        currentAgeGroup = result.stringValue;
-        Serial.print("Age group updated: ");
-        Serial.println(currentAgeGroup);
-      }
-      
-      // Get chicken count
-      json->get(result, "chickenCount");
-      if (result.success && result.intValue > 0) {
-        chickenCount = result.intValue;
-        Serial.print("Chicken count updated: ");
-        Serial.println(chickenCount);
-      }
-    }
+  *relay.state = on;
+  halWriteRelay(relay.pin, on);
+  relay.lastChange = now;
+  relay.toggles++;
+  return true;
+}
+
+// Time-proportional heat: once per window the PI output picks how long the
+// lamp stays on. Windows too short to honour the dwell times round to all
+// off or all on.
+bool timeProportionalHeatDemand(unsigned long now) {
+  float error = deviceConfig.heatSetpoint - temperature;
+  if (heatPi.lastUpdate != 0) {
+    heatPi.integral += error * (now - heatPi.lastUpdate) / 1000.0;
+    heatPi.integral = constrain(heatPi.integral, 0, 1.0 / HEAT_KI); // Anti-windup
+  }
+  heatPi.lastUpdate = now;
+  
+  if (heatPi.windowStart == 0 || now - heatPi.windowStart >= HEAT_WINDOW) {
+    float duty = constrain(HEAT_KP * error + HEAT_KI * heatPi.integral, 0, 1);
+    unsigned long onTime = duty * HEAT_WINDOW;
+    if (onTime < HEAT_MIN_ON_TIME) onTime = 0;
+    else if (HEAT_WINDOW - onTime < HEAT_MIN_OFF_TIME) onTime = HEAT_WINDOW;
+    heatPi.windowStart = now;
+    heatPi.windowOnTime = onTime;
   }
+  return now - heatPi.windowStart < heatPi.windowOnTime;
 }
 
 void applyAutomation() {
-  Serial.println("Applying automation...");
-  Serial.print("Current temperature: ");
-  Serial.print(temperature);
-  Serial.print(" (High threshold: ");
-  Serial.print(TEMP_HIGH_THRESHOLD);
-  Serial.print(", Low threshold: ");
-  Serial.print(TEMP_LOW_THRESHOLD);
-  Serial.println(")");
-  
-  // Temperature control
-  if (temperature > TEMP_HIGH_THRESHOLD) {
-    Serial.println("Temperature above high threshold - turning fan ON, heat OFF");
-    // Too hot, turn on fan and turn off heat
-    bool previousFanState = fanState;
-    bool previousHeatState = heatState;
-    
-    fanState = true;
-    heatState = false;
+  // Temperature control - without current DHT readings the fan and heat
+  // lamp are left as they are rather than driven from a stale value
+  if (climateValid) {
+    unsigned long now = halMillis();
     
-    digitalWrite(RELAY_FAN, !fanState); // Invert because relays are active LOW
-    digitalWrite(RELAY_HEAT, !heatState); // Invert because relays are active LOW
+    // Fan: on above the high threshold, off once it has cooled through the band
+    bool fanDemand = fanState ? temperature > deviceConfig.tempHigh - deviceConfig.climateHysteresis
+                              : temperature > deviceConfig.tempHigh;
     
-    // Log state changes if needed
-    if (previousFanState != fanState) {
-      logEvent("automatic", "Fan automatically turned ON due to high temperature");
-    }
-    if (previousHeatState != heatState) {
-      logEvent("automatic", "Heat lamp automatically turned OFF due to high temperature");
-    }
-  } else if (temperature < TEMP_LOW_THRESHOLD) {
-    Serial.println("Temperature below low threshold - turning fan OFF, heat ON");
-    // Too cold, turn on heat and turn off fan
-    bool previousFanState = fanState;
-    bool previousHeatState = heatState;
-    
-    fanState = false;
-    heatState = true;
-    
-    digitalWrite(RELAY_FAN, !fanState); // Invert because relays are active LOW
-    digitalWrite(RELAY_HEAT, !heatState); // Invert because relays are active LOW
-    
-    // Log state changes if needed
-    if (previousFanState != fanState) {
-      logEvent("automatic", "Fan automatically turned OFF due to low temperature");
-    }
-    if (previousHeatState != heatState) {
-      logEvent("automatic", "Heat lamp automatically turned ON due to low temperature");
+    // Heat: on below the low threshold, off once it has warmed through the band
+    bool heatDemand;
+    if (deviceConfig.heatMode == HEAT_MODE_TIME_PROPORTIONAL) {
+      heatDemand = timeProportionalHeatDemand(now);
+    } else {
+      heatDemand = heatState ? temperature < deviceConfig.tempLow + deviceConfig.climateHysteresis
+                             : temperature < deviceConfig.tempLow;
     }
-  } else {
-    Serial.println("Temperature in acceptable range - turning fan OFF, heat OFF");
-    // Temperature is in the acceptable range, turn off both
-    bool previousFanState = fanState;
-    bool previousHeatState = heatState;
     
-    fanState = false;
-    heatState = false;
+    // Never heat and ventilate at once - the fan wins, without waiting out the lamp's dwell
+    if (fanDemand) heatDemand = false;
     
-    digitalWrite(RELAY_FAN, !fanState); // Invert because relays are active LOW
-    digitalWrite(RELAY_HEAT, !heatState); // Invert because relays are active LOW
-    
-    // Log state changes if needed
-    if (previousFanState != fanState) {
-      logEvent("automatic", "Fan automatically turned OFF - temperature in normal range");
+    if (setClimateRelay(heatRelay, heatDemand, now, !fanDemand)) {
+      logEvent(EVENT_HEAT_AUTO, {heatState, tenths(temperature), fanDemand});
     }
-    if (previousHeatState != heatState) {
-      logEvent("automatic", "Heat lamp automatically turned OFF - temperature in normal range");
+    if (setClimateRelay(fanRelay, fanDemand, now, true)) {
+      logEvent(EVENT_FAN_AUTO, {fanState, tenths(temperature)});
     }
   }
   
-  Serial.print("Water level drinker: ");
-  Serial.print(waterLevelDrinker);
-  Serial.print(" (Threshold: ");
-  Serial.print(WATER_DRINKER_LOW_THRESHOLD);
-  Serial.println(")");
-  Serial.print("Water level main: ");
-  Serial.print(waterLevelMain);
-  Serial.print(" (Threshold: ");
-  Serial.print(WATER_MAIN_LOW_THRESHOLD);
-  Serial.println(")");
-  
   // Water level control - only if not already filling water
   if (!isWaterFilling) {
     bool previousPumpState = pumpState;
     
-    if (waterLevelDrinker < WATER_DRINKER_LOW_THRESHOLD && waterLevelMain > WATER_MAIN_LOW_THRESHOLD) {
-      Serial.println("Drinker water low and main tank has water - turning pump ON");
-      // Drinker is low but main tank has water, turn on pump
-      pumpState = true;
-      digitalWrite(RELAY_PUMP, !pumpState); // Invert because relays are active LOW
-      
-      // Log pump activation
-      if (!previousPumpState) {
-        logEvent("automatic", "Water pump automatically activated to refill drinker");
-      }
-    } else {
-      Serial.println("Either drinker water sufficient or main tank empty - turning pump OFF");
-      // Either drinker is full or main tank is empty, turn off pump
-      if (pumpState) {
-        pumpState = false;
-        digitalWrite(RELAY_PUMP, !pumpState); // Invert because relays are active LOW
-        logEvent("automatic", "Water pump automatically deactivated");
+    bool coolingDown = waterFillCooldown > 0 && halMillis() - lastWaterFillTime < waterFillCooldown;
+    
+    if (waterLevelDrinker < deviceConfig.drinkerRefillLevel && waterLevelMain > deviceConfig.waterMainLow) {
+      // Drinker is low but main tank has water - refill it up to the target
+      if (!coolingDown) {
+        LOG_INFO(LOG_WATER, "Drinker water low and main tank has water - starting refill");
+        logEvent(EVENT_REFILL_AUTO, {waterLevelDrinker, deviceConfig.drinkerRefillLevel});
+        fillWater(deviceConfig.drinkerTarget, waterFillDuration, 10000, false);
       }
+    } else if (previousPumpState) {
+      LOG_WARN(LOG_WATER, "Pump left on outside a refill - turning pump OFF");
+      pumpState = false;
+      halWriteRelay(RELAY_PUMP, pumpState);
+      logEvent(EVENT_PUMP_AUTO_OFF, {});
     }
   }
 }
 
+// Age group as sent in events: 0 chick, 1 grower, 2 adult
+int ageGroupIndex() {
+  if (strcmp(currentAgeGroup, "chick") == 0) return 0;
+  if (strcmp(currentAgeGroup, "grower") == 0) return 1;
+  return 2;
+}
+
 // Calculate recommended feed amount based on age group and chicken count
 int calculateRecommendedFeedAmount() {
   int gramsPerChicken = 0;
   
-  if (currentAgeGroup == "chick") {
+  if (strcmp(currentAgeGroup, "chick") == 0) {
     gramsPerChicken = 50; // 50g per chick per day
-  } else if (currentAgeGroup == "grower") {
+  } else if (strcmp(currentAgeGroup, "grower") == 0) {
     gramsPerChicken = 100; // 100g per grower per day
   } else { // adult
     gramsPerChicken = 150; // 150g per adult per day
@@ -901,215 +4572,633 @@ int calculateRecommendedFeedAmount() {
   return gramsPerChicken * chickenCount;
 }
 
-// Calculate servo open time based on grams
-float calculateServoOpenTime(int grams) {
-  // Calibration: 1 second = 50g of feed at 45 degrees
-  return grams / GRAMS_PER_SECOND;
+// Feed in the hopper at a filtered ultrasonic distance - the configured
+// capacity spread evenly between the full and empty distances
+float hopperGrams(float distanceCm) {
+  float span = deviceConfig.foodEmptyCm - deviceConfig.foodFullCm;
+  float level = constrain(deviceConfig.foodEmptyCm - distanceCm, 0.0f, span);
+  return level * deviceConfig.hopperCapacity / span;
+}
+
+// Load the flow model learned by earlier dispenses
+void loadFeedModel() {
+  feedRate = preferences.getFloat("feedRate", deviceConfig.gramsPerSecond);
+  if (isnan(feedRate) || feedRate < FEED_RATE_MIN || feedRate > FEED_RATE_MAX) {
+    feedRate = deviceConfig.gramsPerSecond;
+  }
+  LOG_INFO(LOG_FEED, "Feed flow model: %.1f g/s", feedRate);
+}
+
+// Open the feeder for one pulse, remembering the level it started from
+void startFeedPulse(float seconds) {
+  unsigned long pulseMillis = max((unsigned long)(seconds * 1000), (unsigned long)FEED_MIN_PULSE_MS);
+  feedDispense.pulseSeconds = pulseMillis / 1000.0f;
+  feedDispense.totalSeconds += feedDispense.pulseSeconds;
+  feedDispense.levelBefore = distanceFilter.value;
+  feedDispense.pulses++;
+  feedingStartTime = halMillis();
+  startActuator(feeder, pulseMillis, feedDispense.cooldownAfter, feedDispense.resetControlOnDone);
 }
 
-// Activate feeder with intelligent feeding
-void activateFeederWithDuration(float duration) {
-  Serial.print("Activating feeder with duration: ");
-  Serial.print(duration);
-  Serial.println(" seconds");
+// Start dispensing targetGrams (non-blocking - the pulses are driven by tickFeeder())
+void dispenseFeed(float targetGrams, unsigned long cooldownAfter, bool fromCommand) {
+  unsigned long now = halMillis();
+  
+  feedDispense = {};
+  feedDispense.active = true;
+  feedDispense.targetGrams = targetGrams;
+  feedDispense.cooldownAfter = cooldownAfter;
+  feedDispense.resetControlOnDone = fromCommand;
+  feedDispense.closedLoop = filterFresh(distanceFilter, now) &&
+                            distanceFilter.value <= deviceConfig.foodEmptyCm;
+  feedDispense.levelStart = distanceFilter.value;
+  feedDispense.rate = feedRate;
   
-  // Calculate grams based on duration (50g per second)
-  int gramsDispensed = duration * GRAMS_PER_SECOND;
+  LOG_INFO(LOG_FEED, "Dispensing %.0fg of feed at %.1f g/s (%s)", targetGrams, feedRate,
+           feedDispense.closedLoop ? "closed loop" : "open loop - no hopper level");
   
-  // Log feeding event BEFORE activating the servo
-  String description = "Dispensed " + String(gramsDispensed) + "g of feed for " + 
-                      String(chickenCount) + " " + currentAgeGroup + " chickens";
-  logEvent("feeding", description);
+  // Set feeding flag to prevent multiple activations
+  isFeeding = true;
   
-  // Log feeding data for analytics
-  logFeedingData(gramsDispensed, currentAgeGroup, chickenCount);
+  float seconds = targetGrams / feedRate;
+  startFeedPulse(feedDispense.closedLoop ? seconds * FEED_FIRST_PULSE_SHARE : seconds);
+}
+
+// Credit the pulse that just ended and measure the flow rate. Returns true
+// if another pulse is needed to reach the target.
+bool measureFeedPulse(unsigned long now) {
+  float expected = feedDispense.pulseSeconds * feedDispense.rate;
+  
+  if (feedDispense.closedLoop && filterFresh(distanceFilter, now)) {
+    float moved = hopperGrams(feedDispense.levelBefore) - hopperGrams(distanceFilter.value);
+    float movedTotal = hopperGrams(feedDispense.levelStart) - hopperGrams(distanceFilter.value);
+    float resolution = FEED_LEVEL_RESOLUTION * deviceConfig.hopperCapacity /
+                       (deviceConfig.foodEmptyCm - deviceConfig.foodFullCm);
+    
+    if (movedTotal >= resolution && (moved >= resolution || expected < 2 * resolution)) {
+      // The whole dispense so far is measurable - credit it and time the
+      // next pulse on the rate it shows
+      feedDispense.rate = constrain(movedTotal / feedDispense.totalSeconds, FEED_RATE_MIN, FEED_RATE_MAX);
+      feedDispense.learned = true;
+      feedDispense.dispensedGrams = movedTotal;
+      feedDispense.emptyPulses = 0;
+    } else if (expected >= 2 * resolution) {
+      // Should have been visible - the hopper is empty or the chute is blocked
+      feedDispense.emptyPulses++;
+    } else {
+      // Too small for the sensor; trust the model
+      feedDispense.dispensedGrams += expected;
+    }
+  } else {
+    feedDispense.closedLoop = false;
+    feedDispense.dispensedGrams += expected;
+  }
   
-  // Open the servo for the specified duration
-  feederServo.write(SERVO_OPEN_ANGLE); // Open position (45 degrees)
-  delay(duration * 1000); // Convert seconds to milliseconds
-  feederServo.write(SERVO_CLOSE_ANGLE); // Close position (0 degrees)
+  float remaining = feedDispense.targetGrams - feedDispense.dispensedGrams;
+  return feedDispense.closedLoop && !feedDispense.stopRequested &&
+         remaining > FEED_TOLERANCE_GRAMS &&
+         feedDispense.pulses < FEED_MAX_PULSES &&
+         feedDispense.emptyPulses < FEED_MAX_EMPTY_PULSES;
+}
+
+// The last pulse is done - log what really left the hopper and apply the cooldown
+void finishFeeding(unsigned long currentMillis) {
+  int grams = lroundf(feedDispense.dispensedGrams);
+  
+  if (feedDispense.emptyPulses >= FEED_MAX_EMPTY_PULSES) {
+    logEvent(EVENT_FEEDER_FAULT, {feedDispense.emptyPulses});
+  }
+  logEvent(EVENT_FEEDING, {grams, chickenCount, ageGroupIndex()});
+  logFeedingData(grams, currentAgeGroup, chickenCount);
+  dailyHistory[0].feedGrams += grams;
+  dailyHistory[0].feedings++;
+  dailyHistoryDirty = true;
   
-  // Ensure the servo has time to close completely
-  delay(1000);
+  if (feedDispense.learned) {
+    feedRate = constrain(feedRate + FEED_RATE_ALPHA * (feedDispense.rate - feedRate), FEED_RATE_MIN, FEED_RATE_MAX);
+    queueNvsFloat("feedRate", feedRate);
+  }
+  LOG_INFO(LOG_FEED, "Feeding complete: %dg of %.0fg in %d pulses, model now %.1f g/s",
+           grams, feedDispense.targetGrams, feedDispense.pulses, feedRate);
   
-  // Update last feeding time
-  lastFeedingTime = millis();
+  // Update last feeding time and apply the cooldown
+  lastFeedingTime = currentMillis;
+  feedingCooldown = feedDispense.cooldownAfter;
+  isFeeding = false;
+  feedDispense.active = false;
   
-  // Double-check that the servo is closed
-  feederServo.write(SERVO_CLOSE_ANGLE);
+  // Reset the feed control only now that feeding is complete
+  if (feedDispense.resetControlOnDone) {
+    queueBoolWrite(DEVICE_ROOT "/controls/feed", false);
+  }
+  queueBoolWrite("/deviceStates/isFeeding", false);
 }
 
 // Original feeder activation function (for backward compatibility)
-void activateFeeder() {
-  Serial.println("Activating feeder with intelligent feeding");
+void activateFeeder(unsigned long cooldownAfter, bool fromCommand) {
+  LOG_INFO(LOG_FEED, "Activating feeder with intelligent feeding");
+  
+  // Dispense the recommended feed amount
+  dispenseFeed(calculateRecommendedFeedAmount(), cooldownAfter, fromCommand);
+}
+
+void openFeeder() {
+  halWriteServo(deviceConfig.servoOpenAngle); // Open position (45 degrees)
+}
+
+void closeFeeder() {
+  halWriteServo(deviceConfig.servoCloseAngle); // Close position (0 degrees)
+}
+
+// Advance the feeder state machine - called on every control task pass
+void tickFeeder(unsigned long currentMillis) {
+  if (tickActuator(feeder, openFeeder, closeFeeder, currentMillis)) {
+    // Double-check that the servo is closed
+    closeFeeder();
+    
+    // Give the feed and the level filter time to settle before measuring;
+    // an open-loop pulse has nothing to measure
+    feedDispense.measuring = true;
+    feedDispense.measureStart = currentMillis - (feedDispense.closedLoop ? 0 : FEED_MEASURE_DELAY);
+  }
   
-  // Calculate recommended feed amount
-  int recommendedGrams = calculateRecommendedFeedAmount();
+  if (feedDispense.measuring && currentMillis - feedDispense.measureStart >= FEED_MEASURE_DELAY) {
+    feedDispense.measuring = false;
+    if (measureFeedPulse(currentMillis)) {
+      startFeedPulse((feedDispense.targetGrams - feedDispense.dispensedGrams) / feedDispense.rate);
+    } else {
+      finishFeeding(currentMillis);
+    }
+  }
+}
+
+// Queue a dispense on an actuator; it opens on the next tick
+void startActuator(Actuator& actuator, unsigned long dispenseMillis, unsigned long cooldownAfter, bool resetControlOnDone) {
+  actuator.dispenseMillis = dispenseMillis;
+  actuator.cooldownAfter = cooldownAfter;
+  actuator.resetControlOnDone = resetControlOnDone;
+  actuator.phase = ACTUATOR_OPEN;
+  actuator.phaseStartTime = halMillis();
+}
+
+// Close an actuator immediately and let it settle as if the dispense had finished
+void abortActuator(Actuator& actuator, void (*closeFn)(), unsigned long currentMillis) {
+  if (actuator.phase == ACTUATOR_IDLE) return;
+  closeFn();
+  actuator.phase = ACTUATOR_CLOSING;
+  actuator.phaseStartTime = currentMillis;
+}
+
+// Advance one actuator by at most one phase. Returns true on the tick it settles.
+bool tickActuator(Actuator& actuator, void (*openFn)(), void (*closeFn)(), unsigned long currentMillis) {
+  switch (actuator.phase) {
+    case ACTUATOR_IDLE:
+      return false;
+      
+    case ACTUATOR_OPEN:
+      openFn();
+      actuator.phase = ACTUATOR_DISPENSING;
+      actuator.phaseStartTime = currentMillis;
+      return false;
+      
+    case ACTUATOR_DISPENSING:
+      if (currentMillis - actuator.phaseStartTime >= actuator.dispenseMillis) {
+        closeFn();
+        actuator.phase = ACTUATOR_CLOSING;
+        actuator.phaseStartTime = currentMillis;
+      }
+      return false;
+      
+    case ACTUATOR_CLOSING:
+      if (currentMillis - actuator.phaseStartTime >= actuator.settleMillis) {
+        actuator.phase = ACTUATOR_SETTLED;
+      }
+      return false;
+      
+    case ACTUATOR_SETTLED:
+      actuator.phase = ACTUATOR_IDLE;
+      return true;
+  }
+  return false;
+}
+
+// Find the first fire time after handledUntil. Only runs when a schedule
+// changes or an entry has been handled, not on every tick.
+void armSchedule(ScheduleTimer& timer) {
+  timer.nextFire = 0;
+  if (!clockReady || timer.schedule.count == 0) return;
   
-  // Calculate servo open time
-  float openTime = calculateServoOpenTime(recommendedGrams);
+  struct tm day;
+  localtime_r(&timer.handledUntil, &day);
+  day.tm_hour = 0;
+  day.tm_sec = 0;
+  day.tm_isdst = -1;
+  int today = day.tm_mday;
   
-  // Activate feeder with calculated duration
-  activateFeederWithDuration(openTime);
+  // Today's remaining entries, then tomorrow's first
+  for (int offset = 0; offset < 2; offset++) {
+    for (int i = 0; i < timer.schedule.count; i++) {
+      struct tm fire = day;
+      fire.tm_mday = today + offset;
+      fire.tm_min = timer.schedule.entries[i].minute;
+      time_t fireTime = mktime(&fire);
+      if (fireTime > timer.handledUntil) {
+        timer.nextFire = fireTime;
+        timer.nextMinute = timer.schedule.entries[i].minute;
+        timer.nextAmount = timer.schedule.entries[i].amount;
+        return;
+      }
+    }
+  }
 }
 
-// Improve the checkFeedingSchedule function to be more reliable
-void checkFeedingSchedule() {
-  time_t now;
-  struct tm timeinfo;
-  time(&now);
-  localtime_r(&now, &timeinfo);
+// A new schedule from the dashboard. Edits apply from now on - adding a
+// time that has just passed does not run it as a missed entry. An entry
+// that is already due but still waiting (feeder busy, cooldown) keeps its
+// place if the new schedule still has it.
+void replaceSchedule(ScheduleTimer& timer, const DailySchedule& schedule) {
+  time_t pendingFire = timer.nextFire;
+  uint16_t pendingMinute = timer.nextMinute;
+  timer.schedule = schedule;
+  if (!clockReady) return;
   
-  int currentHour = timeinfo.tm_hour;
-  int currentMinute = timeinfo.tm_min;
+  time_t now = halEpoch();
+  timer.handledUntil = max(timer.handledUntil, now);
+  armSchedule(timer);
   
-  // Check if we're in a cooldown period after feeding
-  unsigned long currentMillis = millis();
+  if (pendingFire == 0 || pendingFire > now) return;
+  for (int i = 0; i < schedule.count; i++) {
+    if (schedule.entries[i].minute == pendingMinute) {
+      timer.nextFire = pendingFire;
+      timer.nextMinute = pendingMinute;
+      timer.nextAmount = schedule.entries[i].amount;
+      return;
+    }
+  }
+}
+
+// The pending entry ran (or was skipped) - remember it across restarts and
+// move on. handledUntil may already be later if the schedule was edited
+// while the entry was waiting.
+void advanceSchedule(ScheduleKind kind) {
+  ScheduleTimer& timer = scheduleTimers[kind];
+  timer.handledUntil = max(timer.handledUntil, timer.nextFire);
+  queueNvsUInt(scheduleFiredKeys[kind], (uint32_t)timer.handledUntil);
+  armSchedule(timer);
+}
+
+// Returns true when the pending entry should run now. Entries that are
+// overdue by more than the grace window are skipped with an event.
+bool scheduleDue(ScheduleKind kind) {
+  ScheduleTimer& timer = scheduleTimers[kind];
+  time_t now = halEpoch();
+  
+  while (timer.nextFire != 0 && now >= timer.nextFire) {
+    if (now - timer.nextFire <= (time_t)SCHEDULE_CATCHUP_GRACE) return true;
+    logEvent(EVENT_SCHEDULE_MISSED, {kind, timer.nextMinute, (int32_t)((now - timer.nextFire) / 60)});
+    advanceSchedule(kind);
+  }
+  return false;
+}
+
+// Run the feeding schedule. The pending entry stays due while the feeder
+// is busy or cooling down, for up to the catch-up grace window.
+void checkFeedingSchedule() {
+  if (!scheduleDue(SCHEDULE_FEEDING)) return;
+  
+  // Check if we're feeding or in a cooldown period after feeding
+  unsigned long currentMillis = halMillis();
+  if (isFeeding) {
+    return;
+  }
   if (feedingCooldown > 0 && currentMillis - lastFeedingTime < feedingCooldown) {
     // Still in cooldown period, don't process scheduled feeding
     return;
   }
   
-  // Check for custom feeding schedule from Firebase
-  if (Firebase.ready() && signupOK) {
-    // Get feeding schedule JSON from Firebase
-    if (Firebase.RTDB.getJSON(&fbdo, "/feedingSchedule")) {
-      FirebaseJson *json = fbdo.jsonObjectPtr();
-      if (json != NULL) {
-        FirebaseJsonData result;
-        
-        // Check if current hour is scheduled for feeding
-        String hourKey = String(currentHour);
-        json->get(result, hourKey);
-        
-        // Only activate if we're in the first minute of the hour to prevent feeding on boot
-        if (result.success && result.to<bool>() == true && currentMinute == 0 && lastFeedingHour != currentHour) {
-          Serial.print("Scheduled feeding for hour ");
-          Serial.print(currentHour);
-          Serial.println(" triggered");
-          
-          // Use the current feeding settings from Intelligent Feeding Control
-          activateFeeder();
-          lastFeedingHour = currentHour;
-          lastFeedingTime = currentMillis;
-          feedingCooldown = 10000; // 10 second cooldown
-          
-          // Log the scheduled feeding event
-          logEvent("scheduledFeeding", "Scheduled feeding activated at hour " + String(currentHour));
-        }
-      }
-    }
-  }
+  ScheduleTimer& timer = scheduleTimers[SCHEDULE_FEEDING];
+  int lateMinutes = (halEpoch() - timer.nextFire) / 60;
+  LOG_INFO(LOG_SCHEDULE, "Scheduled feeding for %02d:%02d triggered", timer.nextMinute / 60, timer.nextMinute % 60);
   
-  // Reset lastFeedingHour if the hour has changed
-  if (lastFeedingHour != -1 && lastFeedingHour != currentHour) {
-    lastFeedingHour = -1;
+  // An entry without an amount uses the current feeding settings from
+  // Intelligent Feeding Control (10 second cooldown once the servo has closed)
+  if (timer.nextAmount > 0) {
+    dispenseFeed(timer.nextAmount, 10000, false);
+  } else {
+    activateFeeder(10000, false);
   }
+  
+  // Log the scheduled feeding event
+  logEvent(EVENT_SCHEDULED_FEEDING, {timer.nextMinute, lateMinutes});
+  advanceSchedule(SCHEDULE_FEEDING);
 }
 
-// Improve the checkWaterSchedule function to be more reliable
+// Run the water schedule - same rules as feeding, and only with auto water enabled
 void checkWaterSchedule() {
-  time_t now;
-  struct tm timeinfo;
-  time(&now);
-  localtime_r(&now, &timeinfo);
+  if (!scheduleDue(SCHEDULE_WATER)) return;
   
-  int currentHour = timeinfo.tm_hour;
-  int currentMinute = timeinfo.tm_min;
+  // Check if auto water is enabled - a disabled schedule does not pile up
+  if (!autoWaterEnabled) {
+    advanceSchedule(SCHEDULE_WATER);
+    return;
+  }
   
-  // Check if we're in a cooldown period after water filling
-  unsigned long currentMillis = millis();
+  // Check if we're filling or in a cooldown period after water filling
+  unsigned long currentMillis = halMillis();
+  if (isWaterFilling) {
+    return;
+  }
   if (waterFillCooldown > 0 && currentMillis - lastWaterFillTime < waterFillCooldown) {
     // Still in cooldown period, don't process scheduled water filling
     return;
   }
   
-  // Check if auto water is enabled
-  if (!autoWaterEnabled) {
-    return;
-  }
+  ScheduleTimer& timer = scheduleTimers[SCHEDULE_WATER];
+  LOG_INFO(LOG_SCHEDULE, "Scheduled water filling for %02d:%02d triggered", timer.nextMinute / 60, timer.nextMinute % 60);
   
-  // Check for custom water schedule from Firebase
-  if (Firebase.ready() && signupOK) {
-    // Get water schedule JSON from Firebase
-    if (Firebase.RTDB.getJSON(&fbdo, "/waterSchedule")) {
-      FirebaseJson *json = fbdo.jsonObjectPtr();
-      if (json != NULL) {
-        FirebaseJsonData result;
-        
-        // Check if current hour is scheduled for water filling
-        String hourKey = String(currentHour);
-        json->get(result, hourKey);
-        
-        // Only activate if we're in the first minute of the hour to prevent filling on boot
-        if (result.success && result.to<bool>() == true && currentMinute == 0 && lastWaterFillHour != currentHour) {
-          Serial.print("Scheduled water filling for hour ");
-          Serial.print(currentHour);
-          Serial.println(" triggered");
-          
-          // Fill water using current settings
-          fillWater(waterFillDuration);
-          lastWaterFillHour = currentHour;
-          lastWaterFillTime = currentMillis;
-          waterFillCooldown = 10000; // 10 second cooldown
-          
-          // Log the scheduled water filling event
-          logEvent("scheduledWaterFill", "Scheduled water filling activated at hour " + String(currentHour));
-        }
-      }
-    }
-  }
+  // Refill to the entry's level, or the configured target (10 second
+  // cooldown once the pump stops)
+  int target = timer.nextAmount > 0 ? min((int)timer.nextAmount, 100) : (int)deviceConfig.drinkerTarget;
+  FillRefusal refusal = fillWater(target, waterFillDuration, 10000, false);
   
-  // Reset lastWaterFillHour if the hour has changed
-  if (lastWaterFillHour != -1 && lastWaterFillHour != currentHour) {
-    lastWaterFillHour = -1;
+  // Log the scheduled water filling event - or why it did not run
+  if (refusal == FILL_STARTED) {
+    logEvent(EVENT_SCHEDULED_WATER, {timer.nextMinute});
+  } else {
+    logEvent(EVENT_SCHEDULED_WATER_SKIPPED, {timer.nextMinute, refusal});
   }
+  advanceSchedule(SCHEDULE_WATER);
 }
 
-void loop() {
-  unsigned long currentMillis = millis();
+// One pass of the control task: actuators, sensors, alerts and automation.
+// Never touches the network.
+void controlLoop() {
+  unsigned long currentMillis = halMillis();
+  
+  // Pick up anything the network task received
+  processInboundMessages();
+  
+  // Advance the feeder and pump state machines on every pass so
+  // dispensing never holds up the sensor/control tick
+  tickFeeder(currentMillis);
+  tickWaterPump(currentMillis);
+  
+  // Advance the interrupt-timed sensor measurements and the ADC pipeline
+  serviceSensorSampling(currentMillis);
+  serviceWaterLevelSampling();
+  
+  // Apply dashboard commands as soon as they arrive
+  if (controlsChanged) {
+    controlsChanged = false;
+    checkManualControls();
+  }
   
-  // Read sensors and update Firebase every interval
-  if (currentMillis - previousMillis >= interval) {
+  // Read sensors and run the control logic every interval - the first
+  // tick runs straight away so control starts right after boot
+  if (!firstControlTime || currentMillis - previousMillis >= interval) {
+#if PERF_PROFILING
+    unsigned long elapsed = currentMillis - previousMillis;
+    if (previousMillis != 0) {
+      perfRecord(PERF_TICK_LATENESS, (elapsed - interval) * 1000);
+      if (elapsed >= 2 * (unsigned long)interval) perfMissedTicks += elapsed / interval - 1;
+    }
+#endif
     previousMillis = currentMillis;
+    PERF_BEGIN();
     
     // Read sensors
     readSensors();
+    PERF_MARK(PERF_READ_SENSORS);
+    
+    // Book drinker intake since the last reading
+    updateWaterIntake(currentMillis);
+    if (currentMillis - lastHydrationCheck >= HYDRATION_CHECK_INTERVAL) {
+      lastHydrationCheck = currentMillis;
+      checkHydrationStatus();
+    }
+    
+    // Fold the readings into the current history interval
+    updateHistory();
+    PERF_SKIP();
       
     // Check and update alerts
     checkAndUpdateAlerts();
+    PERF_MARK(PERF_ALERTS);
     
-    // Update Firebase
-    updateFirebase();
-    
-    // Check for manual controls from Firebase
+    // Apply the cached dashboard controls
     checkManualControls();
+    PERF_MARK(PERF_MANUAL_CONTROLS);
     
     // Apply automation if enabled
     if (automationEnabled) {
       applyAutomation();
+      PERF_MARK(PERF_AUTOMATION);
     } else {
-      Serial.println("Automation disabled - using manual controls");
+      PERF_SKIP();
     }
     
-    // Check feeding schedule
-    checkFeedingSchedule();
+    // Schedules need the wall clock; until SNTP syncs only local control runs
+    if (!clockReady && halEpoch() >= (time_t)TIME_VALID_AFTER) {
+      startDayClock();
+    }
+    if (clockReady) {
+      // Check feeding schedule
+      checkFeedingSchedule();
+      PERF_MARK(PERF_FEEDING_SCHEDULE);
+      
+      // Check water schedule
+      checkWaterSchedule();
+      PERF_MARK(PERF_WATER_SCHEDULE);
+      
+      // Roll the daily totals over at local midnight
+      serviceDayRollover(halEpoch());
+    }
     
-    // Check water schedule
-    checkWaterSchedule();
+    // Hand this tick's values to the network task
+    publishTelemetrySnapshot();
+    PERF_TOTAL(PERF_CONTROL_TICK);
     
-    // Reset daily water counters at midnight
-    resetDailyWaterCounters();
+    if (!firstControlTime) {
+      firstControlTime = halMillis();
+      LOG_INFO(LOG_SYSTEM, "First control decision after %lu ms", firstControlTime);
+    }
   }
   
-  // Update history at separate intervals
-  updateHistory();
-  
   // Periodically check if the servo is in the correct position
-  if (currentMillis % 60000 == 0) { // Every minute
+  if (currentMillis - lastServoCheck >= 60000) { // Every minute
+    lastServoCheck = currentMillis;
     if (!isFeeding) {
       // Make sure servo is closed when not feeding
-      feederServo.write(SERVO_CLOSE_ANGLE);
+      halWriteServo(deviceConfig.servoCloseAngle);
     }
   }
 }
+
+// A bring-up step failed - go back to stage and try again after the backoff delay
+void retryBringUp(uint8_t stage, unsigned long now) {
+  networkStage = stage;
+  bringUpRetryTime = now + bringUpRetryDelay;
+  LOG_INFO(LOG_NETWORK, "Retrying network bring-up in %lu s", bringUpRetryDelay / 1000);
+  bringUpRetryDelay = min(bringUpRetryDelay * 2, (unsigned long)BRINGUP_RETRY_MAX);
+}
+
+// First contact with the database after boot: clear one-shot commands a
+// previous run may have left set, then open the control stream. Its first
+// event is a snapshot of every node, which replaces the values cached in
+// flash; the device states follow with the first (full) telemetry frame.
+void startCloudSession() {
+  beginFrame(diagnosticsFrame);
+  addFrameBool(diagnosticsFrame, "device/controls/feed", false);
+  addFrameBool(diagnosticsFrame, "device/controls/waterFill", false);
+  sendFrame(diagnosticsFrame);
+  
+  beginControlStream();
+}
+
+// Advance Wi-Fi, SNTP and Firebase by one step; true once the cloud is usable
+bool serviceNetworkBringUp() {
+  unsigned long now = halMillis();
+  char address[48];   // IP address or sign-up error
+  
+  // SNTP runs in the background once halBeginClock() has been called
+  if (!bootMetrics.clock && halEpoch() >= (time_t)TIME_VALID_AFTER) {
+    bootMetrics.clock = now;
+    LOG_INFO(LOG_NETWORK, "Clock synchronized");
+  }
+  
+  switch (networkStage) {
+    case NET_WIFI_START:
+      if ((long)(now - bringUpRetryTime) < 0) return false;
+      LOG_INFO(LOG_NETWORK, "Connecting to WiFi");
+      halBeginWifi();
+      bootMetrics.wifiAttempts++;
+      stageStartTime = now;
+      networkStage = NET_WIFI_WAIT;
+      return false;
+      
+    case NET_WIFI_WAIT:
+      if (!halWifiConnected()) {
+        if (now - stageStartTime >= WIFI_CONNECT_TIMEOUT) {
+          LOG_WARN(LOG_NETWORK, "WiFi connection timed out");
+          retryBringUp(NET_WIFI_START, now);
+        }
+        return false;
+      }
+      if (!bootMetrics.wifi) bootMetrics.wifi = now;
+      halLocalIp(address, sizeof(address));
+      LOG_INFO(LOG_NETWORK, "Connected with IP: %s", address);
+      halBeginClock();
+      bringUpRetryDelay = BRINGUP_RETRY_MIN;
+      networkStage = NET_SIGNUP;
+      return false;
+      
+    case NET_SIGNUP:
+      if (!halWifiConnected()) {
+        stageStartTime = now;
+        networkStage = NET_WIFI_WAIT;
+        return false;
+      }
+      if ((long)(now - bringUpRetryTime) < 0) return false;
+      
+      if (!signupOK) {
+        // Anonymous sign-in
+        bootMetrics.signupAttempts++;
+        if (!halCloudSignUp(address, sizeof(address))) {
+          LOG_ERROR(LOG_NETWORK, "❌ Firebase SignUp Failed: %s", address);
+          retryBringUp(NET_SIGNUP, now);
+          return false;
+        }
+        LOG_INFO(LOG_NETWORK, "✅ Firebase SignUp OK");
+        signupOK = true;
+        halCloudBegin();
+      }
+      
+      // Wait for the first token
+      if (!halCloudReady()) return false;
+      
+      startCloudSession();
+      bootMetrics.cloud = now;
+      networkStage = NET_READY;
+      LOG_INFO(LOG_NETWORK, "Cloud connection ready");
+      return true;
+      
+    default:
+      return true;
+  }
+}
+
+// Publish the boot timings once, after the first control tick and with the clock set
+void reportBootMetrics() {
+  if (bootMetrics.reported || !bootMetrics.clock || !firstControlTime) return;
+  bootMetrics.reported = true;
+  
+  LOG_INFO(LOG_SYSTEM, "Boot: first control %lu ms, WiFi %lu ms (%u attempts), clock %lu ms, cloud %lu ms (%u sign-ups)",
+           firstControlTime, bootMetrics.wifi, bootMetrics.wifiAttempts,
+           bootMetrics.clock, bootMetrics.cloud, bootMetrics.signupAttempts);
+  
+  beginFrame(diagnosticsFrame);
+  addFrameInt(diagnosticsFrame, "diagnostics/boot/firstControlMs", firstControlTime);
+  addFrameInt(diagnosticsFrame, "diagnostics/boot/wifiMs", bootMetrics.wifi);
+  addFrameInt(diagnosticsFrame, "diagnostics/boot/clockMs", bootMetrics.clock);
+  addFrameInt(diagnosticsFrame, "diagnostics/boot/cloudMs", bootMetrics.cloud);
+  addFrameInt(diagnosticsFrame, "diagnostics/boot/wifiAttempts", bootMetrics.wifiAttempts);
+  addFrameInt(diagnosticsFrame, "diagnostics/boot/signupAttempts", bootMetrics.signupAttempts);
+  addFrameInt(diagnosticsFrame, "diagnostics/boot/timestamp", halEpoch());
+  sendFrame(diagnosticsFrame);
+}
+
+// One pass of the network task: stream, telemetry, history and queued records
+void networkLoop() {
+  // Local work first so nothing is lost while offline
+  serviceSerialCommands();
+  receiveTelemetrySnapshots();
+  receiveOutboundRecords();
+  writeQueuedNvs();
+  
+  // Bring the connection up without blocking the rest of the pass
+  if (!serviceNetworkBringUp()) return;
+  
+  // halCloudReady() also refreshes the auth token, so call it every pass
+  if (!halCloudReady() || !signupOK) return;
+  
+  // Dashboard commands first - they are the latency-sensitive path
+  serviceControlStream();
+  pollControlChannelFallback();
+  
+  // Publish the newest telemetry snapshot once
+  if (latestTelemetryValid && !latestTelemetryPublished) {
+    latestTelemetryPublished = true;
+    PERF_BEGIN();
+    updateFirebase(latestTelemetry);
+    PERF_MARK(PERF_UPDATE_FIREBASE);
+  }
+  
+  // Events, logs, history and flag writes waiting in the outbox
+  drainOutbox();
+  
+  reportBootMetrics();
+  reportHeap();
+#if PERF_PROFILING
+  reportPerf();
+#endif
+}
+
+void controlTask(void* parameter) {
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    controlLoop();
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CONTROL_TASK_PERIOD_MS));
+  }
+}
+
+void networkTask(void* parameter) {
+  for (;;) {
+    networkLoop();
+    vTaskDelay(1); // Let the idle task run on this core
+  }
+}
+
+void loop() {
+  // All work happens in controlTask and networkTask
+  vTaskDelete(NULL);
+}
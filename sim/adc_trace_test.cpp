@@ -0,0 +1,63 @@
+// Replays a raw drinker trace through the ADC decimator and calibration
+// curve: the published level must be steady enough that it crosses the
+// refill threshold once, where mapping one raw block a second (the old
+// analogRead() path) crosses it again and again. Then the sketch picks a
+// calibration curve up from NVS, the same pipeline runs end to end and a
+// curve entered on the console replaces it.
+#include "harness.h"
+#include "traces/drinker_adc_trace.h"
+
+const int BLOCKS_PER_SECOND = 1000 / CONTROL_TASK_PERIOD_MS;
+
+// How often a series of levels crosses the refill threshold
+int thresholdCrossings(const std::vector<int>& levels) {
+  int crossings = 0;
+  for (size_t i = 1; i < levels.size(); i++) {
+    if ((levels[i - 1] < DRINKER_REFILL_LEVEL) != (levels[i] < DRINKER_REFILL_LEVEL)) crossings++;
+  }
+  return crossings;
+}
+
+int main() {
+  LevelCalibration calibration = waterDrinkerCalibration;
+  AdcDecimator decimator = {};
+  std::vector<int> filtered, single;
+  for (int i = 0; i < DRINKER_ADC_TRACE_LENGTH; i++) {
+    adcDecimatorPush(decimator, drinkerAdcTrace[i]);
+    if (i % BLOCKS_PER_SECOND == BLOCKS_PER_SECOND - 1) {
+      filtered.push_back(applyLevelCalibration(calibration, decimator.value));
+      single.push_back(applyLevelCalibration(calibration, (int32_t)drinkerAdcTrace[i] << 8));
+    }
+  }
+
+  int largestStep = 0;
+  for (size_t i = 1; i < filtered.size(); i++) {
+    largestStep = max(largestStep, abs(filtered[i] - filtered[i - 1]));
+  }
+  CHECK(largestStep <= 1);
+  CHECK(thresholdCrossings(filtered) == 1);
+  CHECK(thresholdCrossings(single) > 3);
+  CHECK_NEAR(filtered.front(), 33, 1);
+  CHECK_NEAR(filtered.back(), 27, 1);
+  printf("threshold crossings: filtered %d, single reads %d\n", thresholdCrossings(filtered), thresholdCrossings(single));
+
+  // A three-point curve saved over the serial console on an earlier boot
+  LevelCalibration saved = {3, {700, 1500, 2400}, {0, 60, 100}};
+  Preferences nvs;
+  nvs.begin(PREFERENCES_NAMESPACE, false);
+  nvs.putBytes("calDrinker", &saved, sizeof(saved));
+
+  simBarn.waterDrinkerRaw = 1100;
+  simBarn.pumpRawPerSecond = 0;
+  simBoot();
+  CHECK(waterDrinkerCalibration.count == 3);
+  simRun(3000);
+  CHECK(waterLevelDrinker == 30);   // 0 % + 400 / 800 of the way to 60 %
+
+  // A new curve from the console reaches the control task without a reboot
+  simSerialInput("cal drinker 700:0 1500:100\n");
+  simRun(3000);
+  CHECK(waterDrinkerCalibration.count == 2);
+  CHECK(waterLevelDrinker == 50);
+  return simFinish("adc_trace_test");
+}
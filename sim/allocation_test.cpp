@@ -0,0 +1,26 @@
+// Once the system has settled, the control and network loops should not
+// touch the heap: telemetry, stream events, outbox records and log lines
+// are all formatted into fixed buffers. operator new is counted for ten
+// simulated minutes of changing readings and dashboard commands; the host
+// platform's own allocations (RTDB fake, file system) are not counted.
+#include "harness.h"
+
+int main() {
+  simBoot();
+  CHECK(simRunUntil([] { return networkStage == NET_READY; }, 5000));
+  simRun(60000);
+
+  simCountAllocations(true);
+  for (int minute = 0; minute < 10; minute++) {
+    simBarn.temperature = 25 + minute % 4;
+    simBarn.humidity = 60 - minute;
+    simRtdb.set("/device/controls/fan", minute % 2 ? "true" : "false");
+    simRun(60000);
+  }
+  simCountAllocations(false);
+
+  CHECK(simAllocations() == 0);
+  CHECK(simRtdb.requests(RTDB_PATCH) > 10);
+  fprintf(stderr, "%lu allocations in 10 simulated minutes\n", simAllocations());
+  return simFinish("allocation_test");
+}
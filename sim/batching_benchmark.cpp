@@ -0,0 +1,39 @@
+// Batching over the one request session: a burst of records against the
+// in-process RTDB at 50 ms a request. Requests are serialized by design (no
+// session pool), so requests per second are capped by the latency; records
+// per second are not, because each request carries a whole outbox batch.
+#include "harness.h"
+
+int main() {
+  simBoot();
+  CHECK(simRunUntil([] { return networkStage == NET_READY && outboxHeader.count == 0; }, 5000));
+  simRun(2000);
+
+  const int seconds = 20;
+  const int perSecond = 100;
+  unsigned long start = simNow();
+  unsigned long requests = simRtdb.count;
+  uint16_t deepest = 0;
+  for (int i = 0; i < seconds * perSecond; i++) {
+    logEvent(EVENT_FEEDING, {i, 100, 2});
+    if (i % 10 == 9) {
+      simRun(1000 * 10 / perSecond);
+      deepest = max(deepest, outboxHeader.count);
+    }
+  }
+  CHECK(simRunUntil([] { return outboxHeader.count == 0; }, 10000));
+  double elapsed = (simNow() - start) / 1000.0;
+  unsigned long sent = simRtdb.count - requests;
+
+  double requestRate = sent / elapsed;
+  double recordRate = seconds * perSecond / elapsed;
+  printf("%d records in %lu requests over %.1f s: %.1f requests/s, %.1f records/s (%.1f per request), outbox peak %u\n",
+         seconds * perSecond, sent, elapsed, requestRate, recordRate, recordRate / requestRate, deepest);
+
+  CHECK(requestRate <= 1000.0 / simRtdb.latency);   // One request at a time on the one session
+  CHECK(recordRate >= 0.9 * perSecond);             // Kept up with the burst...
+  CHECK(recordRate >= 4 * 1000.0 / simRtdb.latency); // ...which one write per request could not
+  CHECK(deepest < OUTBOX_CAPACITY / 2);
+  CHECK(simRtdb.failures == 0);
+  return simFinish("batching_benchmark");
+}
@@ -0,0 +1,61 @@
+// Synthetic-day benchmark for the climate controller: 24 h of virtual time
+// with a daily swing through both thresholds plus sensor noise. Prints how
+// often the fan and heat relays switched and how many climate events were
+// written, and fails if the hysteresis and dwell times let them chatter.
+#include "harness.h"
+
+// Climate events (fan/heat automation) in the database, and the occurrences
+// their aggregated records stand for
+void countClimateEvents(int& records, long& occurrences) {
+  std::string events = simRtdb.value("/events");
+  records = 0;
+  occurrences = 0;
+  for (int code : {EVENT_FAN_AUTO, EVENT_HEAT_AUTO}) {
+    char pattern[16];
+    snprintf(pattern, sizeof(pattern), "\"code\":%d,", code);
+    for (size_t at = events.find(pattern); at != std::string::npos; at = events.find(pattern, at + 1)) {
+      // The fake serializes keys in order, so an aggregate's count follows its code
+      const char* next = events.c_str() + at + strlen(pattern);
+      records++;
+      occurrences += strncmp(next, "\"count\":", 8) == 0 ? atol(next + 8) : 1;
+    }
+  }
+}
+
+int main() {
+  simScheduler.networkPeriod = 100;   // Nothing here depends on the network's pace
+  simBoot();
+  CHECK(simRunUntil([] { return networkStage == NET_READY; }, 5000));
+  unsigned long fanWrites = simBarn.relayWrites[0];
+  unsigned long heatWrites = simBarn.relayWrites[1];
+
+  // 28 °C +/- 6 °C over the day, coldest at 04:00, with +/-0.4 °C of noise
+  // on every reading: the fan threshold (32 °C) and the heat threshold
+  // (24 °C) are each crossed once up and once down, noisily
+  uint32_t noise = 1;
+  const unsigned long day = 24UL * 3600;
+  for (unsigned long second = 0; second < day; second++) {
+    noise = noise * 1664525 + 1013904223;
+    float jitter = ((noise >> 8) % 801) / 1000.0f - 0.4f;
+    simBarn.temperature = 28 - 6 * cos(2 * M_PI * (second + 8 * 3600) / day) + jitter;
+    simRun(1000);
+  }
+  simRun(10000);   // Let the last events go out
+
+  int records;
+  long occurrences;
+  countClimateEvents(records, occurrences);
+  printf("24 h: fan %lu toggles, heat %lu toggles, %d climate event writes for %ld switch events\n",
+         fanRelay.toggles, heatRelay.toggles, records, occurrences);
+
+  // One warm and one cold spell: each relay switches on and off once, and
+  // the noise around the thresholds adds at most another cycle
+  CHECK(fanRelay.toggles >= 2 && fanRelay.toggles <= 4);
+  CHECK(heatRelay.toggles >= 2 && heatRelay.toggles <= 4);
+  CHECK(simBarn.relayWrites[0] - fanWrites == fanRelay.toggles);    // Relays only written on a change
+  CHECK(simBarn.relayWrites[1] - heatWrites == heatRelay.toggles);
+  CHECK(occurrences == (long)(fanRelay.toggles + heatRelay.toggles));
+  CHECK(records <= occurrences);
+  CHECK(simScheduler.maxControlPass == 0);
+  return simFinish("climate_day_benchmark");
+}
@@ -0,0 +1,23 @@
+// Records made before SNTP syncs stay in RAM and are filed on the wall
+// clock once it is set; event keys carry the boot number.
+#include "harness.h"
+
+int main() {
+  Preferences nvs;
+  nvs.begin(PREFERENCES_NAMESPACE, false);
+  nvs.putUInt("boots", 41);
+
+  simBarn.virtualEpoch = 0;   // SNTP has not synced: halEpoch() is the uptime
+  simBoot();
+  CHECK(bootNumber == 42);
+  simRun(20000);
+  CHECK(clockHeldCount > 0);
+  CHECK(outboxHeader.count == 0);
+
+  // Sync: the clock now says the device booted at 1700000000
+  simBarn.virtualEpoch = 1700000000;
+  simRun(5000);
+  CHECK(clockHeldCount == 0);
+  CHECK(simRtdb.value("/events/1700000000-0042-000000/code") == std::to_string(EVENT_SYSTEM_STARTED));
+  return simFinish("clock_hold_test");
+}
@@ -0,0 +1,64 @@
+// Replies to serial commands go through the log ring as the console module:
+// whole lines only, no log prefix, and a long perf report is paced over
+// several network passes instead of overrunning the ring and rate limit.
+#include "harness.h"
+
+// Split the captured serial output into lines
+std::vector<std::string> serialLines() {
+  std::string text = simSerialTake();
+  std::vector<std::string> lines;
+  for (size_t start = 0, end; start < text.size(); start = end + 1) {
+    end = text.find('\n', start);
+    if (end == std::string::npos) end = text.size();
+    lines.push_back(text.substr(start, end - start));
+  }
+  return lines;
+}
+
+bool hasLine(const std::vector<std::string>& lines, const std::string& wanted) {
+  for (const std::string& line : lines) {
+    if (line == wanted) return true;
+  }
+  return false;
+}
+
+int main() {
+  simBoot();
+  CHECK(simRunUntil([] { return networkStage == NET_READY; }, 5000));
+  simRun(30000);   // Fill the histograms
+  simSerialTake();
+
+  // The report is longer than one second's rate budget, so it takes a few
+  simSerialInput("perf\n");
+  simRun(100);
+  CHECK(perfReportPhase != -2);
+  CHECK(simRunUntil([] { return perfReportPhase == -2; }, 30000));
+  simRun(100);
+  std::vector<std::string> lines = serialLines();
+  CHECK(hasLine(lines, "Perf: " + std::to_string(perfMissedTicks) + " missed ticks"));
+  int phases = 0, buckets = 0;
+  for (const std::string& line : lines) {
+    CHECK(line.find("log lines dropped") == std::string::npos);
+    for (int phase = 0; phase < PERF_PHASE_COUNT; phase++) {
+      if (line.compare(0, strlen(perfPhaseNames[phase]) + 1, std::string(perfPhaseNames[phase]) + " ") == 0) phases++;
+    }
+    if (line.compare(0, 6, "  us>=") == 0) {
+      CHECK(line.size() < LOG_LINE_SIZE);
+      buckets++;
+    }
+  }
+  CHECK(phases == PERF_PHASE_COUNT);
+  CHECK(buckets >= PERF_PHASE_COUNT / 2);
+
+  // Short replies: whole lines without the "millis level module:" prefix
+  simSerialInput("cal\nlog\nlog nothing 2\nfrobnicate\n");
+  simRun(1000);
+  lines = serialLines();
+  CHECK(hasLine(lines, "main: 600:0 2800:100"));
+  CHECK(hasLine(lines, "sys      I"));
+  CHECK(hasLine(lines, "store    I"));
+  CHECK(!hasLine(lines, "console  I"));
+  CHECK(hasLine(lines, "Unknown log module: nothing"));
+  CHECK(hasLine(lines, "Unknown command: frobnicate"));
+  return simFinish("console_test");
+}
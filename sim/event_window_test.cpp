@@ -0,0 +1,75 @@
+// Event suppression keys on the transition, not just the code: a raise
+// after its own resolve always goes out, identical repeats inside a window
+// are folded into one summary, and that summary is sent before the state
+// changes rather than when the window runs out.
+#include "harness.h"
+
+// The test's events in database order as "code:marker" or "code:markerxN"
+// for summaries. Markers are values from 7000 to 7999, so events the sketch
+// raises on its own are left out.
+std::string testEvents() {
+  std::string events = simRtdb.value("/events");
+  std::string result;
+  for (size_t at = events.find("\"code\":"); at != std::string::npos;) {
+    size_t next = events.find("\"code\":", at + 1);
+    std::string event = events.substr(at, next == std::string::npos ? std::string::npos : next - at);
+    at = next;
+    
+    int code = atoi(event.c_str() + 7);
+    int marker = 0;
+    for (size_t v = event.find("\":", event.find("\"v\":{") + 5); v != std::string::npos && !marker; v = event.find("\":", v + 2)) {
+      int value = atoi(event.c_str() + v + 2);
+      if (value >= 7000 && value < 8000) marker = value;
+    }
+    if (!marker) continue;
+    size_t count = event.find("\"count\":");
+    char entry[32];
+    if (count != std::string::npos) {
+      snprintf(entry, sizeof(entry), "%s%d:%dx%d", result.empty() ? "" : " ", code, marker, atoi(event.c_str() + count + 8));
+    } else {
+      snprintf(entry, sizeof(entry), "%s%d:%d", result.empty() ? "" : " ", code, marker);
+    }
+    result += entry;
+  }
+  return result;
+}
+
+int main() {
+  simBoot();
+  CHECK(simRunUntil([] { return networkStage == NET_READY && outboxHeader.count == 0; }, 5000));
+
+  // Raise, resolve, raise inside one 300 s window: all three go out
+  logEvent(EVENT_HIGH_TEMPERATURE, {7001, 320});
+  simRun(2000);
+  logEvent(EVENT_HIGH_TEMPERATURE_RESOLVED, {7002});
+  simRun(2000);
+  logEvent(EVENT_HIGH_TEMPERATURE, {7003, 320});
+  simRun(2000);
+  CHECK(testEvents() == "10:7001 11:7002 10:7003");
+
+  // Repeats of the raise are held, then summarized ahead of the resolve
+  logEvent(EVENT_HIGH_TEMPERATURE, {7004, 320});
+  simRun(2000);
+  logEvent(EVENT_HIGH_TEMPERATURE, {7005, 320});
+  simRun(2000);
+  CHECK(testEvents() == "10:7001 11:7002 10:7003");
+  logEvent(EVENT_HIGH_TEMPERATURE_RESOLVED, {7006});
+  simRun(2000);
+  CHECK(testEvents() == "10:7001 11:7002 10:7003 10:7005x2 11:7006");
+
+  // On/off automation codes are limited per state
+  logEvent(EVENT_REFILL_AUTO, {7010});
+  simRun(2000);
+  logEvent(EVENT_REFILL_AUTO, {7011});
+  simRun(2000);
+  logEvent(EVENT_FAN_AUTO, {1, 7020});
+  simRun(2000);
+  logEvent(EVENT_FAN_AUTO, {0, 7021});
+  simRun(2000);
+  logEvent(EVENT_FAN_AUTO, {1, 7022});
+  simRun(2000);
+  logEvent(EVENT_FAN_AUTO, {1, 7023});
+  simRun(2000);
+  CHECK(testEvents() == "10:7001 11:7002 10:7003 10:7005x2 11:7006 52:7010 50:7020 50:7021 50:7022");
+  return simFinish("event_window_test");
+}
@@ -0,0 +1,42 @@
+// Closed-loop dispensing against a feeder that runs slower than its nominal
+// rate: every feeding lands within FEED_TOLERANCE_GRAMS of the target, the
+// flow model converges on the real rate, and the learned rate is saved.
+#include "harness.h"
+
+// Ask for grams from the dashboard and wait for the feeding to finish;
+// returns what really left the hopper
+float feed(int grams) {
+  float before = simBarn.feedDispensedGrams;
+  simRtdb.set("/device/controls/feedGrams", std::to_string(grams).c_str());
+  simRtdb.set("/device/controls/feed", "true");
+  CHECK(simRunUntil([] { return isFeeding; }, 2000));
+  CHECK(simRunUntil([] { return !isFeeding; }, 60000));
+  simRun(31000);   // Past the cooldown
+  return simBarn.feedDispensedGrams - before;
+}
+
+int main() {
+  simBarn.feedFlowRate = 0.7f * GRAMS_PER_SECOND;   // Damp feed: 35 g/s, not 50
+  simBarn.foodDistanceCm = FOOD_FULL_DISTANCE;
+  simBoot();
+  CHECK(simRunUntil([] { return networkStage == NET_READY; }, 5000));
+  simRun(5000);
+
+  // Feedings above the level sensor's resolution (FEED_LEVEL_RESOLUTION,
+  // 100 g here) are measured; the last one is too small to see and lands
+  // on the target only because the model has learned the real rate by then
+  const int targets[] = {200, 150, 300, 250, 200, 100};
+  for (int target : targets) {
+    float dispensed = feed(target);
+    printf("target %d g: dispensed %.1f g, model %.1f g/s\n", target, dispensed, feedRate);
+    CHECK_NEAR(dispensed, target, FEED_TOLERANCE_GRAMS);
+  }
+  CHECK_NEAR(feedRate, simBarn.feedFlowRate, 0.1 * simBarn.feedFlowRate);
+
+  // The network task saved the learned rate for the next boot
+  simRun(1000);
+  Preferences nvs;
+  nvs.begin(PREFERENCES_NAMESPACE, true);
+  CHECK_NEAR(nvs.getFloat("feedRate", 0), feedRate, 0.01);
+  return simFinish("feed_accuracy_test");
+}
@@ -0,0 +1,39 @@
+// A dashboard water fill runs as a state machine next to the control tick:
+// while the pump is on, the sensors are still read, the climate control
+// still acts and telemetry still reaches the database every second.
+#include "harness.h"
+
+int main() {
+  simBarn.pumpRawPerSecond = 5;   // Too slow to reach the target: the fill runs to its time limit
+  simBoot();
+  CHECK(simRunUntil([] { return networkStage == NET_READY; }, 5000));
+  simRun(5000);
+
+  simRtdb.set("/device/controls/waterFill", "true");
+  CHECK(simRunUntil([] { return isWaterFilling; }, 1000));
+  unsigned long fillStarted = simNow();
+  CHECK(simRunUntil([] { return simBarn.relayOn[2]; }, 100));
+  CHECK(simRunUntil([] { return simRtdb.value("/deviceStates/isWaterFilling") == "true"; }, 2000));
+
+  // Warm the barn up mid-fill: over the next DHT samples the filtered
+  // reading climbs, the fan starts and the alert is published, all while
+  // the pump is still running
+  unsigned long frames = telemetryFramesSent;
+  unsigned long passes = simScheduler.controlPasses;
+  simBarn.temperature = 34;
+  CHECK(simRunUntil([] { return atof(simRtdb.value("/sensors/temperature").c_str()) > 33; }, 25000));
+  CHECK(simBarn.relayOn[0]);
+  CHECK(simRunUntil([] { return simRtdb.value("/alerts/highTemperature") == "true"; }, 2000));
+  CHECK(isWaterFilling);
+
+  unsigned long elapsed = simNow() - fillStarted;
+  CHECK(telemetryFramesSent - frames >= 5);
+  CHECK(simScheduler.controlPasses - passes >= elapsed / CONTROL_TASK_PERIOD_MS - 2);
+  CHECK(simScheduler.maxControlPass == 0);   // The control task never blocked
+
+  // The time limit ends the fill and the dashboard hears about it
+  CHECK(simRunUntil([] { return !isWaterFilling; }, (unsigned long)waterFillDuration * 1000));
+  CHECK(!simBarn.relayOn[2]);
+  CHECK(simRunUntil([] { return simRtdb.value("/deviceStates/isWaterFilling") == "false"; }, 2000));
+  return simFinish("fill_telemetry_test");
+}
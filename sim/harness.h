@@ -0,0 +1,114 @@
+// Host harness for the sketch. Each test is one executable that includes
+// this header, which compiles microcontroller-code.cpp (with the Arduino
+// prototypes added by sketch_prototypes.py) against sim/host_platform.h.
+//
+// By default the tasks do not run as threads: simRun() steps the control,
+// network and log loops in virtual time. The control loop runs every
+// CONTROL_TASK_PERIOD_MS, the log task every LOG_DRAIN_INTERVAL and the
+// network loop whenever it is free - a pass that waited on the database
+// (simRtdb latency) keeps the network task busy for that long while the
+// control loop carries on, as it does on the two cores. simEnableThreads()
+// before simBoot() starts real std::threads on the wall clock instead.
+#pragma once
+
+#include "sketch_host.cpp"
+
+#include <unistd.h>
+
+struct SimScheduler {
+  unsigned long nextControl;
+  unsigned long networkFreeAt;
+  unsigned long nextLog;
+  unsigned long networkPeriod;     // Idle network pass spacing (the task's vTaskDelay)
+  unsigned long controlPasses;
+  unsigned long networkPasses;
+  unsigned long maxControlPass;    // ms of virtual time the slowest pass blocked for
+  unsigned long maxNetworkPass;
+};
+
+#define SIM_BOOT_MILLIS 300   // Roughly when setup() starts after an ESP32 reset
+
+SimScheduler simScheduler = {0, 0, 0, 1, 0, 0, 0, 0};
+int simFailures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      simFailures++; \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+  do { \
+    double simActual = (actual), simExpected = (expected); \
+    if (fabs(simActual - simExpected) > (tolerance)) { \
+      simFailures++; \
+      fprintf(stderr, "%s:%d: CHECK_NEAR failed: %s = %g, expected %g +/- %g\n", __FILE__, __LINE__, \
+              #actual, simActual, simExpected, (double)(tolerance)); \
+    } \
+  } while (0)
+
+// Run setup() at the current virtual time (SIM_BOOT_MILLIS on a fresh
+// clock). SIM_VERBOSE=1 echoes serial output.
+void simBoot() {
+  simSerialEcho(getenv("SIM_VERBOSE") != NULL);
+  if (simNow() < SIM_BOOT_MILLIS) simSetNow(SIM_BOOT_MILLIS);
+  setup();
+  unsigned long now = simNow();
+  simScheduler.nextControl = now;
+  simScheduler.networkFreeAt = now;
+  simScheduler.nextLog = now;
+}
+
+// Advance virtual time by duration ms, running each loop when it is due
+void simRun(unsigned long duration) {
+  unsigned long end = simNow() + duration;
+  while (simNow() < end) {
+    unsigned long now = simNow();
+    if (now >= simScheduler.nextControl) {
+      simBeginPass();
+      controlLoop();
+      unsigned long spent = simEndPass();
+      simScheduler.maxControlPass = max(simScheduler.maxControlPass, spent);
+      simScheduler.controlPasses++;
+      // vTaskDelayUntil: a late pass starts the next one straight away
+      simScheduler.nextControl += CONTROL_TASK_PERIOD_MS;
+      if (simScheduler.nextControl < now + spent) simScheduler.nextControl = now + spent;
+    }
+    if (now >= simScheduler.networkFreeAt) {
+      simBeginPass();
+      networkLoop();
+      unsigned long spent = simEndPass();
+      simScheduler.maxNetworkPass = max(simScheduler.maxNetworkPass, spent);
+      simScheduler.networkPasses++;
+      simScheduler.networkFreeAt = now + spent + simScheduler.networkPeriod;
+    }
+    if (now >= simScheduler.nextLog) {
+      drainLog();
+      simScheduler.nextLog += LOG_DRAIN_INTERVAL;
+    }
+    unsigned long next = min(min(simScheduler.nextControl, simScheduler.networkFreeAt), simScheduler.nextLog);
+    simSetNow(min(max(next, now + 1), end));
+  }
+}
+
+// Run until condition holds or timeout ms have passed; true if it held
+template <typename Condition>
+bool simRunUntil(Condition condition, unsigned long timeout) {
+  unsigned long end = simNow() + timeout;
+  while (!condition()) {
+    if (simNow() >= end) return false;
+    simRun(CONTROL_TASK_PERIOD_MS);
+  }
+  return true;
+}
+
+// Report and leave without running static destructors, which detached task
+// threads may still be using
+int simFinish(const char* name) {
+  fprintf(stderr, "%s: %s\n", name, simFailures == 0 ? "passed" : "FAILED");
+  fflush(stdout);
+  fflush(stderr);
+  _exit(simFailures == 0 ? 0 : 1);
+}
@@ -0,0 +1,714 @@
+// Host implementations of the stand-ins declared in host_platform.h
+#include "sim/host_platform.h"
+
+#include <malloc.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <set>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// Random numbers - deterministic so runs can be compared
+
+long random(long limit) {
+  static uint32_t state = 12345;
+  state = state * 1103515245 + 12345;
+  return limit > 0 ? (long)((state >> 8) % (uint32_t)limit) : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Clock
+
+namespace {
+std::atomic<bool> realTime{false};
+std::chrono::steady_clock::time_point realStart;
+unsigned long virtualNow = 0;            // ms
+thread_local unsigned long passDelay = 0;  // ms spent in simDelay() by the current pass
+}  // namespace
+
+unsigned long simMillis() {
+  if (realTime) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - realStart).count();
+  }
+  return virtualNow + passDelay;
+}
+
+unsigned long simMicros() {
+  if (realTime) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - realStart).count();
+  }
+  return (virtualNow + passDelay) * 1000;
+}
+
+void simDelay(unsigned long ms) {
+  if (realTime) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  } else {
+    passDelay += ms;
+  }
+}
+
+void simUseRealTime() {
+  realStart = std::chrono::steady_clock::now() - std::chrono::milliseconds(virtualNow);
+  realTime = true;
+}
+
+bool simRealTime() {
+  return realTime;
+}
+
+unsigned long simNow() {
+  return virtualNow;
+}
+
+void simSetNow(unsigned long ms) {
+  virtualNow = ms;
+}
+
+void simBeginPass() {
+  passDelay = 0;
+}
+
+unsigned long simEndPass() {
+  unsigned long spent = passDelay;
+  passDelay = 0;
+  return spent;
+}
+
+// ---------------------------------------------------------------------------
+// Serial
+
+namespace {
+std::mutex serialLock;
+std::deque<char> serialInput;
+std::string serialCapture;
+bool serialEcho = true;
+}  // namespace
+
+void simSerialWrite(const char* text, size_t length) {
+  SimUncounted uncounted;
+  std::lock_guard<std::mutex> guard(serialLock);
+  if (serialEcho) fwrite(text, 1, length, stdout);
+  serialCapture.append(text, length);
+  if (serialCapture.size() > 1 << 20) serialCapture.erase(0, serialCapture.size() / 2);
+}
+
+bool simSerialRead(char& c) {
+  std::lock_guard<std::mutex> guard(serialLock);
+  if (serialInput.empty()) return false;
+  c = serialInput.front();
+  serialInput.pop_front();
+  return true;
+}
+
+void simSerialInput(const char* text) {
+  SimUncounted uncounted;
+  std::lock_guard<std::mutex> guard(serialLock);
+  serialInput.insert(serialInput.end(), text, text + strlen(text));
+}
+
+void simSerialEcho(bool enabled) {
+  std::lock_guard<std::mutex> guard(serialLock);
+  serialEcho = enabled;
+}
+
+std::string simSerialTake() {
+  SimUncounted uncounted;
+  std::lock_guard<std::mutex> guard(serialLock);
+  std::string text;
+  text.swap(serialCapture);
+  return text;
+}
+
+// ---------------------------------------------------------------------------
+// Heap - global operator new/delete are replaced so the harness can count
+// what the sketch allocates and report an ESP32-sized heap
+
+#define SIM_HEAP_SIZE (320 * 1024)
+
+namespace {
+std::atomic<bool> countingAllocations{false};
+std::atomic<unsigned long> allocationCount{0};
+std::atomic<long> liveBytes{0};
+std::atomic<long> peakBytes{0};
+thread_local int uncountedDepth = 0;
+
+void* allocate(size_t size) {
+  void* block = malloc(size ? size : 1);
+  if (block == NULL) throw std::bad_alloc();
+  long live = liveBytes += (long)malloc_usable_size(block);
+  long peak = peakBytes.load();
+  while (live > peak && !peakBytes.compare_exchange_weak(peak, live)) {
+  }
+  if (countingAllocations && uncountedDepth == 0) allocationCount++;
+  return block;
+}
+
+void release(void* block) {
+  if (block == NULL) return;
+  liveBytes -= (long)malloc_usable_size(block);
+  free(block);
+}
+}  // namespace
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void* block) noexcept { release(block); }
+void operator delete[](void* block) noexcept { release(block); }
+void operator delete(void* block, size_t) noexcept { release(block); }
+void operator delete[](void* block, size_t) noexcept { release(block); }
+
+SimUncounted::SimUncounted() {
+  uncountedDepth++;
+}
+
+SimUncounted::~SimUncounted() {
+  uncountedDepth--;
+}
+
+void simHeapStats(SimHeapStats& stats) {
+  long live = liveBytes, peak = peakBytes;
+  stats.freeBytes = live < SIM_HEAP_SIZE ? SIM_HEAP_SIZE - live : 0;
+  stats.minFreeBytes = peak < SIM_HEAP_SIZE ? SIM_HEAP_SIZE - peak : 0;
+  stats.largestBlock = stats.freeBytes;
+}
+
+void simCountAllocations(bool enabled) {
+  countingAllocations = enabled;
+}
+
+unsigned long simAllocations() {
+  return allocationCount;
+}
+
+// ---------------------------------------------------------------------------
+// Tasks
+
+namespace {
+std::mutex taskLock;
+std::vector<std::string> taskNames;
+bool threadsEnabled = false;
+}  // namespace
+
+void simStartTask(void (*task)(void*), const char* name, TaskHandle_t* handle) {
+  SimUncounted uncounted;
+  std::lock_guard<std::mutex> guard(taskLock);
+  taskNames.push_back(name);
+  if (handle != NULL) *handle = (TaskHandle_t)(uintptr_t)taskNames.size();
+  if (threadsEnabled) std::thread(task, (void*)NULL).detach();
+}
+
+void simEnableThreads(bool enabled) {
+  threadsEnabled = enabled;
+  if (enabled) simUseRealTime();
+}
+
+int simTaskCount() {
+  std::lock_guard<std::mutex> guard(taskLock);
+  return (int)taskNames.size();
+}
+
+const char* simTaskName(int index) {
+  std::lock_guard<std::mutex> guard(taskLock);
+  return taskNames[index].c_str();
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)simMillis();
+}
+
+void vTaskDelay(TickType_t ticks) {
+  simDelay(ticks);
+}
+
+// Sleep until previousWake + ticks; a late caller does not sleep at all
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t ticks) {
+  *previousWake += ticks;
+  long remaining = (long)(*previousWake - (TickType_t)simMillis());
+  if (remaining > 0) simDelay(remaining);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+}
+
+// ---------------------------------------------------------------------------
+// Preferences
+
+namespace {
+std::mutex preferenceLock;
+std::map<std::string, std::vector<uint8_t>> preferenceValues;
+unsigned long preferenceWrites = 0;
+}  // namespace
+
+bool Preferences::begin(const char* name, bool readOnly) {
+  return true;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+  SimUncounted uncounted;
+  std::lock_guard<std::mutex> guard(preferenceLock);
+  auto entry = preferenceValues.find(key);
+  if (entry == preferenceValues.end() || entry->second.size() > length) return 0;
+  memcpy(buffer, entry->second.data(), entry->second.size());
+  return entry->second.size();
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+  SimUncounted uncounted;
+  std::lock_guard<std::mutex> guard(preferenceLock);
+  const uint8_t* bytes = (const uint8_t*)value;
+  preferenceValues[key].assign(bytes, bytes + length);
+  preferenceWrites++;
+  return length;
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+  uint32_t value;
+  return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+  return putBytes(key, &value, sizeof(value));
+}
+
+float Preferences::getFloat(const char* key, float defaultValue) {
+  float value;
+  return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+size_t Preferences::putFloat(const char* key, float value) {
+  return putBytes(key, &value, sizeof(value));
+}
+
+bool Preferences::remove(const char* key) {
+  SimUncounted uncounted;
+  std::lock_guard<std::mutex> guard(preferenceLock);
+  return preferenceValues.erase(key) > 0;
+}
+
+bool Preferences::clear() {
+  std::lock_guard<std::mutex> guard(preferenceLock);
+  preferenceValues.clear();
+  return true;
+}
+
+unsigned long simPreferenceWrites() {
+  std::lock_guard<std::mutex> guard(preferenceLock);
+  return preferenceWrites;
+}
+
+// ---------------------------------------------------------------------------
+// LittleFS
+
+struct SimFileNode {
+  std::vector<uint8_t> data;
+};
+
+SimFileSystem LittleFS;
+
+namespace {
+std::recursive_mutex fileLock;
+std::map<std::string, std::shared_ptr<SimFileNode>> files;
+std::set<std::string> directories = {"/"};
+
+std::string parentOf(const std::string& path) {
+  size_t slash = path.rfind('/');
+  return slash == 0 || slash == std::string::npos ? "/" : path.substr(0, slash);
+}
+}  // namespace
+
+File::File() {
+}
+
+File::operator bool() const {
+  return node != NULL || directory;
+}
+
+size_t File::read(uint8_t* buffer, size_t length) {
+  std::lock_guard<std::recursive_mutex> guard(fileLock);
+  if (node == NULL || offset >= node->data.size()) return 0;
+  length = min(length, node->data.size() - offset);
+  memcpy(buffer, node->data.data() + offset, length);
+  offset += length;
+  return length;
+}
+
+size_t File::write(const uint8_t* buffer, size_t length) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(fileLock);
+  if (node == NULL) return 0;
+  if (node->data.size() < offset + length) node->data.resize(offset + length);
+  memcpy(node->data.data() + offset, buffer, length);
+  offset += length;
+  return length;
+}
+
+size_t File::write(uint8_t value) {
+  return write(&value, 1);
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+  std::lock_guard<std::recursive_mutex> guard(fileLock);
+  if (node == NULL) return false;
+  size_t base = mode == SeekSet ? 0 : mode == SeekCur ? offset : node->data.size();
+  if (base + position > node->data.size()) return false;
+  offset = base + position;
+  return true;
+}
+
+bool File::seek(uint32_t position) {
+  return seek(position, SeekSet);
+}
+
+size_t File::position() const {
+  return offset;
+}
+
+size_t File::size() const {
+  std::lock_guard<std::recursive_mutex> guard(fileLock);
+  return node != NULL ? node->data.size() : 0;
+}
+
+void File::flush() {
+}
+
+// The name stays readable after close(), as it does on the ESP32
+void File::close() {
+  node.reset();
+  directory = false;
+}
+
+bool File::isDirectory() const {
+  return directory;
+}
+
+File File::openNextFile() {
+  if (!directory || nextEntry >= entries.size()) return File();
+  return LittleFS.open(entries[nextEntry++].c_str(), "r");
+}
+
+const char* File::name() const {
+  size_t slash = path.rfind('/');
+  return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+bool SimFileSystem::begin(bool formatOnFail) {
+  return true;
+}
+
+File SimFileSystem::open(const char* path, const char* mode) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(fileLock);
+  File file;
+  file.path = path;
+
+  if (directories.count(path)) {
+    file.directory = true;
+    for (const auto& entry : files) {
+      if (parentOf(entry.first) == path) file.entries.push_back(entry.first);
+    }
+    return file;
+  }
+
+  auto entry = files.find(path);
+  if (mode[0] == 'w') {
+    if (!directories.count(parentOf(path))) return File();
+    file.node = std::make_shared<SimFileNode>();
+    files[path] = file.node;
+  } else if (entry != files.end()) {
+    file.node = entry->second;
+    if (mode[0] == 'a') file.offset = file.node->data.size();
+  } else if (mode[0] == 'a') {
+    file.node = std::make_shared<SimFileNode>();
+    files[path] = file.node;
+  } else {
+    return File();
+  }
+  return file;
+}
+
+File SimFileSystem::open(const char* path) {
+  return open(path, "r");
+}
+
+bool SimFileSystem::exists(const char* path) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(fileLock);
+  return files.count(path) > 0 || directories.count(path) > 0;
+}
+
+bool SimFileSystem::remove(const char* path) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(fileLock);
+  return files.erase(path) > 0;
+}
+
+bool SimFileSystem::mkdir(const char* path) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(fileLock);
+  directories.insert(path);
+  return true;
+}
+
+void SimFileSystem::format() {
+  std::lock_guard<std::recursive_mutex> guard(fileLock);
+  files.clear();
+  directories = {"/"};
+}
+
+// ---------------------------------------------------------------------------
+// Database
+
+SimRtdb simRtdb;
+
+namespace {
+const char* skipSpace(const char* json) {
+  while (isspace((unsigned char)*json)) json++;
+  return json;
+}
+
+// Past the value starting at json (which must be well formed)
+const char* skipValue(const char* json) {
+  json = skipSpace(json);
+  int depth = 0;
+  bool quoted = false;
+  for (; *json != '\0'; json++) {
+    if (quoted) {
+      if (*json == '\\') json++;
+      else if (*json == '"') quoted = false;
+      if (depth == 0 && !quoted) return json + 1;
+      continue;
+    }
+    if (*json == '"') {
+      quoted = true;
+    } else if (*json == '{' || *json == '[') {
+      depth++;
+    } else if (*json == '}' || *json == ']') {
+      if (depth == 0) return json;
+      if (--depth == 0) return json + 1;
+    } else if (depth == 0 && (*json == ',' || isspace((unsigned char)*json))) {
+      return json;
+    }
+  }
+  return json;
+}
+
+// Visit the members of an object (or the elements of an array, keyed by index)
+template <typename Visit>
+bool forEachMember(const char* json, Visit visit) {
+  json = skipSpace(json);
+  if (*json != '{' && *json != '[') return false;
+  bool array = *json == '[';
+  json++;
+  for (int index = 0;; index++) {
+    json = skipSpace(json);
+    if (*json == ',') json = skipSpace(json + 1);
+    if (*json == '}' || *json == ']' || *json == '\0') return true;
+    std::string key;
+    if (array) {
+      key = std::to_string(index);
+    } else {
+      const char* end = skipValue(json);
+      key.assign(json + 1, end - json - 2);
+      json = skipSpace(end) + 1;   // Past the ':'
+    }
+    json = skipSpace(json);
+    const char* end = skipValue(json);
+    visit(key, std::string(json, end - json));
+    json = end;
+  }
+}
+
+// "/a/b/" -> "a/b"
+std::string normalize(const char* path) {
+  std::string result;
+  for (const char* c = path; *c != '\0'; c++) {
+    if (*c == '/' && (result.empty() || result.back() == '/')) continue;
+    result += *c;
+  }
+  if (!result.empty() && result.back() == '/') result.pop_back();
+  return result;
+}
+
+std::string join(const std::string& parent, const std::string& child) {
+  std::string tail = normalize(child.c_str());
+  if (parent.empty()) return tail;
+  return tail.empty() ? parent : parent + "/" + tail;
+}
+
+// Is path equal to or below parent?
+bool under(const std::string& path, const std::string& parent) {
+  if (parent.empty()) return true;
+  return path.compare(0, parent.size(), parent) == 0 && (path.size() == parent.size() || path[parent.size()] == '/');
+}
+
+void flatten(const std::string& path, const std::string& json, std::map<std::string, std::string>& leaves) {
+  bool container = forEachMember(json.c_str(), [&](const std::string& key, const std::string& value) {
+    flatten(join(path, key), value, leaves);
+  });
+  if (!container && json != "null") leaves[path] = json;
+}
+
+struct Tree {
+  std::string leaf;
+  std::map<std::string, Tree> children;
+};
+
+std::string serialize(const Tree& tree) {
+  if (tree.children.empty()) return tree.leaf;
+  std::string text = "{";
+  for (const auto& child : tree.children) {
+    if (text.size() > 1) text += ",";
+    text += "\"" + child.first + "\":" + serialize(child.second);
+  }
+  return text + "}";
+}
+}  // namespace
+
+bool SimRtdb::request(uint8_t kind, const char* path) {
+  count++;
+  bool ok = online && !(failEvery != 0 && count % failEvery == 0);
+  unsigned long wait = online ? latency : offlineLatency;
+
+  SimRequest& entry = log[(count - 1) % SIM_RTDB_LOG_SIZE];
+  entry.kind = kind;
+  entry.atMillis = simMillis();
+  entry.latency = wait;
+  entry.ok = ok;
+  snprintf(entry.path, sizeof(entry.path), "%s", path);
+  if (kind < sizeof(kindCounts) / sizeof(kindCounts[0])) kindCounts[kind]++;
+  if (!ok) failures++;
+
+  simDelay(wait);
+  return ok;
+}
+
+// Replace the node at path and tell an open stream about it
+void SimRtdb::store(const std::string& path, const char* json, bool notify) {
+  for (auto leaf = leaves.begin(); leaf != leaves.end();) {
+    leaf = under(leaf->first, path) ? leaves.erase(leaf) : std::next(leaf);
+  }
+  flatten(path, json, leaves);
+
+  if (!notify || !streaming) return;
+  if (under(path, streamPath)) {
+    std::string relative = path.substr(streamPath.size());
+    events.push_back({false, relative.empty() ? "/" : (relative[0] == '/' ? relative : "/" + relative), json});
+  } else if (under(streamPath, path)) {
+    events.push_back({false, "/", value(streamPath.c_str())});
+  }
+}
+
+bool SimRtdb::patch(uint8_t kind, const char* path, const char* body) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  if (!request(kind, path)) return false;
+  bytesWritten += strlen(body);
+  std::string parent = normalize(path);
+  forEachMember(body, [&](const std::string& key, const std::string& value) {
+    store(join(parent, key), value.c_str(), true);
+  });
+  return true;
+}
+
+bool SimRtdb::get(uint8_t kind, const char* path) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  if (!request(kind, path)) return false;
+  lastPayload = value(path);
+  return true;
+}
+
+const char* SimRtdb::payload() const {
+  return lastPayload.c_str();
+}
+
+bool SimRtdb::beginStream(uint8_t kind, const char* path) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  if (!request(kind, path)) return false;
+  streaming = true;
+  streamBroken = false;
+  streamPath = normalize(path);
+  events.clear();
+  events.push_back({false, "/", value(path)});   // The server opens with the whole node
+  return true;
+}
+
+bool SimRtdb::readStream(bool& available, bool& patchEvent, char* path, size_t pathSize, const char*& data) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  available = false;
+  if (!streaming) return false;
+  if (!online) {
+    streamBroken = true;
+    return false;
+  }
+  if (streamBroken) {
+    // Reconnected - the server replays the whole node first
+    streamBroken = false;
+    events.push_front({false, "/", value(streamPath.c_str())});
+  }
+  if (events.empty()) return true;
+
+  current = events.front();
+  events.pop_front();
+  available = true;
+  patchEvent = current.patch;
+  snprintf(path, pathSize, "%s", current.path.c_str());
+  data = current.data.c_str();
+  return true;
+}
+
+void SimRtdb::set(const char* path, const char* json) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  store(normalize(path), json, true);
+}
+
+std::string SimRtdb::value(const char* path) {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  std::string prefix = normalize(path);
+  Tree root;
+  bool found = false;
+  for (const auto& leaf : leaves) {
+    if (!under(leaf.first, prefix)) continue;
+    found = true;
+    Tree* node = &root;
+    size_t start = prefix.empty() ? 0 : prefix.size() + 1;
+    while (start < leaf.first.size()) {
+      size_t slash = leaf.first.find('/', start);
+      if (slash == std::string::npos) slash = leaf.first.size();
+      node = &node->children[leaf.first.substr(start, slash - start)];
+      start = slash + 1;
+    }
+    node->leaf = leaf.second;
+  }
+  return found ? serialize(root) : "null";
+}
+
+unsigned long SimRtdb::requests(uint8_t kind) const {
+  return kind < sizeof(kindCounts) / sizeof(kindCounts[0]) ? kindCounts[kind] : 0;
+}
+
+void SimRtdb::reset() {
+  SimUncounted uncounted;
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  online = true;
+  latency = 50;
+  offlineLatency = 0;
+  failEvery = 0;
+  count = 0;
+  failures = 0;
+  bytesWritten = 0;
+  leaves.clear();
+  events.clear();
+  streaming = false;
+  streamBroken = false;
+  lastPayload = "null";
+  for (unsigned long& kindCount : kindCounts) kindCount = 0;
+}
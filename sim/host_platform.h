@@ -0,0 +1,209 @@
+// Host stand-ins for the platform the sketch runs on. With POULTRY_SIMULATION
+// defined, microcontroller-code.cpp includes this header instead of the ESP32
+// Arduino, Firebase and storage headers: the HAL's simulation branches call
+// the sim* functions below, and the few platform types used outside the HAL
+// (Preferences, LittleFS files, FreeRTOS ticks) are replaced by in-memory
+// versions. Everything here is built by the CMake host target.
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using std::isnan;
+using std::max;
+using std::min;
+
+#define IRAM_ATTR
+#define constrain(amount, low, high) ((amount) < (low) ? (low) : ((amount) > (high) ? (high) : (amount)))
+
+long random(long limit);
+
+// Clock - virtual by default: the harness moves it forward and a blocking
+// call (simDelay) only delays the pass that made it. simUseRealTime() switches
+// to std::chrono for runs where the tasks are real threads.
+unsigned long simMillis();
+unsigned long simMicros();
+void simDelay(unsigned long ms);
+void simUseRealTime();
+bool simRealTime();
+
+// Virtual time control for the harness. A pass starts at simNow(); whatever
+// it spent in simDelay() is returned by simEndPass().
+unsigned long simNow();
+void simSetNow(unsigned long ms);
+void simBeginPass();
+unsigned long simEndPass();
+
+// Serial - output goes to stdout (and a capture buffer), input comes from
+// lines the harness queues
+void simSerialWrite(const char* text, size_t length);
+bool simSerialRead(char& c);
+void simSerialInput(const char* text);
+void simSerialEcho(bool enabled);
+std::string simSerialTake();
+
+// Heap - operator new is counted while counting is on; allocations made by
+// the host fakes themselves are excluded (see SimUncounted)
+struct SimHeapStats {
+  uint32_t freeBytes;
+  uint32_t minFreeBytes;
+  uint32_t largestBlock;
+};
+void simHeapStats(SimHeapStats& stats);
+void simCountAllocations(bool enabled);
+unsigned long simAllocations();
+
+class SimUncounted {
+ public:
+  SimUncounted();
+  ~SimUncounted();
+};
+
+// Tasks - xTaskCreatePinnedToCore maps to a detached std::thread once
+// threads are enabled; otherwise the task is only recorded and the harness
+// calls the loops itself
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+void simStartTask(void (*task)(void*), const char* name, TaskHandle_t* handle);
+void simEnableThreads(bool enabled);
+int simTaskCount();
+const char* simTaskName(int index);
+TickType_t xTaskGetTickCount();
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t ticks);
+void vTaskDelete(TaskHandle_t task);
+
+// Preferences (NVS) - one in-memory namespace shared by every instance
+class Preferences {
+ public:
+  bool begin(const char* name, bool readOnly);
+  size_t getBytes(const char* key, void* buffer, size_t length);
+  size_t putBytes(const char* key, const void* value, size_t length);
+  uint32_t getUInt(const char* key, uint32_t defaultValue);
+  size_t putUInt(const char* key, uint32_t value);
+  float getFloat(const char* key, float defaultValue);
+  size_t putFloat(const char* key, float value);
+  bool remove(const char* key);
+  bool clear();
+};
+unsigned long simPreferenceWrites();
+
+// LittleFS - files and directories held in memory
+enum SeekMode { SeekSet, SeekCur, SeekEnd };
+
+struct SimFileNode;
+
+class File {
+ public:
+  File();
+  explicit operator bool() const;
+  size_t read(uint8_t* buffer, size_t length);
+  size_t write(const uint8_t* buffer, size_t length);
+  size_t write(uint8_t value);
+  bool seek(uint32_t position, SeekMode mode);
+  bool seek(uint32_t position);
+  size_t position() const;
+  size_t size() const;
+  void flush();
+  void close();
+  bool isDirectory() const;
+  File openNextFile();
+  const char* name() const;
+
+ private:
+  friend class SimFileSystem;
+  std::shared_ptr<SimFileNode> node;
+  std::string path;
+  size_t offset = 0;
+  bool directory = false;
+  std::vector<std::string> entries;   // Directory listing taken at open
+  size_t nextEntry = 0;
+};
+
+class SimFileSystem {
+ public:
+  bool begin(bool formatOnFail);
+  File open(const char* path, const char* mode);
+  File open(const char* path);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool mkdir(const char* path);
+  void format();
+};
+extern SimFileSystem LittleFS;
+
+// Database - an in-process RTDB. Writes land in a path -> JSON leaf map,
+// every request is logged with its latency and result, and the harness can
+// write nodes as the dashboard would (which reaches an open stream), take
+// the link down or fail a share of the requests.
+#define SIM_RTDB_LOG_SIZE 256
+
+struct SimRequest {
+  uint8_t kind;
+  unsigned long atMillis;
+  unsigned long latency;
+  bool ok;
+  char path[48];
+};
+
+struct SimStreamEvent {
+  bool patch;
+  std::string path;
+  std::string data;
+};
+
+class SimRtdb {
+ public:
+  bool online = true;
+  unsigned long latency = 50;        // ms each request takes while online
+  unsigned long offlineLatency = 0;  // ms a request takes to fail while offline
+  unsigned failEvery = 0;            // Fail every Nth request (0 = never)
+  unsigned long count = 0;
+  unsigned long failures = 0;
+  unsigned long bytesWritten = 0;
+  SimRequest log[SIM_RTDB_LOG_SIZE];
+
+  // Device side - called from the HAL
+  bool patch(uint8_t kind, const char* path, const char* body);
+  bool get(uint8_t kind, const char* path);
+  const char* payload() const;
+  bool beginStream(uint8_t kind, const char* path);
+  bool readStream(bool& available, bool& patchEvent, char* path, size_t pathSize, const char*& data);
+
+  // Harness side
+  void set(const char* path, const char* json);
+  std::string value(const char* path);
+  unsigned long requests(uint8_t kind) const;
+  void reset();
+
+ private:
+  std::recursive_mutex lock;
+  std::map<std::string, std::string> leaves;
+  std::deque<SimStreamEvent> events;
+  SimStreamEvent current;
+  std::string streamPath;
+  std::string lastPayload = "null";
+  bool streaming = false;
+  bool streamBroken = false;         // Read while offline - replay the node on reconnect
+  unsigned long kindCounts[8] = {};
+
+  bool request(uint8_t kind, const char* path);
+  void store(const std::string& path, const char* json, bool notify);
+};
+extern SimRtdb simRtdb;
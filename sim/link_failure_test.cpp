@@ -0,0 +1,54 @@
+// The control tick stays on time whatever the database does: first slow and
+// flaky, then unreachable with every request hanging until its TLS timeout.
+// While the link is down the network task only probes it, with backoff, and
+// a flag flipped during the outage goes out once, with its latest value.
+#include "harness.h"
+
+int main() {
+  simScheduler.networkPeriod = 10;
+  simBoot();
+  CHECK(simRunUntil([] { return networkStage == NET_READY; }, 5000));
+  simRun(5000);
+
+  // Slow and flaky: 800 ms a request, every third one fails
+  simRtdb.latency = 800;
+  simRtdb.failEvery = 3;
+  unsigned long frames = telemetryFramesSent;
+  unsigned long passes = simScheduler.controlPasses;
+  simRun(60000);
+  CHECK(simScheduler.controlPasses - passes >= 60000 / CONTROL_TASK_PERIOD_MS - 1);
+  CHECK(telemetryFramesSent > frames);
+
+  // Unreachable: requests hang for 5 s before failing
+  simRtdb.latency = 50;
+  simRtdb.failEvery = 0;
+  simRtdb.online = false;
+  simRtdb.offlineLatency = 5000;
+  simScheduler.maxNetworkPass = 0;
+  unsigned long requests = simRtdb.count;
+  CHECK(simRunUntil([] { return !linkHealth.up; }, 30000));
+  unsigned long coalesced = outboxCoalesced;
+  for (int i = 0; i < 5; i++) {
+    queueBoolWrite("/diagnostics/testFlag", i % 2 == 0);
+    simRun(2000);
+  }
+  simRun(10 * 60000UL);
+  unsigned long outageRequests = simRtdb.count - requests;
+  printf("10 min offline: %lu requests, %lu short-circuited, longest network pass %lu ms\n",
+         outageRequests, linkHealth.shortCircuited, simScheduler.maxNetworkPass);
+  CHECK(outageRequests <= 20);   // Detection plus backed-off probes
+  CHECK(linkHealth.backoff == LINK_BACKOFF_MAX);
+  CHECK(simScheduler.maxNetworkPass <= LINK_FAILURE_LIMIT * simRtdb.offlineLatency);
+  CHECK(outboxCoalesced - coalesced == 4);   // One pending write, rewritten in place
+
+  // The control task never waited on any of it
+  CHECK(simScheduler.maxControlPass == 0);
+  CHECK(perfMissedTicks == 0);
+
+  // Back online: the next probe restores the link and the flag is sent once
+  simRtdb.online = true;
+  CHECK(simRunUntil([] { return linkHealth.up; }, LINK_BACKOFF_MAX * 5 / 4 + 1000));
+  CHECK(simRunUntil([] { return outboxHeader.count == 0; }, 10000));
+  CHECK(simRtdb.value("/diagnostics/testFlag") == "true");
+  return simFinish("link_failure_test");
+}
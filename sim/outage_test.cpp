@@ -0,0 +1,60 @@
+// Records made while the database is unreachable wait in the flash outbox,
+// survive a reboot of the outbox, lose only the oldest ones once the ring is
+// full, and go out in batches oldest first when the link comes back.
+#include "harness.h"
+
+// How many of the test's events (or the one numbered index) are in the
+// database. The fake stores arrays as objects keyed by position.
+int countEvents(int index) {
+  std::string events = simRtdb.value("/events");
+  char pattern[48];
+  if (index >= 0) {
+    snprintf(pattern, sizeof(pattern), "\"v\":{\"0\":%d,\"1\":100,\"2\":2}", index);
+  } else {
+    snprintf(pattern, sizeof(pattern), ",\"1\":100,\"2\":2}");
+  }
+  int count = 0;
+  for (size_t at = events.find(pattern); at != std::string::npos; at = events.find(pattern, at + 1)) count++;
+  return count;
+}
+
+int main() {
+  simBoot();
+  CHECK(simRunUntil([] { return networkStage == NET_READY && outboxHeader.count == 0; }, 5000));
+  simRun(2000);
+
+  // The link drops; every request now fails after a TLS timeout
+  simRtdb.online = false;
+  simRtdb.offlineLatency = 500;
+  const int recorded = OUTBOX_CAPACITY + 40;
+  for (int i = 0; i < recorded; i++) {
+    logEvent(EVENT_FEEDING, {i, 100, 2});
+    if (i % 10 == 9) simRun(1000);   // A busy barn: ten records a second
+  }
+  simRun(5000);
+  CHECK(outboxHeader.count == OUTBOX_CAPACITY);
+  CHECK(outboxHeader.evicted >= (uint32_t)(recorded - OUTBOX_CAPACITY));
+  CHECK(countEvents(-1) == 0);
+
+  // Reboot: the ring is read back from flash as it was left
+  OutboxHeader before = outboxHeader;
+  outboxFile.close();
+  outboxReady = false;
+  outboxHeader = {};
+  beginOutbox();
+  CHECK(outboxReady);
+  CHECK(outboxHeader.count == before.count && outboxHeader.head == before.head);
+
+  // Back online: drained in OUTBOX_BATCH_SIZE batches, oldest first
+  unsigned long patches = simRtdb.requests(RTDB_PATCH);
+  simRtdb.online = true;
+  CHECK(simRunUntil([] { return outboxHeader.count == 0; }, 60000));
+  CHECK(simRtdb.requests(RTDB_PATCH) - patches >= OUTBOX_CAPACITY / OUTBOX_BATCH_SIZE);
+  int delivered = countEvents(-1);
+  CHECK(delivered <= OUTBOX_CAPACITY);
+  CHECK(delivered >= OUTBOX_CAPACITY - 8);   // The rest of the ring held the outage's other records
+  CHECK(countEvents(0) == 0);
+  CHECK(countEvents(recorded - OUTBOX_CAPACITY - 1) == 0);
+  CHECK(countEvents(recorded - 1) == 1);
+  return simFinish("outage_test");
+}
@@ -0,0 +1,31 @@
+// Run the sketch on a simulated barn and print its serial output.
+//
+//   poultry_sim [minutes] [latency-ms]
+//
+// Lines typed on stdin before the run starts (e.g. "log all 4", "perf")
+// are fed to the serial console.
+#include "harness.h"
+
+#include <poll.h>
+
+int main(int argc, char** argv) {
+  unsigned long minutes = argc > 1 ? strtoul(argv[1], NULL, 10) : 10;
+  simRtdb.latency = argc > 2 ? strtoul(argv[2], NULL, 10) : 50;
+
+  // Serial input, if some is waiting
+  struct pollfd input = {0, POLLIN, 0};
+  char line[128];
+  while (poll(&input, 1, 0) > 0 && (input.revents & POLLIN) && fgets(line, sizeof(line), stdin) != NULL) {
+    simSerialInput(line);
+  }
+
+  simBoot();
+  simSerialEcho(true);
+  simRun(minutes * 60000);
+
+  printf("\n%lu min simulated: %lu control passes, %lu network passes (slowest %lu ms)\n", minutes,
+         simScheduler.controlPasses, simScheduler.networkPasses, simScheduler.maxNetworkPass);
+  printf("%lu database requests (%lu PATCH, %lu GET, %lu failed), %lu bytes written\n", simRtdb.count,
+         simRtdb.requests(RTDB_PATCH), simRtdb.requests(RTDB_GET), simRtdb.failures, simRtdb.bytesWritten);
+  return simFinish("poultry_sim");
+}
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Turn the Arduino sketch into a plain C++ translation unit.
+
+The Arduino build declares every top-level function before the first one is
+defined, so the sketch calls functions defined further down without
+prototypes. This does the same for the host build: it collects the
+signatures of top-level function definitions, inserts them ahead of the
+first definition and adds #line directives so compiler errors still point
+into microcontroller-code.cpp.
+
+usage: sketch_prototypes.py <sketch> <output>
+"""
+import re
+import sys
+
+DEFINITION = re.compile(
+    r'^(?!static_assert|template|struct|class|enum|namespace|typedef|using|return|#)'
+    r'([A-Za-z_][\w:<>\*&, ]*?[\s\*&]+)([A-Za-z_]\w*)\s*\(([^;{}]*)\)\s*(const)?\s*\{\s*$')
+KEYWORDS = {'if', 'while', 'for', 'switch'}
+LITERAL = re.compile(r'"(\\.|[^"\\])*"|\'(\\.|[^\'\\])*\'')
+
+
+def code_only(line):
+    """The line without string/char literals and trailing // comment."""
+    line = LITERAL.sub('', line)
+    return line.split('//')[0]
+
+
+def main(sketch, output):
+    with open(sketch, encoding='utf-8') as source:
+        lines = source.read().split('\n')
+
+    prototypes = []
+    first = None
+    depth = 0
+    for number, line in enumerate(lines):
+        if depth == 0:
+            match = DEFINITION.match(line)
+            if match and match.group(2) not in KEYWORDS:
+                returns, name, arguments = match.group(1), match.group(2), match.group(3)
+                arguments = re.sub(r'\s*=\s*[^,]+', '', arguments)
+                prototypes.append(f'{returns}{name}({arguments});')
+                if first is None:
+                    first = number
+        code = code_only(line)
+        depth += code.count('{') - code.count('}')
+
+    if first is None:
+        sys.exit(f'{sketch}: no function definitions found')
+
+    path = sketch.replace('\\', '/')
+    text = [f'#line 1 "{path}"'] + lines[:first]
+    text += ['// Prototypes, as the Arduino build generates them'] + prototypes
+    text += [f'#line {first + 1} "{path}"'] + lines[first:]
+    with open(output, 'w', encoding='utf-8') as generated:
+        generated.write('\n'.join(text))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    main(sys.argv[1], sys.argv[2])
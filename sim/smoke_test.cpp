@@ -0,0 +1,23 @@
+// Boot the sketch against the host platform: the network comes up, the
+// control stream opens, telemetry reaches the database and a dashboard
+// command written to /device/controls starts the feeder.
+#include "harness.h"
+
+int main() {
+  simBoot();
+  CHECK(simTaskCount() == 3);
+
+  CHECK(simRunUntil([] { return networkStage == NET_READY; }, 5000));
+  CHECK(simRtdb.requests(RTDB_STREAM_BEGIN) == 1);
+
+  simRun(3000);
+  CHECK(simRtdb.requests(RTDB_PATCH) > 0);
+  CHECK(simRtdb.value("/sensors/temperature") == "25.00");
+  CHECK(simRtdb.value("/device/controls/feed") == "false");
+
+  simRtdb.set("/device/controls/feed", "true");
+  CHECK(simRunUntil([] { return isFeeding; }, 1000));
+  CHECK(simRunUntil([] { return simRtdb.value("/deviceStates/isFeeding") == "true"; }, 3000));
+  CHECK(bootMetrics.cloud != 0 && bootMetrics.reported);
+  return simFinish("smoke_test");
+}
@@ -0,0 +1,50 @@
+// The FreeRTOS tasks as real std::threads on the wall clock: the control
+// task keeps its tick while every database request stalls the network task
+// for over a second, and a dashboard command still crosses the queues.
+#include "harness.h"
+
+#include <chrono>
+#include <thread>
+
+// Poll a condition the task threads change; true if it held within timeout ms
+template <typename Condition>
+bool waitFor(Condition condition, unsigned long timeout) {
+  unsigned long end = simMillis() + timeout;
+  while (!condition()) {
+    if (simMillis() >= end) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+int main() {
+  simEnableThreads(true);
+  simBoot();
+  CHECK(simTaskCount() == 3);
+  CHECK(strcmp(simTaskName(0), "log") == 0);
+  CHECK(strcmp(simTaskName(1), "control") == 0);
+  CHECK(strcmp(simTaskName(2), "network") == 0);
+
+  CHECK(waitFor([] { return networkStage == NET_READY; }, 3000));
+  CHECK(waitFor([] { return simRtdb.value("/sensors/temperature") == "25.00"; }, 3000));
+
+  // TLS stall: each request now blocks the network task for 1.5 s
+  simRtdb.latency = 1500;
+  unsigned long stallStart = simMillis();
+  unsigned long ticks = 0;
+  unsigned long lastTick = previousMillis;
+  while (simMillis() - stallStart < 4000) {
+    if (previousMillis != lastTick) {
+      lastTick = previousMillis;
+      ticks++;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  CHECK(ticks >= 3);   // A control tick every second throughout
+  CHECK(simMillis() - previousMillis < 2 * (unsigned long)interval);
+
+  // The command arrives through the stalled stream and the control task acts
+  simRtdb.set("/device/controls/feed", "true");
+  CHECK(waitFor([] { return isFeeding; }, 5000));
+  return simFinish("task_thread_test");
+}
@@ -0,0 +1,55 @@
+// Telemetry goes out as one multi-path PATCH per control tick at most: the
+// first frame carries every field, later frames only what moved, and a
+// second of changing readings never costs more than one request for them.
+#include "harness.h"
+
+const char* const telemetryPaths[] = {
+  "/sensors/temperature", "/sensors/humidity", "/sensors/foodLevel", "/sensors/waterLevelMain",
+  "/sensors/waterLevelDrinker", "/deviceStates/fan", "/deviceStates/heat", "/deviceStates/pump",
+  "/alerts/highTemperature", "/alerts/lowTemperature", "/alerts/lowFood", "/alerts/lowWaterMain",
+  "/alerts/lowWaterDrinker", "/alerts/lowHydration", "/deviceStates/isFeeding",
+  "/deviceStates/isWaterFilling", "/waterConsumption/totalToday", "/waterConsumption/perBird",
+  "/waterConsumption/ratePerHour"
+};
+
+int main() {
+  simBoot();
+  CHECK(simRunUntil([] { return telemetryFramesSent == 1; }, 5000));
+  for (const char* path : telemetryPaths) {
+    CHECK(simRtdb.value(path) != "null");
+  }
+
+  simRunUntil([] { return outboxHeader.count == 0 && bootMetrics.reported; }, 10000);
+  simRun(2000);
+
+  // Move the readings every second - the climate sensor is only sampled
+  // every DHT_SAMPLE_INTERVAL, the hopper level on every tick
+  unsigned long firstRequest = simRtdb.count;
+  unsigned long frames = telemetryFramesSent;
+  const int seconds = 30;
+  for (int second = 0; second < seconds; second++) {
+    simBarn.temperature = 25 + second * 0.5f;
+    simBarn.humidity = 60 + (second % 4) * 2;
+    simBarn.foodDistanceCm = 2 + (second % 2) * 5;
+    simRun(1000);
+  }
+  unsigned long sent = telemetryFramesSent - frames;
+  CHECK(sent >= seconds / 2);
+  CHECK(sent <= (unsigned long)seconds);
+
+  // Requests per second: the telemetry frame and perhaps an outbox batch
+  int perSecond[seconds + 1] = {};
+  unsigned long windowStart = simRtdb.log[firstRequest % SIM_RTDB_LOG_SIZE].atMillis;
+  for (unsigned long i = firstRequest; i < simRtdb.count; i++) {
+    const SimRequest& request = simRtdb.log[i % SIM_RTDB_LOG_SIZE];
+    CHECK(request.kind == RTDB_PATCH);
+    int second = (request.atMillis - windowStart) / 1000;
+    if (second <= seconds) perSecond[second]++;
+  }
+  for (int second = 0; second <= seconds; second++) {
+    CHECK(perSecond[second] <= 2);
+  }
+  CHECK(simRtdb.count - firstRequest < SIM_RTDB_LOG_SIZE);
+  printf("%lu telemetry frames, %lu requests in %d s\n", sent, simRtdb.count - firstRequest, seconds);
+  return simFinish("telemetry_request_test");
+}
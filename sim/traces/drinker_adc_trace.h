@@ -0,0 +1,386 @@
+// Drinker channel replay trace: one averaged driver block (avg_read_raw)
+// per entry, one entry per control pass, 60 s in all. The level drains
+// slowly through the default refill threshold (30 % = raw 1210) with +/-40
+// counts of ripple and a +/-450 count splash every few seconds - the noise
+// that made single analogRead() pump control chatter. A capture from the
+// board can replace it in the same format.
+#pragma once
+
+const uint16_t drinkerAdcTrace[] = {
+  1272, 1244, 1274, 1228, 1261, 1259, 1268, 1249, 1240, 1250, 1286, 1234, 1244, 1271, 1283, 1299,
+  1284, 1257, 1263, 1270, 1240, 1276, 1277, 1298, 1246, 1255, 1276, 1279, 1233, 1221, 1282, 1223,
+  1267, 1239, 1264, 1261, 1251, 1234, 1271, 1277, 1244, 1297, 1286, 1250, 1276, 1229, 1268, 1263,
+  1275, 1292, 1251, 1286, 1269, 1220, 1249, 1228, 1264, 1249, 1231, 1283, 1225, 1226, 1235, 1291,
+  1263, 1258, 1249, 1227, 1255, 1244, 1249, 1229, 1294, 1282, 1254, 1264, 1220, 1296, 1231, 1247,
+  1279, 1276, 1285, 1233, 1274, 1223, 1298, 1221, 1231, 1298, 1273, 1222, 1238, 1270, 1231, 1291,
+  1254, 1287, 1258, 1231, 1281, 1219, 1282, 1242, 1229, 1236, 1254, 1238, 1278, 1275, 1241, 1235,
+  1272, 1266, 1289, 1235, 1229, 1263, 1297, 1253, 1248, 1223, 1241, 1276, 1236, 1246, 1252, 1248,
+  1281, 1291, 1268, 1256, 1263, 1268, 1278, 1290, 1250, 1246, 1222, 1253, 1254, 1231, 1270, 1291,
+  1281, 1294, 1291, 1292, 1270, 1257, 1268, 1295, 1222, 1220, 1243, 1266, 1269, 1227, 1265, 1264,
+  1275, 1290, 1283, 1240, 1226, 1277, 1291, 1264, 1290, 1218, 1277, 1268, 1285, 1244, 1281, 1237,
+  1218, 1289, 1271, 1282, 1226, 1221, 1219, 1239, 1267, 1223, 1253, 1290, 1237, 1221, 1227, 1278,
+  1291, 1283, 1255, 1239, 1278, 1229, 1285, 1294, 1697, 1248, 1278, 1271, 1251, 1224, 1289, 1285,
+  1239, 1234, 1280, 1249, 1267, 1228, 1291, 1227, 1225, 1275, 1241, 1285, 1255, 1240, 1228, 1274,
+  1246, 1242, 1269, 1217, 1285, 1289, 1266, 1226, 1279, 1232, 1239, 1283, 1288, 1275, 1265, 1248,
+  1269, 1292, 1239, 1262, 1284, 1277, 1258, 1231, 1275, 1257, 1293, 1246, 1293, 1235, 1288, 1217,
+  1293, 1251, 1221, 1250, 1224, 1240, 1223, 1223, 1227, 1272, 1219, 1238, 1247, 1279, 1216, 1244,
+  1241, 1267, 1230, 1272, 1259, 1257, 1261, 1216, 1239, 1256, 1255, 1281, 1236, 1291, 1229, 1238,
+  1276, 1237, 1263, 1268, 1242, 1225, 1287, 1278, 1254, 1278, 1249, 1221, 1279, 1228, 1274, 1216,
+  1236, 1245, 1281, 1218, 1278, 1289, 1261, 1247, 1282, 1279, 1295, 1239, 1244, 1232, 1221, 1263,
+  1263, 1261, 1283, 1252, 1232, 1235, 1257, 1239, 1233, 1269, 1235, 1243, 1232, 1261, 1248, 1234,
+  1231, 1262, 1217, 1282, 1281, 1238, 1215, 1277, 1226, 1276, 1216, 1215, 1252, 1273, 1273, 1268,
+  1220, 1252, 1286, 1269, 1264, 1251, 1249, 1243, 1256, 1292, 1279, 1244, 1290, 1264, 1263, 1257,
+  1261, 1221, 1221, 1256, 1230, 1277, 1239, 1226, 1270, 1227, 1263, 1232, 1216, 1214, 1226, 1274,
+  1251, 1247, 1231, 1235, 1268, 1240, 1218, 1233, 1231, 1259, 1283, 1251, 1257, 1274, 1281, 1289,
+  1258, 1292, 1273, 1259, 1260, 1249, 1285, 1220, 1271, 1221, 1234, 1243, 1266, 1242, 1245, 1270,
+  1277, 1230, 1280, 1232, 1269, 1237, 1274, 1281, 1282, 1272, 1265, 1218, 1273, 1231, 1265, 1223,
+  1213, 1274, 1232, 1258, 1288, 1222, 1223, 1276, 1224, 1291, 1287, 1284, 1233, 1215, 1249, 1214,
+  1277, 1292, 1228, 1271, 1231, 1264, 1286, 1265, 1274, 1220, 1282, 1269, 1256, 1225, 1252, 1241,
+  1253, 1232, 1233, 1226, 1244, 1252, 1241, 1215, 1259, 1259, 1216, 1241, 1281, 1214, 1233, 1268,
+  1287, 1233, 1229, 1289, 1214, 1253, 1281, 1271, 1286, 1257, 1267, 1212, 1221, 1252, 1278, 1251,
+  1242, 1258, 1288, 1225, 1239, 1223, 1284, 1227, 1248, 1217, 1255, 1249, 1275, 1231, 1274, 1246,
+  1242, 1279, 1237, 1231, 1218, 1279, 1283, 1274, 1217, 1248, 1271, 1264, 1280, 1218, 1217, 1287,
+  1264, 1232, 1289, 1244, 1240, 1247, 1215, 1230, 1276, 1280, 1272, 1287, 1258, 1244, 1282, 1246,
+  1291, 1285, 1238, 1661, 1250, 1233, 1213, 1263, 1244, 1223, 1251, 1245, 1254, 1258, 1273, 1218,
+  1224, 1243, 1280, 1231, 1262, 1213, 1269, 1247, 1273, 1255, 1265, 1287, 1218, 1249, 1256, 1244,
+  1211, 1261, 1269, 1285, 1216, 1229, 1239, 1276, 1244, 1249, 1244, 1263, 1240, 1270, 1259, 1222,
+  1248, 1276, 1256, 1214, 1274, 1217, 1275, 1284, 1289, 1229, 1257, 1279, 1267, 1239, 1229, 1287,
+  1288, 1290, 1211, 1274, 1218, 1289, 1226, 1247, 1272, 1272, 1242, 1259, 1282, 1280, 1264, 1211,
+  1267, 1231, 1264, 1210, 1278, 1242, 1229, 1247, 1288, 1257, 1268, 1249, 1252, 1239, 1247, 1265,
+  1211, 1265, 1254, 1211, 1284, 1267, 1259, 1225, 1223, 1254, 1253, 1255, 1236, 1230, 1273, 1257,
+  1271, 1227, 1242, 1256, 1254, 1220, 1239, 1211, 1257, 1277, 1229, 1228, 1259, 1229, 1280, 1237,
+  1265, 1247, 1220, 1263, 1268, 1253, 1229, 1234, 1258, 1272, 1212, 1213, 1262, 1221, 1239, 1250,
+  1278, 1264, 1218, 1245, 1252, 1241, 1218, 1231, 1210, 1268, 1237, 1265, 1286, 1270, 1264, 1243,
+  1282, 1252, 1259, 1213, 1253, 1256, 1234, 1278, 1245, 1284, 1220, 1271, 1271, 1271, 1242, 1218,
+  1254, 1216, 1225, 1251, 1228, 1233, 1211, 1260, 1270, 1244, 1238, 1266, 1236, 1259, 1263, 1219,
+  1281, 1255, 1209, 1262, 1230, 1283, 1261, 1258, 1240, 1283, 1228, 1262, 1239, 1237, 1251, 1245,
+  1271, 1237, 1225, 1282, 1285, 1282, 1225, 1225, 1266, 1258, 1266, 1236, 1238, 1249, 1230, 1239,
+  1227, 1266, 1235, 1228, 1256, 1258, 1263, 1212, 1246, 1219, 1271, 1281, 1210, 1210, 1281, 1235,
+  1271, 1276, 1266, 1207, 1275, 1229, 1240, 1276, 1216, 1239, 1281, 1276, 1252, 1214, 1244, 1274,
+  1276, 1256, 1271, 1268, 1215, 1263, 1241, 1234, 1216, 1241, 1236, 1277, 1218, 1283, 1235, 1227,
+  1220, 1242, 1245, 1230, 1277, 1235, 1279, 1214, 1245, 1234, 1252, 1265, 1223, 1282, 1271, 1272,
+  1209, 1230, 1255, 1234, 1221, 1215, 1244, 1240, 1207, 1216, 1253, 1219, 1280, 1223, 1223, 1239,
+  1274, 1241, 1227, 1252, 1277, 1218, 1256, 1224, 1264, 1250, 1236, 1260, 1244, 1261, 1245, 1241,
+  1235, 1234, 1217, 1238, 1213, 1272, 1209, 1278, 1224, 1207, 1223, 1251, 1244, 1277, 1244, 1265,
+  1216, 1255, 1282, 1274, 1248, 1252, 1209, 1223, 1213, 1247, 1214, 1255, 1236, 1275, 780, 1271,
+  1268, 1270, 1247, 1279, 1267, 1278, 1217, 1223, 1236, 1212, 1216, 1265, 1207, 1264, 1278, 1256,
+  1224, 1250, 1233, 1233, 1250, 1227, 1269, 1221, 1225, 1258, 1261, 1266, 1205, 1252, 1240, 1260,
+  1212, 1219, 1249, 1255, 1272, 1244, 1223, 1263, 1279, 1216, 1215, 1245, 1254, 1214, 1229, 1233,
+  1208, 1216, 1243, 1260, 1284, 1205, 1236, 1281, 1223, 1206, 1227, 1232, 1253, 1231, 1250, 1255,
+  1223, 1272, 1246, 1282, 1275, 1264, 1279, 1273, 1275, 1235, 1205, 1232, 1256, 1237, 1204, 1251,
+  1220, 1276, 1277, 1265, 1259, 1244, 1215, 1256, 1235, 1225, 1281, 1255, 1214, 1209, 1271, 1255,
+  1255, 1248, 1259, 1251, 1263, 1225, 1265, 1210, 1275, 1281, 1242, 1264, 1209, 1279, 1268, 1203,
+  1234, 1210, 1244, 1252, 1241, 1255, 1277, 1275, 1212, 1247, 1245, 1207, 1203, 1279, 1275, 1205,
+  1220, 1212, 1247, 1279, 1220, 1220, 1280, 1216, 1212, 1210, 1239, 1205, 1267, 1256, 1225, 1251,
+  1261, 1207, 1232, 1212, 1213, 1275, 1229, 1255, 1226, 1213, 1282, 1265, 1253, 1260, 1214, 1241,
+  1226, 1237, 1265, 1231, 1208, 1231, 1239, 1222, 1214, 1206, 1205, 1227, 1261, 1212, 1253, 1261,
+  1268, 1224, 1264, 1205, 1236, 1228, 1253, 1223, 1223, 1232, 1250, 1276, 1232, 1258, 1257, 1204,
+  1260, 1243, 1228, 1280, 1204, 1206, 1275, 1268, 1207, 1221, 1249, 1250, 1257, 1236, 1272, 1209,
+  1261, 1225, 1224, 1276, 1206, 1249, 1273, 1229, 1268, 1259, 1266, 1233, 1248, 1268, 1229, 1203,
+  1268, 1237, 1225, 1267, 1266, 1221, 1259, 1259, 1235, 1216, 1256, 1261, 1243, 1227, 1254, 1258,
+  1203, 1262, 1251, 1219, 1258, 1275, 1268, 1273, 1223, 1258, 1224, 1276, 1244, 1252, 1255, 1215,
+  1229, 1235, 1206, 1257, 1208, 1241, 1279, 1209, 1218, 1237, 1209, 1233, 1202, 1211, 1234, 1278,
+  1255, 1232, 1262, 1216, 1206, 1216, 1275, 1223, 1229, 1280, 1276, 1213, 1244, 1219, 1276, 1244,
+  1245, 1259, 1216, 1228, 1240, 1276, 1240, 1238, 1276, 1259, 1268, 1209, 1273, 1260, 1220, 1248,
+  1213, 1203, 1272, 1275, 1260, 1265, 1227, 1214, 1222, 1223, 1271, 1240, 1267, 1225, 1210, 1241,
+  1210, 1261, 1239, 1220, 1252, 1224, 1266, 1256, 1244, 1264, 1210, 1219, 1276, 1255, 1201, 1252,
+  1234, 1249, 1233, 1233, 1227, 1264, 1277, 1247, 1258, 782, 1221, 1250, 1216, 1274, 1265, 1220,
+  1276, 1275, 1265, 1210, 1273, 1217, 1277, 1235, 1242, 1231, 1279, 1267, 1205, 1221, 1244, 1271,
+  1211, 1274, 1234, 1232, 1265, 1234, 1273, 1268, 1222, 1212, 1246, 1206, 1262, 1261, 1244, 1247,
+  1272, 1263, 1219, 1238, 1255, 1252, 1266, 1242, 1269, 1224, 1233, 1218, 1243, 1223, 1203, 1234,
+  1258, 1224, 1248, 1238, 1204, 1205, 1268, 1223, 1273, 1264, 1233, 1229, 1244, 1263, 1211, 1218,
+  1220, 1239, 1248, 1218, 1212, 1266, 1214, 1212, 1270, 1260, 1234, 1260, 1234, 1207, 1218, 1231,
+  1247, 1245, 1235, 1206, 1227, 1274, 1238, 1210, 1233, 1230, 1248, 1248, 1247, 1268, 1228, 1262,
+  1260, 1257, 1264, 1267, 1233, 1211, 1219, 1212, 1258, 1265, 1261, 1202, 1248, 1230, 1244, 1247,
+  1201, 1201, 1221, 1252, 1204, 1264, 1214, 1274, 1198, 1206, 1264, 1269, 1247, 1243, 1224, 1222,
+  1221, 1227, 1248, 1263, 1213, 1260, 1247, 1265, 1252, 1266, 1201, 1249, 1243, 1248, 1264, 1226,
+  1232, 1212, 1220, 1252, 1218, 1213, 1257, 1256, 1272, 1226, 1242, 1218, 1264, 1211, 1235, 1220,
+  1257, 1237, 1247, 1240, 1256, 1239, 1211, 1272, 1198, 1224, 1249, 1205, 1225, 1272, 1208, 1228,
+  1219, 1254, 1232, 1238, 1234, 1219, 1213, 1198, 1245, 1263, 1209, 1256, 1208, 1254, 1246, 1255,
+  1211, 1234, 1216, 1229, 1274, 1274, 1213, 1252, 1213, 1201, 1265, 1270, 1247, 1214, 1274, 1271,
+  1208, 1242, 1248, 1241, 1268, 1275, 1198, 1256, 1236, 1225, 1263, 1223, 1197, 1271, 1269, 1204,
+  1254, 1261, 1257, 1258, 1225, 1229, 1222, 1261, 1256, 1274, 1261, 1243, 1248, 1199, 1208, 1249,
+  1254, 1268, 1243, 1208, 1223, 1274, 1274, 1224, 1210, 1198, 1245, 1196, 1234, 1216, 1262, 1221,
+  1243, 1220, 1222, 1275, 1195, 1264, 1232, 1232, 1220, 1219, 1232, 1239, 1218, 1254, 1263, 1258,
+  1258, 1203, 1261, 1245, 1207, 1245, 1210, 1256, 1222, 1207, 1226, 1248, 1210, 1265, 1213, 1257,
+  1204, 1267, 1266, 1222, 1238, 1198, 1268, 1217, 1239, 1227, 1244, 1211, 1272, 1220, 1238, 1265,
+  1208, 1252, 1253, 1214, 1219, 1195, 1203, 1221, 1251, 1213, 1266, 1214, 1226, 1249, 1214, 1223,
+  1249, 1260, 1215, 1202, 1216, 1225, 1220, 1225, 1220, 1270, 1267, 1271, 1252, 1238, 1201, 1201,
+  1262, 1242, 1238, 1215, 1673, 1239, 1267, 1206, 1195, 1248, 1241, 1269, 1216, 1229, 1225, 1257,
+  1231, 1203, 1234, 1195, 1199, 1248, 1220, 1233, 1256, 1262, 1207, 1210, 1265, 1249, 1269, 1263,
+  1253, 1223, 1266, 1233, 1265, 1250, 1258, 1243, 1230, 1207, 1237, 1211, 1272, 1245, 1246, 1198,
+  1232, 1268, 1253, 1214, 1271, 1217, 1207, 1200, 1269, 1256, 1204, 1242, 1237, 1263, 1234, 1223,
+  1226, 1200, 1221, 1227, 1208, 1195, 1256, 1205, 1252, 1244, 1266, 1216, 1262, 1200, 1229, 1207,
+  1251, 1199, 1193, 1195, 1248, 1260, 1227, 1206, 1252, 1262, 1206, 1256, 1225, 1235, 1215, 1240,
+  1198, 1233, 1255, 1233, 1251, 1222, 1202, 1263, 1212, 1206, 1230, 1252, 1246, 1218, 1232, 1265,
+  1214, 1250, 1227, 1270, 1236, 1219, 1198, 1266, 1246, 1203, 1234, 1204, 1199, 1262, 1210, 1262,
+  1223, 1209, 1216, 1246, 1210, 1265, 1233, 1196, 1239, 1248, 1270, 1256, 1263, 1210, 1193, 1203,
+  1225, 1264, 1203, 1217, 1239, 1201, 1237, 1242, 1229, 1229, 1225, 1245, 1268, 1229, 1255, 1241,
+  1214, 1244, 1193, 1228, 1197, 1206, 1203, 1269, 1240, 1196, 1201, 1212, 1250, 1196, 1246, 1259,
+  1243, 1232, 1206, 1262, 1237, 1264, 1257, 1245, 1195, 1235, 1195, 1270, 1196, 1210, 1263, 1221,
+  1260, 1203, 1270, 1270, 1220, 1196, 1245, 1196, 1220, 1258, 1239, 1233, 1199, 1222, 1242, 1199,
+  1249, 1210, 1242, 1200, 1268, 1251, 1209, 1231, 1238, 1267, 1238, 1212, 1205, 1224, 1265, 1248,
+  1228, 1256, 1210, 1269, 1267, 1252, 1209, 1257, 1198, 1233, 1196, 1238, 1243, 1202, 1231, 1194,
+  1237, 1244, 1232, 1191, 1267, 1192, 1242, 1244, 1227, 1197, 1205, 1215, 1256, 1240, 1247, 1221,
+  1244, 1244, 1253, 1249, 1222, 1258, 1222, 1260, 1216, 1227, 1200, 1192, 1250, 1237, 1219, 1265,
+  1221, 1206, 1254, 1204, 1228, 1226, 1221, 1257, 1211, 1204, 1263, 1230, 1206, 1253, 1236, 1203,
+  1209, 1231, 1238, 1203, 1267, 1207, 1209, 1263, 1248, 1253, 1219, 1191, 1227, 1218, 1250, 1200,
+  1232, 1196, 1224, 1254, 1202, 1199, 1211, 1250, 1256, 1214, 1259, 1254, 1210, 1206, 1215, 1265,
+  1203, 1191, 1238, 1252, 1241, 1198, 1212, 1247, 1210, 1232, 1217, 1217, 1236, 1221, 1246, 1194,
+  1238, 1223, 1218, 1247, 1216, 1225, 1232, 1209, 1202, 1223, 1196, 1253, 1240, 1229, 1204, 1696,
+  1247, 1247, 1241, 1202, 1198, 1232, 1204, 1192, 1232, 1237, 1218, 1240, 1189, 1247, 1210, 1226,
+  1200, 1225, 1212, 1196, 1204, 1264, 1209, 1232, 1213, 1234, 1241, 1247, 1240, 1261, 1234, 1204,
+  1267, 1255, 1227, 1262, 1203, 1224, 1213, 1224, 1228, 1239, 1192, 1257, 1254, 1249, 1217, 1198,
+  1191, 1236, 1229, 1205, 1225, 1241, 1252, 1223, 1232, 1212, 1197, 1238, 1264, 1242, 1241, 1218,
+  1266, 1250, 1232, 1195, 1235, 1265, 1198, 1192, 1264, 1258, 1262, 1203, 1256, 1206, 1194, 1256,
+  1245, 1235, 1264, 1204, 1244, 1218, 1188, 1230, 1237, 1206, 1229, 1198, 1195, 1198, 1209, 1195,
+  1250, 1216, 1245, 1230, 1262, 1226, 1254, 1241, 1210, 1249, 1201, 1212, 1221, 1190, 1206, 1198,
+  1241, 1209, 1250, 1211, 1245, 1206, 1193, 1245, 1254, 1208, 1254, 1249, 1193, 1222, 1248, 1221,
+  1209, 1216, 1224, 1253, 1204, 1258, 1241, 1211, 1245, 1245, 1227, 1235, 1203, 1231, 1246, 1240,
+  1203, 1216, 1248, 1222, 1238, 1253, 1214, 1200, 1214, 1210, 1234, 1252, 1205, 1201, 1233, 1242,
+  1202, 1231, 1253, 1209, 1244, 1227, 1187, 1202, 1214, 1195, 1208, 1202, 1204, 1234, 1233, 1216,
+  1223, 1237, 1208, 1209, 1262, 1206, 1200, 1202, 1196, 1200, 1259, 1203, 1207, 1219, 1209, 1220,
+  1195, 1238, 1227, 1260, 1194, 1199, 1208, 1251, 1191, 1206, 1218, 1257, 1253, 1224, 1256, 1215,
+  1223, 1248, 1204, 1203, 1224, 1187, 1193, 1216, 1187, 1244, 1229, 1238, 1202, 1241, 1227, 1214,
+  1222, 1211, 1243, 1225, 1214, 1195, 1189, 1251, 1236, 1223, 1218, 1205, 1246, 1263, 1249, 1188,
+  1189, 1223, 1202, 1212, 1215, 1199, 1238, 1225, 1243, 1244, 1247, 1230, 1220, 1187, 1187, 1221,
+  1225, 1205, 1210, 1221, 1253, 1197, 1259, 1194, 1237, 1187, 1218, 1228, 1188, 1210, 1236, 1259,
+  1256, 1213, 1212, 1223, 1199, 1199, 1232, 1230, 1244, 1262, 1228, 1188, 1239, 1254, 1234, 1257,
+  1212, 1189, 1242, 1262, 1203, 1220, 1236, 1249, 1231, 1198, 1195, 1243, 1191, 1201, 1246, 1252,
+  1227, 1187, 1212, 1197, 1242, 1184, 1235, 1247, 1220, 1196, 1212, 1259, 1184, 1199, 1202, 1192,
+  1260, 1210, 1262, 1260, 1228, 1240, 1188, 1203, 1239, 1194, 1253, 1227, 1233, 1252, 1238, 1248,
+  1212, 1192, 1230, 1237, 1201, 1187, 1238, 1233, 1189, 1261, 1656, 1249, 1213, 1253, 1238, 1192,
+  1234, 1240, 1184, 1198, 1189, 1186, 1260, 1194, 1188, 1223, 1214, 1240, 1252, 1256, 1185, 1229,
+  1191, 1258, 1258, 1200, 1199, 1237, 1240, 1234, 1192, 1187, 1261, 1254, 1208, 1237, 1221, 1220,
+  1223, 1193, 1222, 1249, 1197, 1232, 1240, 1252, 1192, 1225, 1215, 1248, 1213, 1194, 1260, 1203,
+  1225, 1257, 1239, 1229, 1250, 1238, 1259, 1187, 1198, 1257, 1214, 1206, 1211, 1249, 1226, 1223,
+  1218, 1187, 1218, 1226, 1191, 1255, 1224, 1240, 1217, 1186, 1219, 1238, 1260, 1191, 1206, 1205,
+  1255, 1237, 1210, 1228, 1244, 1251, 1217, 1188, 1248, 1248, 1246, 1221, 1208, 1233, 1195, 1226,
+  1255, 1252, 1233, 1242, 1216, 1190, 1228, 1211, 1189, 1240, 1192, 1219, 1238, 1235, 1253, 1217,
+  1235, 1254, 1184, 1241, 1206, 1218, 1220, 1204, 1228, 1196, 1231, 1201, 1222, 1221, 1248, 1244,
+  1212, 1230, 1228, 1196, 1195, 1219, 1205, 1206, 1192, 1249, 1238, 1227, 1188, 1242, 1250, 1206,
+  1200, 1250, 1228, 1183, 1196, 1244, 1230, 1190, 1180, 1188, 1183, 1238, 1233, 1252, 1201, 1197,
+  1198, 1248, 1218, 1255, 1247, 1216, 1208, 1253, 1229, 1202, 1198, 1247, 1190, 1214, 1223, 1207,
+  1181, 1218, 1228, 1234, 1234, 1205, 1228, 1247, 1227, 1196, 1250, 1209, 1179, 1212, 1210, 1236,
+  1246, 1241, 1198, 1215, 1209, 1217, 1225, 1207, 1220, 1216, 1210, 1210, 1200, 1241, 1216, 1242,
+  1208, 1196, 1206, 1203, 1215, 1222, 1211, 1224, 1245, 1241, 1241, 1179, 1196, 1235, 1206, 1255,
+  1223, 1191, 1220, 1218, 1197, 1188, 1183, 1232, 1240, 1214, 1231, 1236, 1212, 1181, 1209, 1242,
+  1226, 1190, 1244, 1246, 1233, 1185, 1195, 1199, 1191, 1231, 1181, 1242, 1217, 1224, 1220, 1220,
+  1233, 1207, 1233, 1192, 1203, 1183, 1187, 1238, 1205, 1250, 1195, 1230, 1178, 1219, 1200, 1204,
+  1179, 1254, 1240, 1227, 1179, 1232, 1213, 1236, 1178, 1202, 1232, 1197, 1211, 1245, 1219, 1240,
+  1220, 1208, 1245, 1256, 1256, 1182, 1196, 1204, 1187, 1182, 1253, 1208, 1248, 1229, 1206, 1193,
+  1249, 1248, 1228, 1196, 1221, 1187, 1234, 1227, 1237, 1237, 1214, 1192, 1188, 1217, 1186, 1256,
+  1204, 1239, 1239, 1235, 1184, 1255, 1192, 1255, 1255, 1237, 1214, 1210, 1208, 1249, 1181, 1182,
+  1215, 1242, 1223, 1232, 1246, 1651, 1211, 1236, 1225, 1245, 1244, 1192, 1223, 1205, 1193, 1201,
+  1231, 1177, 1220, 1251, 1236, 1249, 1184, 1236, 1209, 1183, 1227, 1202, 1249, 1254, 1210, 1253,
+  1192, 1215, 1201, 1177, 1195, 1178, 1216, 1201, 1186, 1179, 1234, 1227, 1195, 1215, 1205, 1228,
+  1244, 1240, 1251, 1201, 1209, 1223, 1253, 1196, 1180, 1245, 1193, 1252, 1202, 1255, 1226, 1217,
+  1182, 1252, 1236, 1215, 1176, 1208, 1175, 1235, 1185, 1249, 1233, 1252, 1231, 1253, 1193, 1217,
+  1227, 1183, 1236, 1212, 1186, 1224, 1228, 1194, 1199, 1221, 1235, 1177, 1253, 1189, 1244, 1199,
+  1181, 1200, 1179, 1199, 1237, 1218, 1251, 1199, 1254, 1185, 1180, 1186, 1199, 1214, 1207, 1178,
+  1254, 1221, 1189, 1183, 1184, 1222, 1187, 1212, 1203, 1229, 1182, 1234, 1230, 1240, 1187, 1206,
+  1210, 1221, 1218, 1245, 1242, 1185, 1193, 1190, 1234, 1175, 1198, 1224, 1211, 1250, 1202, 1199,
+  1206, 1225, 1232, 1207, 1228, 1203, 1192, 1227, 1177, 1206, 1215, 1237, 1213, 1208, 1205, 1247,
+  1175, 1217, 1248, 1186, 1220, 1186, 1219, 1226, 1174, 1223, 1202, 1200, 1229, 1210, 1202, 1205,
+  1176, 1206, 1196, 1178, 1194, 1252, 1214, 1212, 1232, 1226, 1220, 1198, 1205, 1233, 1196, 1244,
+  1188, 1225, 1194, 1214, 1208, 1233, 1211, 1238, 1249, 1231, 1212, 1223, 1224, 1203, 1219, 1198,
+  1218, 1230, 1177, 1185, 1200, 1229, 1210, 1220, 1207, 1179, 1191, 1246, 1220, 1229, 1204, 1198,
+  1251, 1181, 1247, 1237, 1251, 1196, 1203, 1239, 1201, 1241, 1195, 1202, 1249, 1192, 1252, 1179,
+  1199, 1182, 1221, 1195, 1216, 1175, 1208, 1220, 1229, 1175, 1230, 1227, 1198, 1211, 1183, 1190,
+  1173, 1238, 1224, 1201, 1240, 1203, 1214, 1236, 1222, 1190, 1227, 1242, 1211, 1239, 1206, 1225,
+  1192, 1242, 1239, 1214, 1218, 1224, 1219, 1179, 1233, 1219, 1226, 1186, 1246, 1210, 1231, 1214,
+  1210, 1207, 1213, 1249, 1235, 1239, 1251, 1234, 1229, 1231, 1250, 1246, 1180, 1186, 1216, 1172,
+  1234, 1171, 1251, 1203, 1189, 1213, 1245, 1223, 1200, 1216, 1175, 1205, 1241, 1193, 1198, 1186,
+  1186, 1195, 1245, 1244, 1224, 1228, 1228, 1238, 1188, 1179, 1236, 1234, 1236, 1207, 1243, 1171,
+  1176, 1186, 1225, 1243, 1199, 1231, 1193, 1232, 1239, 1207, 1182, 1242, 1224, 1226, 1237, 1176,
+  761, 1224, 1243, 1200, 1188, 1207, 1247, 1192, 1222, 1181, 1185, 1224, 1179, 1235, 1214, 1230,
+  1241, 1235, 1210, 1247, 1229, 1201, 1246, 1188, 1210, 1217, 1215, 1245, 1234, 1172, 1174, 1205,
+  1232, 1236, 1183, 1247, 1239, 1238, 1181, 1222, 1209, 1192, 1193, 1238, 1233, 1210, 1208, 1180,
+  1187, 1223, 1180, 1179, 1172, 1229, 1223, 1171, 1221, 1202, 1237, 1203, 1237, 1212, 1245, 1214,
+  1224, 1238, 1196, 1213, 1196, 1197, 1195, 1225, 1204, 1242, 1233, 1221, 1199, 1170, 1218, 1175,
+  1174, 1239, 1185, 1249, 1205, 1230, 1197, 1198, 1215, 1241, 1221, 1243, 1193, 1235, 1214, 1170,
+  1203, 1213, 1215, 1195, 1210, 1190, 1202, 1197, 1169, 1169, 1233, 1201, 1244, 1187, 1226, 1173,
+  1169, 1201, 1215, 1236, 1169, 1222, 1200, 1170, 1223, 1229, 1195, 1198, 1239, 1186, 1222, 1216,
+  1245, 1173, 1207, 1219, 1213, 1227, 1192, 1181, 1206, 1243, 1243, 1215, 1233, 1241, 1213, 1179,
+  1196, 1214, 1216, 1170, 1243, 1209, 1181, 1194, 1172, 1248, 1227, 1226, 1207, 1238, 1248, 1220,
+  1243, 1236, 1179, 1237, 1233, 1228, 1236, 1188, 1230, 1199, 1187, 1226, 1209, 1216, 1237, 1245,
+  1178, 1168, 1175, 1246, 1224, 1186, 1247, 1183, 1211, 1246, 1180, 1178, 1189, 1231, 1188, 1178,
+  1228, 1227, 1174, 1207, 1234, 1181, 1237, 1195, 1218, 1200, 1189, 1206, 1230, 1228, 1192, 1231,
+  1172, 1225, 1192, 1187, 1246, 1213, 1184, 1180, 1221, 1202, 1196, 1227, 1213, 1232, 1176, 1214,
+  1207, 1241, 1194, 1178, 1200, 1219, 1179, 1228, 1202, 1196, 1169, 1214, 1213, 1216, 1211, 1204,
+  1218, 1171, 1169, 1205, 1221, 1178, 1172, 1193, 1226, 1197, 1214, 1236, 1245, 1216, 1184, 1179,
+  1167, 1239, 1197, 1203, 1210, 1225, 1203, 1201, 1191, 1244, 1245, 1237, 1175, 1192, 1185, 1200,
+  1167, 1222, 1202, 1198, 1236, 1198, 1232, 1200, 1222, 1185, 1212, 1235, 1189, 1226, 1180, 1211,
+  1230, 1208, 1179, 1184, 1203, 1228, 1208, 1233, 1174, 1191, 1173, 1188, 1226, 1229, 1240, 1221,
+  1174, 1219, 1186, 1231, 1240, 1214, 1220, 1225, 1187, 1224, 1203, 1183, 1204, 1212, 1211, 1177,
+  1177, 1245, 1173, 1192, 1214, 1165, 1168, 1173, 1194, 1229, 1224, 1229, 1176, 1233, 1183, 1236,
+  1206, 1192, 1214, 1218, 1196, 1238, 1231, 1179, 1234, 1241, 1238, 1654, 1191, 1241, 1231, 1166,
+  1233, 1172, 1224, 1215, 1201, 1218, 1237, 1196, 1179, 1231, 1209, 1173, 1174, 1215, 1183, 1211,
+  1199, 1175, 1240, 1165, 1188, 1198, 1182, 1214, 1190, 1168, 1192, 1224, 1169, 1230, 1173, 1173,
+  1164, 1202, 1203, 1197, 1167, 1168, 1206, 1177, 1208, 1221, 1224, 1221, 1172, 1217, 1207, 1193,
+  1243, 1236, 1225, 1227, 1209, 1208, 1241, 1197, 1213, 1198, 1205, 1238, 1218, 1219, 1172, 1230,
+  1216, 1171, 1223, 1168, 1202, 1226, 1233, 1197, 1191, 1178, 1218, 1182, 1172, 1227, 1181, 1214,
+  1198, 1203, 1189, 1238, 1196, 1190, 1170, 1228, 1239, 1174, 1233, 1182, 1238, 1163, 1205, 1189,
+  1194, 1182, 1222, 1233, 1195, 1199, 1194, 1210, 1193, 1207, 1223, 1177, 1189, 1199, 1184, 1233,
+  1204, 1238, 1235, 1233, 1188, 1229, 1230, 1171, 1224, 1216, 1190, 1226, 1197, 1177, 1215, 1198,
+  1173, 1215, 1228, 1195, 1178, 1208, 1175, 1229, 1222, 1208, 1198, 1182, 1224, 1166, 1183, 1187,
+  1186, 1220, 1234, 1182, 1213, 1165, 1171, 1187, 1232, 1164, 1239, 1235, 1210, 1211, 1192, 1222,
+  1173, 1211, 1195, 1193, 1175, 1216, 1230, 1163, 1238, 1198, 1189, 1191, 1185, 1239, 1194, 1231,
+  1181, 1228, 1225, 1235, 1208, 1239, 1190, 1176, 1196, 1215, 1230, 1173, 1219, 1214, 1177, 1204,
+  1163, 1224, 1166, 1227, 1194, 1180, 1219, 1220, 1224, 1233, 1170, 1218, 1210, 1205, 1199, 1176,
+  1170, 1215, 1173, 1238, 1176, 1207, 1211, 1173, 1233, 1203, 1182, 1181, 1235, 1214, 1175, 1225,
+  1219, 1188, 1189, 1231, 1232, 1216, 1210, 1185, 1195, 1166, 1202, 1211, 1181, 1169, 1228, 1212,
+  1164, 1174, 1212, 1215, 1187, 1224, 1205, 1191, 1172, 1239, 1198, 1177, 1174, 1233, 1239, 1182,
+  1205, 1234, 1163, 1237, 1195, 1198, 1238, 1220, 1190, 1207, 1195, 1218, 1210, 1234, 1198, 1186,
+  1199, 1215, 1162, 1209, 1219, 1203, 1193, 1224, 1186, 1233, 1232, 1177, 1182, 1214, 1231, 1193,
+  1170, 1212, 1232, 1217, 1213, 1236, 1227, 1226, 1198, 1205, 1226, 1224, 1236, 1180, 1234, 1161,
+  1180, 1165, 1172, 1197, 1238, 1212, 1160, 1238, 1236, 1211, 1164, 1214, 1232, 1174, 1220, 1189,
+  1195, 1166, 1227, 1238, 1167, 1198, 1227, 1160, 1233, 1205, 1217, 1231, 1185, 1184, 1189, 1181,
+  1199, 1209, 1237, 1177, 1198, 1239, 772, 1232, 1238, 1202, 1180, 1204, 1211, 1161, 1161, 1224,
+  1181, 1229, 1225, 1163, 1190, 1175, 1197, 1179, 1209, 1180, 1178, 1211, 1182, 1203, 1183, 1216,
+  1170, 1202, 1162, 1198, 1188, 1219, 1214, 1191, 1175, 1161, 1222, 1205, 1179, 1219, 1238, 1231,
+  1218, 1164, 1202, 1215, 1236, 1219, 1169, 1186, 1179, 1215, 1182, 1215, 1187, 1222, 1165, 1219,
+  1227, 1236, 1185, 1168, 1200, 1202, 1162, 1236, 1162, 1184, 1187, 1170, 1168, 1203, 1204, 1218,
+  1194, 1207, 1208, 1166, 1196, 1230, 1207, 1192, 1192, 1188, 1219, 1167, 1208, 1162, 1182, 1222,
+  1197, 1199, 1213, 1182, 1177, 1186, 1221, 1199, 1215, 1181, 1178, 1182, 1188, 1214, 1224, 1213,
+  1227, 1220, 1221, 1165, 1168, 1209, 1177, 1162, 1203, 1213, 1200, 1182, 1173, 1225, 1185, 1188,
+  1176, 1196, 1234, 1225, 1174, 1157, 1169, 1179, 1228, 1229, 1157, 1231, 1164, 1157, 1197, 1191,
+  1230, 1234, 1236, 1189, 1169, 1204, 1165, 1169, 1206, 1171, 1215, 1204, 1167, 1181, 1183, 1185,
+  1215, 1180, 1172, 1186, 1167, 1226, 1158, 1223, 1213, 1174, 1180, 1214, 1182, 1226, 1163, 1157,
+  1233, 1204, 1187, 1202, 1211, 1231, 1234, 1234, 1232, 1192, 1211, 1164, 1194, 1168, 1164, 1232,
+  1165, 1192, 1209, 1184, 1206, 1232, 1161, 1165, 1220, 1189, 1165, 1177, 1162, 1182, 1215, 1221,
+  1226, 1175, 1183, 1156, 1225, 1193, 1183, 1164, 1187, 1171, 1233, 1222, 1172, 1210, 1172, 1213,
+  1233, 1200, 1222, 1165, 1182, 1222, 1205, 1187, 1175, 1213, 1205, 1231, 1183, 1233, 1188, 1202,
+  1235, 1200, 1193, 1232, 1220, 1200, 1189, 1195, 1177, 1173, 1184, 1204, 1180, 1220, 1228, 1200,
+  1183, 1181, 1189, 1222, 1222, 1210, 1218, 1178, 1202, 1195, 1171, 1158, 1162, 1157, 1213, 1186,
+  1163, 1178, 1201, 1195, 1201, 1170, 1168, 1189, 1186, 1189, 1222, 1163, 1213, 1158, 1172, 1214,
+  1219, 1198, 1185, 1195, 1210, 1178, 1182, 1213, 1223, 1170, 1191, 1205, 1172, 1176, 1156, 1206,
+  1191, 1176, 1211, 1200, 1172, 1229, 1173, 1197, 1234, 1218, 1204, 1220, 1183, 1191, 1221, 1220,
+  1179, 1161, 1219, 1232, 1189, 1156, 1219, 1159, 1197, 1180, 1170, 1206, 1205, 1161, 1184, 1163,
+  1217, 1189, 1163, 1229, 1213, 1230, 1233, 1217, 1218, 1187, 1167, 1166, 1161, 1213, 1170, 1215,
+  1181, 780, 1230, 1197, 1220, 1188, 1225, 1200, 1196, 1194, 1224, 1169, 1192, 1201, 1226, 1179,
+  1219, 1174, 1171, 1162, 1233, 1195, 1195, 1155, 1189, 1161, 1175, 1214, 1169, 1189, 1220, 1220,
+  1169, 1221, 1231, 1191, 1175, 1166, 1171, 1188, 1195, 1201, 1230, 1212, 1154, 1165, 1191, 1209,
+  1195, 1220, 1224, 1176, 1186, 1205, 1182, 1176, 1166, 1177, 1172, 1167, 1206, 1189, 1206, 1169,
+  1232, 1218, 1187, 1207, 1191, 1204, 1185, 1232, 1163, 1232, 1181, 1157, 1221, 1177, 1201, 1158,
+  1215, 1214, 1172, 1167, 1166, 1226, 1180, 1214, 1228, 1221, 1228, 1164, 1203, 1216, 1168, 1176,
+  1200, 1155, 1195, 1197, 1169, 1176, 1159, 1200, 1172, 1181, 1181, 1225, 1214, 1230, 1187, 1155,
+  1223, 1165, 1186, 1207, 1214, 1196, 1216, 1155, 1170, 1158, 1161, 1183, 1165, 1214, 1213, 1190,
+  1181, 1213, 1181, 1189, 1215, 1169, 1176, 1160, 1223, 1202, 1165, 1155, 1163, 1219, 1188, 1207,
+  1172, 1183, 1187, 1203, 1182, 1194, 1186, 1165, 1196, 1191, 1179, 1204, 1224, 1186, 1152, 1195,
+  1211, 1186, 1218, 1211, 1164, 1171, 1184, 1216, 1163, 1226, 1210, 1164, 1222, 1174, 1190, 1196,
+  1180, 1151, 1161, 1222, 1207, 1195, 1172, 1207, 1198, 1219, 1155, 1200, 1159, 1191, 1225, 1214,
+  1174, 1210, 1207, 1207, 1217, 1224, 1161, 1189, 1167, 1202, 1226, 1226, 1196, 1183, 1206, 1204,
+  1215, 1213, 1162, 1166, 1155, 1150, 1205, 1201, 1155, 1159, 1189, 1224, 1199, 1186, 1219, 1226,
+  1200, 1196, 1196, 1199, 1224, 1190, 1190, 1179, 1178, 1175, 1187, 1151, 1176, 1152, 1198, 1190,
+  1171, 1209, 1153, 1177, 1180, 1151, 1183, 1186, 1213, 1186, 1212, 1168, 1219, 1184, 1190, 1169,
+  1187, 1152, 1221, 1208, 1161, 1227, 1224, 1162, 1227, 1209, 1216, 1150, 1220, 1203, 1153, 1149,
+  1191, 1158, 1163, 1152, 1161, 1184, 1192, 1157, 1207, 1172, 1220, 1158, 1220, 1179, 1219, 1177,
+  1202, 1186, 1225, 1169, 1213, 1153, 1160, 1153, 1191, 1225, 1183, 1187, 1195, 1198, 1168, 1195,
+  1184, 1173, 1209, 1228, 1186, 1215, 1183, 1226, 1217, 1167, 1195, 1159, 1172, 1218, 1175, 1184,
+  1158, 1181, 1219, 1177, 1211, 1159, 1166, 1204, 1195, 1161, 1185, 1148, 1174, 1215, 1206, 1159,
+  1148, 1148, 1215, 1217, 1152, 1186, 1218, 1224, 1173, 1158, 1190, 1214, 723, 1198, 1157, 1215,
+  1199, 1200, 1165, 1195, 1179, 1197, 1162, 1212, 1212, 1147, 1153, 1199, 1148, 1178, 1149, 1166,
+  1154, 1173, 1171, 1161, 1177, 1224, 1180, 1171, 1149, 1163, 1204, 1208, 1199, 1210, 1186, 1223,
+  1159, 1155, 1222, 1171, 1200, 1152, 1156, 1222, 1194, 1223, 1161, 1197, 1192, 1183, 1153, 1172,
+  1197, 1223, 1217, 1203, 1165, 1156, 1158, 1156, 1163, 1221, 1165, 1150, 1205, 1164, 1155, 1196,
+  1158, 1217, 1194, 1194, 1189, 1203, 1190, 1214, 1175, 1151, 1209, 1146, 1196, 1187, 1192, 1184,
+  1224, 1171, 1162, 1157, 1186, 1159, 1182, 1158, 1160, 1217, 1213, 1157, 1149, 1201, 1146, 1158,
+  1149, 1186, 1167, 1206, 1170, 1224, 1224, 1181, 1166, 1220, 1171, 1149, 1149, 1183, 1169, 1149,
+  1198, 1213, 1209, 1189, 1171, 1161, 1152, 1216, 1196, 1152, 1221, 1198, 1208, 1167, 1199, 1221,
+  1184, 1170, 1223, 1195, 1223, 1201, 1179, 1207, 1191, 1225, 1158, 1197, 1177, 1192, 1182, 1183,
+  1177, 1209, 1158, 1190, 1192, 1201, 1166, 1218, 1186, 1177, 1219, 1208, 1216, 1176, 1151, 1181,
+  1172, 1186, 1200, 1199, 1168, 1145, 1171, 1223, 1215, 1187, 1199, 1169, 1223, 1183, 1207, 1167,
+  1161, 1170, 1207, 1183, 1215, 1183, 1199, 1217, 1223, 1186, 1154, 1168, 1144, 1213, 1197, 1166,
+  1200, 1156, 1176, 1222, 1200, 1175, 1194, 1165, 1217, 1199, 1160, 1150, 1206, 1152, 1178, 1151,
+  1164, 1173, 1154, 1154, 1185, 1202, 1185, 1194, 1176, 1223, 1212, 1189, 1183, 1205, 1170, 1149,
+  1212, 1152, 1146, 1156, 1174, 1198, 1199, 1219, 1197, 1176, 1145, 1195, 1186, 1202, 1145, 1192,
+  1220, 1201, 1190, 1219, 1185, 1218, 1173, 1218, 1172, 1161, 1175, 1188, 1178, 1190, 1179, 1189,
+  1169, 1150, 1181, 1179, 1160, 1148, 1177, 1178, 1171, 1183, 1176, 1165, 1198, 1144, 1198, 1194,
+  1218, 1146, 1186, 1222, 1195, 1217, 1172, 1207, 1196, 1177, 1143, 1211, 1195, 1154, 1211, 1197,
+  1211, 1198, 1191, 1199, 1208, 1146, 1154, 1162, 1171, 1195, 1191, 1208, 1175, 1217, 1222, 1151,
+  1147, 1209, 1172, 1213, 1172, 1217, 1147, 1163, 1170, 1199, 1215, 1188, 1195, 1187, 1212, 1167,
+  1173, 1168, 1163, 1170, 1183, 1182, 1194, 1219, 1169, 1170, 1207, 1200, 1188, 1206, 1220, 1220,
+  1171, 1176, 1172, 1210, 1211, 1178, 1182, 1629, 1219, 1164, 1181, 1197, 1171, 1164, 1182, 1150,
+  1160, 1162, 1174, 1170, 1192, 1158, 1163, 1153, 1216, 1158, 1146, 1204, 1166, 1155, 1170, 1154,
+  1141, 1209, 1198, 1146, 1173, 1156, 1193, 1145, 1219, 1164, 1217, 1199, 1172, 1167, 1175, 1174,
+  1184, 1169, 1180, 1149, 1141, 1186, 1218, 1209, 1188, 1214, 1176, 1170, 1177, 1184, 1175, 1216,
+  1187, 1146, 1211, 1185, 1218, 1148, 1151, 1157, 1168, 1145, 1211, 1174, 1205, 1197, 1162, 1213,
+  1154, 1164, 1205, 1160, 1180, 1215, 1214, 1201, 1168, 1146, 1148, 1168, 1187, 1184, 1176, 1174,
+  1143, 1159, 1169, 1196, 1200, 1192, 1169, 1143, 1183, 1194, 1204, 1155, 1152, 1190, 1171, 1174,
+  1215, 1204, 1153, 1218, 1167, 1219, 1148, 1169, 1148, 1199, 1210, 1179, 1174, 1148, 1205, 1184,
+  1146, 1184, 1199, 1184, 1190, 1203, 1206, 1193, 1207, 1157, 1208, 1151, 1163, 1198, 1153, 1142,
+  1176, 1184, 1215, 1157, 1150, 1209, 1186, 1172, 1183, 1218, 1155, 1162, 1219, 1188, 1217, 1179,
+  1159, 1156, 1159, 1212, 1210, 1210, 1153, 1173, 1171, 1197, 1198, 1149, 1176, 1151, 1151, 1217,
+  1155, 1155, 1152, 1189, 1204, 1155, 1181, 1205, 1161, 1203, 1143, 1211, 1195, 1211, 1177, 1189,
+  1216, 1164, 1190, 1160, 1147, 1201, 1145, 1208, 1154, 1152, 1202, 1193, 1154, 1176, 1212, 1198,
+  1179, 1167, 1170, 1182, 1188, 1143, 1152, 1203, 1192, 1154, 1144, 1160, 1159, 1164, 1138, 1182,
+  1176, 1217, 1163, 1205, 1157, 1202, 1167, 1201, 1143, 1182, 1209, 1145, 1171, 1198, 1153, 1143,
+  1181, 1187, 1203, 1142, 1154, 1138, 1208, 1196, 1217, 1146, 1174, 1140, 1198, 1191, 1159, 1142,
+  1205, 1161, 1156, 1182, 1182, 1196, 1210, 1151, 1191, 1201, 1182, 1164, 1165, 1179, 1196, 1205,
+  1161, 1180, 1152, 1214, 1176, 1141, 1143, 1152, 1163, 1175, 1216, 1178, 1185, 1152, 1147, 1154,
+  1138, 1158, 1215, 1143, 1193, 1203, 1193, 1155, 1180, 1202, 1206, 1148, 1185, 1200, 1172, 1156,
+  1188, 1188, 1208, 1198, 1200, 1191, 1160, 1138, 1186, 1151, 1141, 1200, 1181, 1186, 1176, 1156,
+  1197, 1211, 1192, 1200, 1187, 1201, 1203, 1169, 1138, 1175, 1177, 1210, 1145, 1137, 1160, 1185,
+  1156, 1169, 1208, 1193, 1197, 1206, 1150, 1157, 1189, 1142, 1189, 1190, 1195, 1150, 1169, 1188,
+  1191, 1156, 1599, 1191, 1206, 1173, 1163, 1162, 1187, 1198, 1202, 1147, 1145, 1166, 1178, 1190,
+  1162, 1194, 1196, 1165, 1139, 1170, 1149, 1140, 1137, 1165, 1188, 1183, 1176, 1136, 1143, 1158,
+  1150, 1193, 1203, 1177, 1190, 1204, 1208, 1175, 1144, 1177, 1195, 1161, 1177, 1203, 1199, 1161,
+  1200, 1179, 1180, 1213, 1142, 1206, 1154, 1158, 1197, 1162, 1211, 1207, 1196, 1173, 1176, 1201,
+  1185, 1160, 1178, 1145, 1165, 1167, 1151, 1170, 1188, 1154, 1154, 1184, 1143, 1211, 1171, 1165,
+  1156, 1143, 1176, 1153, 1165, 1170, 1146, 1188, 1145, 1163, 1176, 1200, 1179, 1145, 1136, 1173,
+  1174, 1172, 1142, 1203, 1177, 1177, 1177, 1204, 1140, 1211, 1183, 1161, 1149, 1140, 1191, 1209,
+  1139, 1192, 1193, 1148, 1193, 1142, 1201, 1163, 1200, 1196, 1136, 1200, 1210, 1164, 1211, 1153,
+  1183, 1161, 1174, 1166, 1152, 1199, 1167, 1164, 1138, 1163, 1206, 1145, 1181, 1184, 1137, 1207,
+  1176, 1161, 1137, 1146, 1172, 1210, 1167, 1162, 1178, 1176, 1202, 1192, 1173, 1190, 1207, 1208,
+  1199, 1184, 1167, 1198, 1134, 1203, 1182, 1163, 1155, 1188, 1201, 1134, 1181, 1148, 1143, 1138,
+  1212, 1170, 1212, 1205, 1162, 1150, 1155, 1173, 1133, 1149, 1140, 1190, 1150, 1190, 1185, 1152,
+  1206, 1188, 1155, 1169, 1203, 1168, 1138, 1144, 1165, 1195, 1205, 1157, 1208, 1162, 1199, 1211,
+  1189, 1150, 1200, 1168, 1184, 1144, 1209, 1171, 1197, 1203, 1178, 1156, 1178, 1138, 1147, 1188,
+  1183, 1164, 1147, 1137, 1157, 1162, 1211, 1195, 1139, 1138, 1152, 1187, 1201, 1205, 1156, 1142,
+  1206, 1157, 1179, 1146, 1133, 1142, 1153, 1198, 1177, 1160, 1198, 1157, 1174, 1176, 1191, 1185,
+  1188, 1153, 1211, 1187, 1150, 1179, 1192, 1152, 1203, 1179, 1195, 1148, 1133, 1181, 1200, 1193,
+  1200, 1136, 1204, 1200, 1184, 1181, 1149, 1206, 1201, 1203, 1141, 1209, 1171, 1135, 1191, 1159,
+  1199, 1164, 1152, 1191, 1137, 1138, 1132, 1159, 1162, 1208, 1142, 1148, 1178, 1166, 1135, 1137,
+  1186, 1158, 1151, 1176, 1149, 1149, 1134, 1210, 1152, 1168, 1164, 1197, 1161, 1170, 1200, 1195,
+  1188, 1172, 1152, 1131, 1187, 1131, 1176, 1187, 1141, 1164, 1181, 1166, 1145, 1159, 1181, 1209,
+  1175, 1183, 1190, 1187, 1197, 1175, 1144, 1137, 1153, 1175, 1164, 1191, 1171, 1658, 1206, 1206,
+  1200, 1132, 1174, 1169, 1172, 1171, 1196, 1178, 1190, 1156, 1206, 1201, 1169, 1179, 1158, 1178,
+  1137, 1150, 1136, 1134, 1162, 1153, 1139, 1161, 1153, 1174, 1130, 1189, 1179, 1145, 1170, 1140,
+  1159, 1149, 1196, 1148, 1207, 1138, 1131, 1151, 1159, 1208, 1139, 1152, 1131, 1145, 1194, 1201,
+  1155, 1157, 1191, 1205, 1177, 1152, 1195, 1133, 1159, 1204, 1139, 1158, 1184, 1195, 1135, 1198,
+  1166, 1157, 1179, 1147, 1186, 1196, 1166, 1175, 1151, 1137, 1187, 1159, 1150, 1193, 1201, 1169,
+  1178, 1155, 1149, 1132, 1135, 1150, 1194, 1183, 1135, 1162, 1132, 1138, 1169, 1159, 1134, 1181,
+  1147, 1170, 1133, 1146, 1148, 1164, 1142, 1204, 1134, 1200, 1196, 1182, 1175, 1135, 1204, 1163,
+  1195, 1145, 1155, 1153, 1199, 1171, 1171, 1182, 1153, 1174, 1130, 1149, 1169, 1180, 1191, 1132,
+  1156, 1177, 1178, 1164, 1141, 1195, 1130, 1187, 1202, 1152, 1201, 1139, 1166, 1199, 1141, 1184,
+  1165, 1185, 1139, 1146, 1138, 1180, 1148, 1160, 1171, 1183, 1182, 1166, 1146, 1174, 1154, 1167,
+  1132, 1145, 1137, 1175, 1137, 1142, 1183, 1151, 1177, 1203, 1184, 1145, 1167, 1152, 1174, 1148,
+  1169, 1153, 1142, 1184, 1132, 1157, 1134, 1143, 1196, 1189, 1204, 1203, 1151, 1157, 1179, 1163,
+  1143, 1181, 1184, 1193, 1198, 1194, 1188, 1203, 1171, 1144, 1155, 1191, 1153, 1178, 1134, 1130,
+  1182, 1142, 1149, 1140, 1204, 1181, 1129, 1154, 1202, 1171, 1138, 1151, 1159, 1161, 1173, 1154,
+  1146, 1205, 1200, 1189, 1154, 1159, 1174, 1204, 1179, 1142, 1151, 1148, 1185, 1159, 1159, 1202,
+  1141, 1143, 1174, 1162, 1147, 1188, 1196, 1135, 1129, 1165, 1197, 1179, 1155, 1158, 1186, 1169,
+  1144, 1199, 1171, 1169, 1161, 1181, 1160, 1174, 1167, 1180, 1157, 1163, 1170, 1153, 1135, 1193,
+  1194, 1204, 1181, 1197, 1163, 1131, 1149, 1184, 1126, 1183, 1138, 1172, 1132, 1135, 1178, 1158,
+  1185, 1200, 1195, 1180, 1142, 1183, 1154, 1132, 1148, 1140, 1185, 1180, 1184, 1158, 1175, 1170,
+  1135, 1192, 1156, 1149, 1138, 1141, 1187, 1159, 1150, 1136, 1148, 1135, 1170, 1176, 1176, 1145,
+  1130, 1142, 1152, 1144, 1190, 1184, 1148, 1173, 1180, 1203, 1195, 1183, 1151, 1187, 1139, 1199,
+  1125, 1191, 1198, 1201, 1128, 1127, 1178, 1154, 754, 1200, 1188, 1194, 1146, 1195, 1155, 1203,
+  1178, 1194, 1183, 1163, 1141, 1125, 1148, 1133, 1204, 1174, 1191, 1161, 1192, 1197, 1180, 1134,
+  1182, 1190, 1171, 1195, 1174, 1137, 1178, 1179, 1177, 1135, 1170, 1140, 1163, 1155, 1128, 1198,
+  1198, 1179, 1133, 1167, 1189, 1132, 1149, 1160, 1198, 1137, 1181, 1154, 1142, 1183, 1173, 1179,
+  1124, 1124, 1155, 1170, 1146, 1146, 1162, 1173, 1133, 1141, 1197, 1190, 1127, 1128, 1161, 1194,
+  1150, 1152, 1191, 1157, 1160, 1126, 1183, 1144, 1137, 1126, 1168, 1154, 1183, 1161, 1156, 1164,
+  1193, 1179, 1129, 1130, 1164, 1196, 1192, 1174, 1162, 1195, 1182, 1134, 1192, 1169, 1192, 1160,
+  1199, 1186, 1189, 1174, 1144, 1131, 1175, 1174, 1191, 1131, 1125, 1195, 1160, 1182, 1183, 1200,
+  1142, 1162, 1184, 1161, 1126, 1185, 1191, 1134, 1142, 1140, 1157, 1168, 1130, 1163, 1153, 1192,
+  1167, 1141, 1158, 1187, 1168, 1159, 1127, 1149, 1185, 1169, 1141, 1159, 1173, 1123, 1146, 1128,
+  1183, 1146, 1129, 1196, 1189, 1156, 1162, 1135, 1168, 1167, 1190, 1178, 1134, 1143, 1135, 1192,
+  1173, 1145, 1165, 1173, 1197, 1128, 1200, 1173, 1166, 1124, 1183, 1172, 1183, 1170, 1174, 1153,
+  1185, 1154, 1131, 1174, 1124, 1144, 1182, 1145, 1153, 1175, 1148, 1134, 1169, 1127, 1146, 1191,
+  1157, 1193, 1157, 1195, 1132, 1184, 1152, 1159, 1153, 1150, 1177, 1132, 1165, 1177, 1155, 1130,
+  1153, 1154, 1153, 1123, 1125, 1167, 1168, 1181, 1148, 1169, 1174, 1178, 1142, 1122, 1193, 1187,
+  1191, 1149, 1196, 1165, 1134, 1141, 1137, 1146, 1147, 1186, 1164, 1181, 1194, 1144, 1132, 1122,
+};
+const int DRINKER_ADC_TRACE_LENGTH = sizeof(drinkerAdcTrace) / sizeof(drinkerAdcTrace[0]);